@@ -1,16 +1,33 @@
 /*
- * this example demonstrates how to generate a wavetable oscillator sound with ADSR envelope and reverb.
+ * this example demonstrates how to analyze the spectrum of a wavetable oscillator with `FFTAnalyzer`.
+ * the spectrum is mapped to logarithmically spaced bands, the analysis does not allocate memory in
+ * the audio thread. the bands are passed to the main thread with a lock-free `TripleBuffer`.
  */
 
+#include <atomic>
+
 #include "Umfeld.h"
 #include "audio/AudioUtilities.h"
 #include "audio/Wavetable.h"
-#include "audio/FFT.h"
+#include "audio/FFTAnalyzer.h"
+#include "TripleBuffer.h"
 
 using namespace umfeld;
 
-Wavetable*                           wavetable_oscillator;
-std::vector<std::pair<float, float>> spectrum;
+static constexpr int FFT_SIZE  = 1024;
+static constexpr int NUM_BANDS = 48;
+
+struct Bands {
+    float db[NUM_BANDS]{};
+};
+
+Wavetable*          wavetable_oscillator;
+FFTAnalyzer*        fft;
+float               analysis_buffer[FFT_SIZE];
+int                 analysis_position = 0;
+TripleBuffer<Bands> bands; // NOTE written in audio thread, read in main thread
+std::atomic<float>  frequency{220.0f};
+std::atomic<float>  amplitude{0.7f};
 
 void settings() {
     size(1024, 768);
@@ -19,40 +36,46 @@ void settings() {
 
 void setup() {
     colorMode(RGB, 1.0, 1.0, 1.0, 1.0);
-    fft_start(get_audio_buffer_size(), get_audio_sample_rate());
+    fft = new FFTAnalyzer(FFT_SIZE, get_audio_sample_rate(), FFTAnalyzer::WINDOW_HANN);
+    fft->set_bands(NUM_BANDS, FFTAnalyzer::BANDS_LOG, 20.0f, 20000.0f);
 
     wavetable_oscillator = new Wavetable(1024, get_audio_sample_rate());
-    wavetable_oscillator->set_waveform(WAVEFORM_SINE);
+    wavetable_oscillator->set_waveform(WAVEFORM_SAWTOOTH);
     wavetable_oscillator->set_frequency(220.0f);
     wavetable_oscillator->set_amplitude(0.7f);
 }
 
 void draw() {
     background(0.85f);
-    noFill();
-    stroke(1.0f, 0.25f, 0.35f);
 
-    wavetable_oscillator->set_frequency(map(mouseX, 0, width, 20.0f, 800.0f));
-    wavetable_oscillator->set_amplitude(map(mouseY, 0, height, 0.7f, 0.0f));
+    frequency = map(mouseX, 0, width, 20.0f, 800.0f); // NOTE applied in audio thread
+    amplitude = map(mouseY, 0, height, 0.7f, 0.0f);
 
-    if (spectrum.size() > 0) {
-        const float bin_width = width / spectrum.size();
-        noStroke();
-        fill(0.0f, 0.5f, 1.0f);
-        for (const auto& [freq, db]: spectrum) {
-            const float xx = map(freq, 20.0f, 800.0f, 0.0f, width);
-            const float h  = map(db, 0.0f, 50.0f, height, 0.0f);
-            rect(xx - bin_width * 0.5f, h, bin_width, height - h);
-        }
+    bands.update();
+    const float* db         = bands.read_buffer().db;
+    const float  band_width = static_cast<float>(width) / NUM_BANDS;
+    noStroke();
+    fill(0.0f, 0.5f, 1.0f);
+    for (int i = 0; i < NUM_BANDS; i++) {
+        const float h = map(db[i], -90.0f, 0.0f, height, 0.0f);
+        rect(i * band_width, h, band_width - 1, height - h);
     }
 }
 
 void audioEvent(const PAudio& audio) {
+    wavetable_oscillator->set_frequency(frequency);
+    wavetable_oscillator->set_amplitude(amplitude);
     float sample_buffer[audio.buffer_size];
-    for (int i = 0; i < audio.buffer_size; i++) {
-        sample_buffer[i] = wavetable_oscillator->process();
+    for (uint32_t i = 0; i < audio.buffer_size; i++) {
+        sample_buffer[i]                     = wavetable_oscillator->process();
+        analysis_buffer[analysis_position++] = sample_buffer[i];
+        if (analysis_position == FFT_SIZE) {
+            analysis_position = 0;
+            fft->process(analysis_buffer);
+            fft->get_band_db(bands.write_buffer().db, NUM_BANDS);
+            bands.publish();
+        }
     }
-    spectrum = fft_process(sample_buffer, 20.0f, 800.0f);
     if (audio.output_channels == 2) {
         merge_interleaved_stereo(sample_buffer, sample_buffer, audio.output_buffer, audio.buffer_size);
     }
@@ -60,5 +83,5 @@ void audioEvent(const PAudio& audio) {
 
 void shutdown() {
     delete wavetable_oscillator;
-    fft_stop();
-}
\ No newline at end of file
+    delete fft;
+}
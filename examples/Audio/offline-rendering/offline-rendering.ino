@@ -0,0 +1,58 @@
+/*
+ * this example demonstrates how to render audio offline i.e without an audio device and as fast as
+ * the CPU allows. the output of `audioEvent()` is written to `offline-rendering.wav` and the achieved
+ * realtime factor is reported once the rendering is finished.
+ *
+ * NOTE `audioEvent()` runs in the render thread, the input is synthesized ( see `set_input_*()` ).
+ */
+
+#include "Umfeld.h"
+#include "audio/AudioUtilities.h"
+#include "audio/Wavetable.h"
+#include "audio/Reverb.h"
+
+using namespace umfeld;
+
+Reverb*    reverb;
+Wavetable* wavetable_oscillator;
+
+void settings() {
+    size(1024, 768);
+    audio(1, 2);
+    subsystem_audio = umfeld_create_subsystem_audio_offline();
+    subsystem::audio_offline::set_output_file(sketchPath() + "offline-rendering.wav");
+    subsystem::audio_offline::set_duration(60.0f);
+    subsystem::audio_offline::set_input_generator([](const uint64_t frame, int /*channel*/) {
+        return (frame % 24000) < 2400 ? 0.1f * sinf(frame * 0.1f) : 0.0f; // NOTE short burst every 0.5 s
+    });
+}
+
+void setup() {
+    colorMode(RGB, 1.0, 1.0, 1.0, 1.0);
+    reverb               = new Reverb();
+    wavetable_oscillator = new Wavetable(1024, get_audio_sample_rate());
+    wavetable_oscillator->set_waveform(WAVEFORM_TRIANGLE);
+    wavetable_oscillator->set_frequency(220.0f);
+    wavetable_oscillator->set_amplitude(0.5f);
+}
+
+void draw() {
+    background(0.85f);
+    noFill();
+    stroke(1.0f, 0.25f, 0.35f);
+    if (subsystem::audio_offline::is_finished()) {
+        console("rendered with realtime factor: ", subsystem::audio_offline::get_realtime_factor());
+        exit();
+    }
+}
+
+void audioEvent(const PAudio& audio) {
+    float sample_buffer_left[audio.buffer_size];
+    float sample_buffer_right[audio.buffer_size];
+    for (uint32_t i = 0; i < audio.buffer_size; i++) {
+        sample_buffer_left[i]  = wavetable_oscillator->process() + audio.input_buffer[i];
+        sample_buffer_right[i] = sample_buffer_left[i];
+    }
+    reverb->process(sample_buffer_left, sample_buffer_right, audio.buffer_size);
+    merge_interleaved_stereo(sample_buffer_left, sample_buffer_right, audio.output_buffer, audio.buffer_size);
+}
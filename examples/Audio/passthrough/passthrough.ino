@@ -1,7 +1,16 @@
 /*
- * this example demonstrates how to generate a wavetable oscillator sound with ADSR envelope and reverb.
+ * this example demonstrates how to pass audio input through to the output. it also reports the timing
+ * of the device callbacks ( jitter, as measured by the telemetry of the audio device ) and, with a
+ * loopback from output to input ( e.g a cable or speakers and a microphone ), the round-trip latency.
+ * press `L` to send a click and measure the latency, `T` to print the telemetry of the audio device
+ * and `R` to reset it.
+ *
+ * NOTE audio runs in callback mode i.e blocks are produced when the device requests them. set
+ *      `run_audio_in_callback` to `false` to compare with the polling modes.
  */
 
+#include <atomic>
+
 #include "Umfeld.h"
 #include "audio/AudioUtilities.h"
 
@@ -9,9 +18,22 @@ using namespace umfeld;
 
 float energy = 0.0f;
 
+/* --- latency measurement --- */
+
+static constexpr float LATENCY_THRESHOLD    = 0.25f;
+static constexpr float LATENCY_TIMEOUT_SECS = 1.0f;
+
+std::atomic_bool   latency_request{false};
+bool               latency_measuring = false;
+uint64_t           latency_samples   = 0;
+std::atomic<float> latency_ms{-1.0f}; // NOTE negative if click did not return
+std::atomic_bool   latency_updated{false};
+
 void settings() {
     size(1024, 768);
     audio(1, 2);
+    run_audio_in_callback = true;
+    audio_queue_depth     = 1;
 }
 
 void setup() {
@@ -27,6 +49,30 @@ void draw() {
     noFill();
     stroke(1.0f, 0.25f, 0.35f);
     circle(width * 0.5f, height * 0.5f, energy * 0.5f * height + 0.25f * height);
+
+    if (latency_updated.exchange(false)) {
+        if (latency_ms >= 0.0f) {
+            console(fl("round-trip latency"), latency_ms.load(), " ms");
+        } else {
+            console(fl("round-trip latency"), "no click received ( is output connected to input? )");
+        }
+    }
+    if (frameCount % 120 == 0) {
+        const AudioTelemetry::Stats stats = audio_device->telemetry.get_stats(); // NOTE jitter is measured per device callback
+        console(fl("callback jitter"), "max: ", stats.max_jitter_us / 1000.0f, " ms");
+    }
+}
+
+void keyPressed() {
+    if (key == 'L' || key == 'l') {
+        latency_request = true;
+    }
+    if (key == 'R' || key == 'r') {
+        audio_device->telemetry.reset();
+    }
+    if (key == 'T' || key == 't') {
+        audio_device->telemetry.print_stats(); // NOTE timing as measured by the audio subsystem
+    }
 }
 
 void audioEvent(const PAudio& audio) {
@@ -37,6 +83,35 @@ void audioEvent(const PAudio& audio) {
         energy += abs(sample_buffer[i]);
     }
     energy /= audio.buffer_size;
+
+    /* measure round-trip latency: emit a click and count samples until it returns at the input */
+
+    if (latency_measuring) {
+        for (uint32_t i = 0; i < audio.buffer_size; ++i) {
+            if (std::abs(sample_buffer[i]) > LATENCY_THRESHOLD) {
+                latency_ms        = 1000.0f * (latency_samples + i) / audio.sample_rate;
+                latency_measuring = false;
+                latency_updated   = true;
+                break;
+            }
+        }
+        if (latency_measuring) {
+            latency_samples += audio.buffer_size;
+            if (latency_samples > LATENCY_TIMEOUT_SECS * audio.sample_rate) {
+                latency_ms        = -1.0f;
+                latency_measuring = false;
+                latency_updated   = true;
+            }
+        }
+        std::fill_n(sample_buffer, audio.buffer_size, 0.0f); // NOTE mute passthrough to avoid feedback
+    }
+    if (latency_request.exchange(false)) {
+        std::fill_n(sample_buffer, audio.buffer_size, 0.0f);
+        sample_buffer[0]  = 1.0f;
+        latency_samples   = 0;
+        latency_measuring = true;
+    }
+
     if (audio.output_channels == 2) {
         merge_interleaved_stereo(sample_buffer, sample_buffer, audio.output_buffer, audio.buffer_size);
     }
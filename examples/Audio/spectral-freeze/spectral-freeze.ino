@@ -0,0 +1,88 @@
+/*
+ * this example demonstrates how to process the audio input in the frequency domain with `STFT`. the
+ * spectrum is analyzed in the audio thread at a fixed hop size and drawn from the latest published
+ * frame. press `SPACE` to freeze the current spectrum, the frozen magnitudes are then applied to the
+ * phases of the incoming signal.
+ */
+
+#include <atomic>
+
+#include "Umfeld.h"
+#include "audio/AudioUtilities.h"
+#include "audio/STFT.h"
+
+using namespace umfeld;
+
+static constexpr int FFT_SIZE = 2048;
+static constexpr int HOP_SIZE = FFT_SIZE / 4;
+
+STFT*              stft;
+std::vector<float> frozen_magnitudes;
+std::atomic_bool   freeze{false};
+bool               is_frozen = false; // NOTE only accessed in the audio thread
+
+void settings() {
+    size(1024, 768);
+    audio(1, 2);
+}
+
+void setup() {
+    colorMode(RGB, 1.0, 1.0, 1.0, 1.0);
+    stft = new STFT(get_audio_sample_rate(), FFT_SIZE, HOP_SIZE);
+    frozen_magnitudes.resize(stft->get_num_bins(), 0.0f); // NOTE allocate before audio starts
+    stft->set_spectral_processor([](float* spectrum, const int fft_size) {
+        const int num_bins = fft_size / 2 + 1;
+        if (!freeze) {
+            is_frozen = false;
+            return;
+        }
+        if (!is_frozen) {
+            for (int k = 0; k < num_bins; k++) {
+                frozen_magnitudes[k] = STFT::get_magnitude(spectrum, k, fft_size);
+            }
+            is_frozen = true;
+        }
+        for (int k = 0; k < num_bins; k++) {
+            const float magnitude = STFT::get_magnitude(spectrum, k, fft_size);
+            STFT::scale_bin(spectrum, k, fft_size, magnitude > 1e-9f ? frozen_magnitudes[k] / magnitude : 0.0f);
+        }
+    });
+    console(fl("STFT latency"), stft->get_latency(), " samples");
+}
+
+void draw() {
+    background(0.85f);
+
+    stft->update();
+    const float* magnitudes = stft->get_magnitudes();
+    const int    num_bins   = stft->get_num_bins();
+
+    noFill();
+    stroke(freeze ? 1.0f : 0.0f, 0.25f, freeze ? 0.35f : 1.0f);
+    beginShape();
+    for (int x = 0; x < width; x++) {
+        const float frequency = 20.0f * std::pow(1000.0f, static_cast<float>(x) / width); // NOTE 20Hz–20kHz log scale
+        const int   bin       = std::min(num_bins - 1, static_cast<int>(frequency * FFT_SIZE / get_audio_sample_rate()));
+        const float db        = 20.0f * std::log10(std::max(magnitudes[bin], 1e-6f));
+        vertex(x, map(db, -90.0f, 0.0f, height, 0.0f));
+    }
+    endShape();
+}
+
+void keyPressed() {
+    if (key == ' ') {
+        freeze = !freeze;
+    }
+}
+
+void audioEvent(const PAudio& audio) {
+    float sample_buffer[audio.buffer_size];
+    stft->process(audio.input_buffer, sample_buffer, audio.buffer_size);
+    if (audio.output_channels == 2) {
+        merge_interleaved_stereo(sample_buffer, sample_buffer, audio.output_buffer, audio.buffer_size);
+    }
+}
+
+void shutdown() {
+    delete stft;
+}
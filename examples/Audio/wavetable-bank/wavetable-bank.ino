@@ -0,0 +1,117 @@
+/*
+ * this example demonstrates how to play many oscillators with a `WavetableBank` and compares its speed
+ * to the same number of `Wavetable` oscillators. press SPACE to run the benchmark again.
+ */
+
+#include <atomic>
+#include <chrono>
+
+#include "Umfeld.h"
+#include "audio/AudioUtilities.h"
+#include "audio/Wavetable.h"
+#include "audio/WavetableBank.h"
+
+using namespace umfeld;
+
+constexpr uint32_t NUMBER_OF_VOICES = 256;
+constexpr uint32_t WAVETABLE_SIZE   = 2048;
+WavetableBank*     bank;
+std::atomic<float> detune{1.0f};         // NOTE written in main thread, applied in audio thread
+float              applied_detune{1.0f}; // NOTE only accessed in audio thread
+
+void settings() {
+    size(1024, 768);
+    audio();
+}
+
+void benchmark() {
+    constexpr uint32_t buffer_length = 512;
+    constexpr int      iterations    = 100;
+    const float        sample_rate   = get_audio_sample_rate();
+    float              buffer[buffer_length];
+    float              voice_buffer[buffer_length];
+
+    std::vector<Wavetable*> oscillators;
+    WavetableBank           benchmark_bank(NUMBER_OF_VOICES, WAVETABLE_SIZE, sample_rate);
+    for (uint32_t i = 0; i < NUMBER_OF_VOICES; ++i) {
+        const float frequency = 55.0f + i * 3.0f;
+        auto*       o         = new Wavetable(WAVETABLE_SIZE, sample_rate);
+        o->set_waveform(WAVEFORM_SINE);
+        o->set_frequency(frequency);
+        o->set_amplitude(1.0f / NUMBER_OF_VOICES);
+        oscillators.push_back(o);
+        benchmark_bank.set_frequency(i, frequency);
+        benchmark_bank.set_amplitude(i, 1.0f / NUMBER_OF_VOICES);
+    }
+
+    const auto start_scalar = std::chrono::steady_clock::now();
+    for (int n = 0; n < iterations; ++n) {
+        std::fill_n(buffer, buffer_length, 0.0f);
+        for (auto* o: oscillators) {
+            o->process(voice_buffer, buffer_length);
+            for (uint32_t i = 0; i < buffer_length; ++i) {
+                buffer[i] += voice_buffer[i];
+            }
+        }
+    }
+    const auto start_bank = std::chrono::steady_clock::now();
+    for (int n = 0; n < iterations; ++n) {
+        benchmark_bank.process(buffer, buffer_length);
+    }
+    const auto end = std::chrono::steady_clock::now();
+
+    const double samples = static_cast<double>(iterations) * buffer_length * NUMBER_OF_VOICES;
+    const double scalar  = std::chrono::duration<double, std::nano>(start_bank - start_scalar).count() / samples;
+    const double simd    = std::chrono::duration<double, std::nano>(end - start_bank).count() / samples;
+    console(format_label("Wavetable"), scalar, " ns/voice/sample");
+    console(format_label("WavetableBank"), simd, " ns/voice/sample ( ", scalar / simd, "x )");
+
+    for (const auto* o: oscillators) {
+        delete o;
+    }
+}
+
+void setup() {
+    bank = new WavetableBank(NUMBER_OF_VOICES, WAVETABLE_SIZE, get_audio_sample_rate());
+    bank->set_interpolation(AudioUtilities::WAVESHAPE_INTERPOLATE_LINEAR);
+    for (uint32_t i = 0; i < NUMBER_OF_VOICES; ++i) {
+        bank->set_frequency(i, 55.0f * (1.0f + i * 0.5f));
+        bank->set_amplitude(i, 0.5f / (1.0f + i));
+    }
+    benchmark();
+}
+
+void draw() {
+    background(0.85f);
+}
+
+void mouseMoved() {
+    detune = map(mouseX, 0, width, 0.5f, 1.5f);
+}
+
+void keyPressed() {
+    if (key == ' ') {
+        benchmark();
+    }
+}
+
+void audioEvent(const PAudio& audio) {
+    /* detune partials with a glide of 100ms */
+    const float _detune = detune.load(std::memory_order_relaxed);
+    if (_detune != applied_detune) {
+        applied_detune = _detune;
+        for (uint32_t i = 0; i < NUMBER_OF_VOICES; ++i) {
+            bank->set_frequency(i, 55.0f * (1.0f + i * 0.5f * _detune), audio.sample_rate / 10);
+        }
+    }
+
+    float sample_buffer[audio.buffer_size];
+    bank->process(sample_buffer, audio.buffer_size);
+    if (audio.output_channels == 2) {
+        merge_interleaved_stereo(sample_buffer, sample_buffer, audio.output_buffer, audio.buffer_size);
+    }
+}
+
+void shutdown() {
+    delete bank;
+}
@@ -0,0 +1,135 @@
+/*
+ * Umfeld
+ *
+ * This file is part of the *Umfeld* library (https://github.com/dennisppaul/umfeld).
+ * Copyright (c) 2025 Dennis P Paul.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace umfeld {
+    /**
+     * lock-free single-producer single-consumer ring buffer of samples. one thread writes, another
+     * thread reads, neither of them blocks or allocates. the capacity is rounded up to a power of two.
+     *
+     * read and write positions are counted in samples since the buffer was created i.e they only ever
+     * increase and can be used to locate a sample in the stream.
+     */
+    class AudioRingBuffer {
+    public:
+        AudioRingBuffer() = default;
+        explicit AudioRingBuffer(const size_t min_capacity) { resize(min_capacity); }
+
+        AudioRingBuffer(const AudioRingBuffer&)            = delete;
+        AudioRingBuffer& operator=(const AudioRingBuffer&) = delete;
+
+        /**
+         * NOTE not thread-safe, must be called before producer and consumer are running.
+         */
+        void resize(const size_t min_capacity) {
+            size_t capacity = 1;
+            while (capacity < min_capacity) {
+                capacity <<= 1;
+            }
+            buffer.assign(capacity, 0.0f);
+            mask = capacity - 1;
+            write_index.store(0, std::memory_order_relaxed);
+            read_index.store(0, std::memory_order_relaxed);
+        }
+
+        size_t capacity() const { return buffer.size(); }
+
+        /* --- producer --- */
+
+        /**
+         * writes up to `count` samples and returns the number of samples written.
+         */
+        size_t write(const float* samples, const size_t count) {
+            const uint64_t write = write_index.load(std::memory_order_relaxed);
+            const uint64_t read  = read_index.load(std::memory_order_acquire);
+            const size_t   n     = std::min(count, buffer.size() - static_cast<size_t>(write - read));
+            copy_in(write, samples, n);
+            write_index.store(write + n, std::memory_order_release);
+            return n;
+        }
+
+        size_t available_write() const {
+            return buffer.size() - static_cast<size_t>(write_index.load(std::memory_order_relaxed) -
+                                                       read_index.load(std::memory_order_acquire));
+        }
+
+        /* --- consumer --- */
+
+        /**
+         * reads up to `count` samples and returns the number of samples read.
+         */
+        size_t read(float* samples, const size_t count) {
+            const uint64_t read  = read_index.load(std::memory_order_relaxed);
+            const uint64_t write = write_index.load(std::memory_order_acquire);
+            const size_t   n     = std::min(count, static_cast<size_t>(write - read));
+            copy_out(read, samples, n);
+            read_index.store(read + n, std::memory_order_release);
+            return n;
+        }
+
+        /**
+         * discards samples up to `position`. the read position never moves backwards or past the write
+         * position.
+         */
+        void skip_to(const uint64_t position) {
+            const uint64_t read  = read_index.load(std::memory_order_relaxed);
+            const uint64_t write = write_index.load(std::memory_order_acquire);
+            read_index.store(std::clamp(position, read, write), std::memory_order_release);
+        }
+
+        size_t available_read() const {
+            return static_cast<size_t>(write_index.load(std::memory_order_acquire) -
+                                       read_index.load(std::memory_order_relaxed));
+        }
+
+        /* --- either side --- */
+
+        uint64_t write_position() const { return write_index.load(std::memory_order_acquire); }
+        uint64_t read_position() const { return read_index.load(std::memory_order_acquire); }
+
+    private:
+        std::vector<float> buffer;
+        size_t             mask{0};
+        // NOTE indices on separate cache lines to avoid false sharing between producer and consumer
+        alignas(64) std::atomic<uint64_t> write_index{0};
+        alignas(64) std::atomic<uint64_t> read_index{0};
+
+        void copy_in(const uint64_t position, const float* samples, const size_t count) {
+            const size_t start = static_cast<size_t>(position) & mask;
+            const size_t first = std::min(count, buffer.size() - start);
+            std::memcpy(buffer.data() + start, samples, first * sizeof(float));
+            std::memcpy(buffer.data(), samples + first, (count - first) * sizeof(float));
+        }
+
+        void copy_out(const uint64_t position, float* samples, const size_t count) const {
+            const size_t start = static_cast<size_t>(position) & mask;
+            const size_t first = std::min(count, buffer.size() - start);
+            std::memcpy(samples, buffer.data() + start, first * sizeof(float));
+            std::memcpy(samples + first, buffer.data(), (count - first) * sizeof(float));
+        }
+    };
+} // namespace umfeld
@@ -0,0 +1,172 @@
+/*
+ * Umfeld
+ *
+ * This file is part of the *Umfeld* library (https://github.com/dennisppaul/umfeld).
+ * Copyright (c) 2025 Dennis P Paul.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+namespace umfeld {
+    /**
+     * lock-free timing statistics of an audio device. the audio thread wraps each processed block in
+     * `begin_block()` and `end_block()` and reports xruns with `count_underrun()` and `count_overrun()`.
+     * the main thread reads a snapshot with `get_stats()` without locks.
+     *
+     * jitter is measured between device callbacks, not between blocks. if a callback produces several
+     * blocks back-to-back only the first one passes `new_callback = true`.
+     *
+     * NOTE every value has a single writer ( the thread that processes the device ). values are read
+     *      individually i.e a snapshot is not consistent across values.
+     */
+    class AudioTelemetry {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        /** bins are 10% steps of the block duration, the last bin collects blocks that missed their deadline */
+        static constexpr int   NUM_HISTOGRAM_BINS = 11;
+        static constexpr float LOAD_SMOOTHING     = 0.05f;
+
+        struct Stats {
+            uint64_t blocks{0};
+            uint64_t histogram[NUM_HISTOGRAM_BINS]{};
+            float    block_duration_us{0.0f}; // NOTE time budget of one block
+            float    last_duration_us{0.0f};  // NOTE time spent in the audio callbacks for the last block
+            float    max_duration_us{0.0f};
+            float    load{0.0f}; // NOTE smoothed DSP load in percent of the block duration
+            float    max_load{0.0f};
+            float    max_jitter_us{0.0f}; // NOTE max deviation of the interval between two device callbacks from the audio produced in between
+            uint64_t late_blocks{0};      // NOTE blocks that took longer than the block duration
+            uint64_t underruns{0};
+            uint64_t overruns{0};
+        };
+
+        AudioTelemetry() = default;
+        ~AudioTelemetry() { stop_logging(); }
+
+        AudioTelemetry(const AudioTelemetry&)            = delete;
+        AudioTelemetry& operator=(const AudioTelemetry&) = delete;
+
+        /* --- audio thread --- */
+
+        Clock::time_point begin_block(const uint32_t frames, const uint32_t sample_rate, const bool new_callback = true) {
+            if (reset_requested.exchange(false, std::memory_order_acquire)) {
+                clear();
+            }
+            const auto now            = Clock::now();
+            const auto block_duration = sample_rate > 0 ? 1000000.0f * static_cast<float>(frames) / static_cast<float>(sample_rate) : 0.0f;
+            block_duration_us.store(block_duration, std::memory_order_relaxed);
+            if (new_callback) {
+                if (has_last_begin) {
+                    const float interval_us = std::chrono::duration<float, std::micro>(now - last_begin).count();
+                    store_max(max_jitter_us, std::abs(interval_us - produced_us));
+                }
+                last_begin     = now;
+                has_last_begin = true;
+                produced_us    = 0.0f;
+            }
+            produced_us += block_duration;
+            return now;
+        }
+
+        void end_block(const Clock::time_point begin) {
+            const float duration       = std::chrono::duration<float, std::micro>(Clock::now() - begin).count();
+            const float block_duration = block_duration_us.load(std::memory_order_relaxed);
+            const float block_load     = block_duration > 0.0f ? 100.0f * duration / block_duration : 0.0f;
+            const int   bin            = std::min(static_cast<int>(block_load / 10.0f), NUM_HISTOGRAM_BINS - 1);
+            histogram[bin].fetch_add(1, std::memory_order_relaxed);
+            if (duration > block_duration) {
+                late_blocks.fetch_add(1, std::memory_order_relaxed);
+            }
+            last_duration_us.store(duration, std::memory_order_relaxed);
+            store_max(max_duration_us, duration);
+            store_max(max_load, block_load);
+            const float smoothed_load = is_running() ? load.load(std::memory_order_relaxed) : block_load;
+            load.store(smoothed_load + (block_load - smoothed_load) * LOAD_SMOOTHING, std::memory_order_relaxed);
+            blocks.fetch_add(1, std::memory_order_release);
+        }
+
+        void count_underrun() { underruns.fetch_add(1, std::memory_order_relaxed); }
+        void count_overrun() { overruns.fetch_add(1, std::memory_order_relaxed); }
+        bool is_running() const { return blocks.load(std::memory_order_relaxed) > 0; }
+
+        /* --- main thread --- */
+
+        Stats get_stats() const;
+        void  print_stats() const;
+        /** statistics are cleared by the audio thread before the next block */
+        void reset() { reset_requested.store(true, std::memory_order_release); }
+        /**
+         * appends a row of statistics to a CSV file every `interval_seconds`. rows are written from
+         * `update_log()` which is called by the audio subsystem in the main loop.
+         */
+        bool start_logging(const std::string& file_path, float interval_seconds = 1.0f);
+        void stop_logging();
+        void update_log();
+
+    private:
+        std::atomic<uint64_t> blocks{0};
+        std::atomic<uint64_t> histogram[NUM_HISTOGRAM_BINS]{};
+        std::atomic<float>    block_duration_us{0.0f};
+        std::atomic<float>    last_duration_us{0.0f};
+        std::atomic<float>    max_duration_us{0.0f};
+        std::atomic<float>    load{0.0f};
+        std::atomic<float>    max_load{0.0f};
+        std::atomic<float>    max_jitter_us{0.0f};
+        std::atomic<uint64_t> late_blocks{0};
+        std::atomic<uint64_t> underruns{0};
+        std::atomic<uint64_t> overruns{0};
+        std::atomic_bool      reset_requested{false};
+        Clock::time_point     last_begin{};
+        bool                  has_last_begin{false};
+        float                 produced_us{0.0f}; // NOTE duration of the blocks produced since the last callback
+        /* CSV logging ( main thread ) */
+        FILE*             log_file{nullptr};
+        float             log_interval_seconds{1.0f};
+        Clock::time_point log_start{};
+        Clock::time_point log_last{};
+
+        static void store_max(std::atomic<float>& value, const float candidate) {
+            if (candidate > value.load(std::memory_order_relaxed)) {
+                value.store(candidate, std::memory_order_relaxed);
+            }
+        }
+
+        void clear() {
+            blocks.store(0, std::memory_order_relaxed);
+            for (auto& bin: histogram) {
+                bin.store(0, std::memory_order_relaxed);
+            }
+            last_duration_us.store(0.0f, std::memory_order_relaxed);
+            max_duration_us.store(0.0f, std::memory_order_relaxed);
+            load.store(0.0f, std::memory_order_relaxed);
+            max_load.store(0.0f, std::memory_order_relaxed);
+            max_jitter_us.store(0.0f, std::memory_order_relaxed);
+            late_blocks.store(0, std::memory_order_relaxed);
+            underruns.store(0, std::memory_order_relaxed);
+            overruns.store(0, std::memory_order_relaxed);
+            has_last_begin = false;
+            produced_us    = 0.0f;
+        }
+    };
+} // namespace umfeld
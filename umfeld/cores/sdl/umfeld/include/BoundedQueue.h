@@ -0,0 +1,137 @@
+/*
+ * Umfeld
+ *
+ * This file is part of the *Umfeld* library (https://github.com/dennisppaul/umfeld).
+ * Copyright (c) 2025 Dennis P Paul.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+namespace umfeld {
+    /**
+     * thread-safe FIFO queue with a fixed capacity. `push()` blocks while the queue is full and `pop()`
+     * blocks while the queue is empty. after `close()` all blocking calls return `false` immediately.
+     */
+    template<typename T>
+    class BoundedQueue {
+    public:
+        explicit BoundedQueue(const size_t capacity) : capacity(capacity > 0 ? capacity : 1) {}
+
+        bool push(T item) {
+            std::unique_lock lock(mutex);
+            not_full.wait(lock, [this] { return closed || items.size() < capacity; });
+            if (closed) {
+                return false;
+            }
+            items.push_back(std::move(item));
+            not_empty.notify_one();
+            return true;
+        }
+
+        bool try_push(T item) {
+            std::lock_guard lock(mutex);
+            if (closed || items.size() >= capacity) {
+                return false;
+            }
+            items.push_back(std::move(item));
+            not_empty.notify_one();
+            return true;
+        }
+
+        /**
+         * pushes without blocking. if the queue is full the oldest item is removed and passed to `dispose`
+         * i.e the latest items win. returns false if an item was disposed.
+         */
+        template<typename F>
+        bool push_latest(T item, F&& dispose) {
+            std::lock_guard lock(mutex);
+            if (closed) {
+                dispose(item);
+                return false;
+            }
+            bool dropped = false;
+            if (items.size() >= capacity) {
+                dispose(items.front());
+                items.pop_front();
+                dropped = true;
+            }
+            items.push_back(std::move(item));
+            not_empty.notify_one();
+            return !dropped;
+        }
+
+        bool pop(T& item) {
+            std::unique_lock lock(mutex);
+            not_empty.wait(lock, [this] { return closed || !items.empty(); });
+            if (closed) {
+                return false;
+            }
+            item = std::move(items.front());
+            items.pop_front();
+            not_full.notify_one();
+            return true;
+        }
+
+        bool try_pop(T& item) {
+            std::lock_guard lock(mutex);
+            if (closed || items.empty()) {
+                return false;
+            }
+            item = std::move(items.front());
+            items.pop_front();
+            not_full.notify_one();
+            return true;
+        }
+
+        /**
+         * removes all items. `dispose` is called for each removed item e.g to free resources.
+         */
+        template<typename F>
+        void clear(F&& dispose) {
+            std::lock_guard lock(mutex);
+            for (auto& item: items) {
+                dispose(item);
+            }
+            items.clear();
+            not_full.notify_all();
+        }
+
+        void close() {
+            std::lock_guard lock(mutex);
+            closed = true;
+            not_full.notify_all();
+            not_empty.notify_all();
+        }
+
+        size_t size() const {
+            std::lock_guard lock(mutex);
+            return items.size();
+        }
+
+        size_t get_capacity() const { return capacity; }
+
+    private:
+        const size_t            capacity;
+        std::deque<T>           items;
+        mutable std::mutex      mutex;
+        std::condition_variable not_full;
+        std::condition_variable not_empty;
+        bool                    closed{false};
+    };
+} // namespace umfeld
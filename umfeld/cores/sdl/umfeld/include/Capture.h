@@ -33,12 +33,14 @@ extern "C" {
 #endif // ENABLE_CAPTURE && !DISABLE_GRAPHICS && !DISABLE_VIDEO
 
 #include <atomic>
+#include <mutex>
 #include <vector>
 #include <string>
 #include <sstream>
 #include <thread>
 
 #include "PImage.h"
+#include "BoundedQueue.h"
 
 struct DeviceCapability {
     std::string device_name;
@@ -63,8 +65,21 @@ namespace umfeld {
 
     extern PGraphics* g;
 
+    /**
+     * captures frames from a camera. a capture thread reads and decodes frames from the device and a
+     * worker thread converts them into a small ring of RGBA frames. frames are passed between the
+     * threads with latest-frame-wins semantics i.e if the application does not keep up older frames are
+     * dropped instead of adding latency. `read()` never waits for the device.
+     *
+     * besides physical devices an FFmpeg `lavfi` source can be opened by prefixing the device name
+     * with `lavfi:` ( e.g `lavfi:testsrc2=size=1920x1080:rate=60`, see `test_source()` ). test sources
+     * are paced to their frame rate unless `set_realtime(false)` is called.
+     */
     class Capture final : public PImage {
     public:
+        static constexpr int FRAME_RING_SIZE    = 3;
+        static constexpr int DECODED_QUEUE_SIZE = 2;
+
         Capture();
 
         using PImage::init;
@@ -79,34 +94,65 @@ namespace umfeld {
         void        stop();
         void        reload(PGraphics* graphics = g);
         void        set_listener(CaptureListener* listener) { this->listener = listener; }
-        const char* name() const { return fDeviceName; }
+        const char* name() const { return fDeviceName.c_str(); }
+        void        set_yuv_mode(const bool enable) { yuv_mode = enable; } // NOTE upload YUV planes and convert on the GPU
+        bool        is_yuv_mode() const { return yuv_mode; }
+        void        set_realtime(const bool enable) { realtime = enable; } // NOTE pace test sources to their frame rate
+        int         get_dropped_frames() const { return dropped_frames; }  // NOTE frames replaced by a newer frame before they were read
+        int64_t     get_capture_time() const { return capture_time; }      // NOTE time in microseconds ( see `capture_timestamp()` ) the current frame was received
+        float       get_latency() const { return latency; }                // NOTE seconds between receiving and reading the current frame
+
+        static int64_t     capture_timestamp();
+        static std::string test_source(int width = 1920, int height = 1080, int frame_rate = 60);
 
         ~Capture() override;
 
     private:
-        const char*       fDeviceName{};
-        bool              fIsInitialized       = false;
-        bool              fVideoFrameAvailable = false;
-        std::thread       playbackThread;
+        std::string       fDeviceName; // NOTE copied, `init()` may be called with a temporary name
+        bool              fIsInitialized = false;
+        bool              is_test_source = false;
+        std::thread       capture_thread;
+        std::thread       convert_thread;
         std::atomic<bool> keepRunning{};
         std::atomic<bool> isPlaying{};
+        std::atomic<bool> realtime{true};
         double            frameDuration{};
         CaptureListener*  listener = nullptr;
+        std::atomic<bool> yuv_mode{false};
+        std::atomic<int>  dropped_frames{0};
+        int64_t           capture_time{0};
+        float             latency{0.0f};
 #if defined(ENABLE_CAPTURE) && !defined(DISABLE_GRAPHICS) && !defined(DISABLE_VIDEO)
-        uint8_t*         buffer           = nullptr;
-        AVFormatContext* formatContext    = nullptr;
-        AVCodecContext*  codecContext     = nullptr;
-        AVFrame*         frame            = nullptr;
-        AVFrame*         convertedFrame   = nullptr;
-        AVPacket*        packet           = nullptr;
-        SwsContext*      swsContext       = nullptr;
-        AVDictionary*    options          = nullptr;
-        int              videoStreamIndex = -1;
-        int              fFrameCounter    = 0;
+        struct DecodedFrame {
+            AVFrame* frame{nullptr};
+            int64_t  capture_time{0};
+        };
+
+        struct CaptureFrame {
+            uint8_t* data[4]{};
+            int      linesize[4]{};
+            AVFrame* yuv_frame{nullptr}; // NOTE reference to the decoded frame in YUV mode
+            int64_t  capture_time{0};
+        };
+
+        AVFormatContext*           formatContext    = nullptr;
+        AVCodecContext*            codecContext     = nullptr;
+        AVFrame*                   frame            = nullptr;
+        AVPacket*                  packet           = nullptr;
+        SwsContext*                swsContext       = nullptr;
+        AVDictionary*              options          = nullptr;
+        int                        videoStreamIndex = -1;
+        int                        fFrameCounter    = 0; // NOTE written by convert thread
+        BoundedQueue<DecodedFrame> decoded_queue{DECODED_QUEUE_SIZE};
+        std::vector<CaptureFrame>  frame_ring;
+        std::mutex                 frame_ring_mutex;
+        int                        displayed_frame{0};
+        int                        ready_frame{-1}; // NOTE most recent converted frame, `-1` if none
 #endif // ENABLE_CAPTURE && !DISABLE_GRAPHICS && !DISABLE_VIDEO
 
-        bool processFrame();
-        void playbackLoop();
+        void capture_loop();
+        void convert_loop();
+        void upload_frame(PGraphics* graphics);
         int  connect(const char* device_name,
                      const char* resolution,
                      const char* frame_rate,
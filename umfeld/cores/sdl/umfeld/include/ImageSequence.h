@@ -0,0 +1,144 @@
+/*
+ * Umfeld
+ *
+ * This file is part of the *Umfeld* library (https://github.com/dennisppaul/umfeld).
+ * Copyright (c) 2025 Dennis P Paul.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "PImage.h"
+
+namespace umfeld {
+
+    extern PGraphics* g;
+
+    /*
+     * raw image sequence file format ( `.ufs` ):
+     *
+     * - 64 byte header ( see `ImageSequenceHeader` ) padded to `FRAME_ALIGNMENT`
+     * - frames of `width * height` RGBA pixels in the memory layout of `PImage::pixels`, each frame is
+     *   padded to a multiple of `FRAME_ALIGNMENT` bytes
+     *
+     * since all frames have the same size the frame index is implicit i.e the offset of frame `n` is
+     * `data_offset + n * frame_stride`.
+     */
+    struct ImageSequenceHeader {
+        static constexpr char     MAGIC[4]           = {'U', 'F', 'S', 'Q'};
+        static constexpr uint32_t VERSION            = 1;
+        static constexpr uint32_t PIXEL_FORMAT_RGBA8 = 0;
+        static constexpr uint32_t FRAME_ALIGNMENT    = 16384; // NOTE covers 4K and 16K memory pages
+
+        char     magic[4]{MAGIC[0], MAGIC[1], MAGIC[2], MAGIC[3]};
+        uint32_t version{VERSION};
+        uint32_t width{0};
+        uint32_t height{0};
+        uint32_t frame_count{0};
+        uint32_t pixel_format{PIXEL_FORMAT_RGBA8};
+        float    frame_rate{30.0f};
+        uint32_t reserved_0{0};
+        uint64_t data_offset{FRAME_ALIGNMENT};
+        uint64_t frame_stride{0};
+        uint8_t  reserved_1[16]{};
+
+        static uint64_t stride_for(uint32_t width, uint32_t height);
+        bool            is_valid() const;
+    };
+
+    /**
+     * plays back a raw image sequence file. the file is memory mapped and each frame is exposed as a
+     * zero-copy view i.e `pixels` points directly into the mapped file. frames ahead of the current
+     * frame are prefetched with `madvise` ( or `PrefetchVirtualMemory` on windows ).
+     *
+     * NOTE the mapping is private, writing to `pixels` does not change the file.
+     */
+    class ImageSequence final : public PImage {
+    public:
+        static constexpr int DEFAULT_PREFETCH_FRAMES = 4;
+
+        explicit ImageSequence(const std::string& filepath);
+        ~ImageSequence() override;
+
+        ImageSequence(const ImageSequence&)            = delete;
+        ImageSequence& operator=(const ImageSequence&) = delete;
+
+        bool            is_open() const { return mapped_data != nullptr; }
+        bool            read(int frame_index, PGraphics* graphics = g);
+        bool            read_at_time(float seconds, bool loop = true, PGraphics* graphics = g);
+        int             frameCount() const { return frame_count; }
+        float           frameRate() const { return header.frame_rate; }
+        float           duration() const;
+        int             current_frame() const { return frame_index_current; }
+        const uint32_t* frame_pixels(int frame_index) const;
+        void            prefetch(int frame_index, int num_frames) const;
+        void            set_prefetch_frames(const int num_frames) { prefetch_frames = num_frames; }
+
+    private:
+        ImageSequenceHeader header;
+        uint8_t*            mapped_data{nullptr};
+        size_t              mapped_size{0};
+        int                 frame_count{0};
+        int                 frame_index_current{-1};
+        int                 prefetch_frames{DEFAULT_PREFETCH_FRAMES};
+#ifdef SYSTEM_WINDOWS
+        void* file_handle{nullptr};
+        void* mapping_handle{nullptr};
+#endif // SYSTEM_WINDOWS
+
+        bool map_file(const std::string& filepath);
+        void unmap_file();
+    };
+
+    /**
+     * writes frames to a raw image sequence file. if the file already exists and has the same frame
+     * size, frames are appended.
+     *
+     * NOTE the frame count in the header is written on `close()`, the file is incomplete until then.
+     *      `append_frame()` keeps one writer per file open across calls until `close_all()`.
+     */
+    class ImageSequenceWriter {
+    public:
+        ImageSequenceWriter(const std::string& filepath, int width, int height, float frame_rate = 30.0f);
+        ~ImageSequenceWriter();
+
+        ImageSequenceWriter(const ImageSequenceWriter&)            = delete;
+        ImageSequenceWriter& operator=(const ImageSequenceWriter&) = delete;
+
+        bool is_open() const { return file != nullptr; }
+        bool add_frame(const uint32_t* pixel_data);
+        bool add_frame(const PImage* image);
+        bool add_frame(PGraphics* graphics); // NOTE reads the framebuffer like `saveFrame()`
+        int  frameCount() const { return static_cast<int>(header.frame_count); }
+        int  get_width() const { return static_cast<int>(header.width); }
+        int  get_height() const { return static_cast<int>(header.height); }
+        void close();
+
+        static bool append_frame(const std::string& filepath, PGraphics* graphics);
+        static bool append_frame(const std::string& filepath, const PImage* image);
+        static void close_all();
+
+    private:
+        FILE*               file{nullptr};
+        ImageSequenceHeader header;
+        std::vector<char>   padding;
+        bool                header_dirty{false};
+
+        bool write_header();
+    };
+} // namespace umfeld
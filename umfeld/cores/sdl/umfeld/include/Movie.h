@@ -20,9 +20,17 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
 #include <thread>
+#include <vector>
 
 #include "PImage.h"
+#include "PAudio.h"
+#include "AudioRingBuffer.h"
+#include "BoundedQueue.h"
 
 #ifndef DISABLE_GRAPHICS
 #ifndef DISABLE_VIDEO
@@ -49,14 +57,42 @@ namespace umfeld {
 
     extern PGraphics* g;
 
-    class Movie final : public PImage {
+    /**
+     * plays back a movie file. demuxing, decoding and color conversion run in separate threads and feed
+     * a small ring of RGBA frames. `read()` takes the frame that is due at the current playback time
+     * from the ring and uploads it to the texture, it never waits for the decoder.
+     *
+     * a keyframe index is built in the background on first open and cached next to the movie file
+     * ( `<movie>.ufidx` ). seeks start decoding at the nearest keyframe before the target and skip
+     * frames up to the target. reverse playback ( negative `speed()` ) decodes ranges of frames forward
+     * into a cache of converted frames and plays them back from there.
+     *
+     * in YUV mode ( see `set_yuv_mode()` ) frames in 4:2:0, 4:2:2 or NV12 format skip the conversion to
+     * RGBA. the ring keeps a reference to the decoded planes and `read()` uploads them to the renderer
+     * which converts them to RGBA on the GPU. `pixels` is then not updated.
+     *
+     * if an audio device is running the audio track is resampled to the sample rate and channel count
+     * of `audio_device` and written to a lock-free ring buffer. the audio subsystem mixes the ring into
+     * the output buffer after `audioEvent()`. while audio is playing the playback clock follows the
+     * samples consumed by the audio device i.e video is synchronized to audio. audio is only played
+     * back at normal speed.
+     */
+    class Movie final : public PImage, public AudioSource {
     public:
+        static constexpr int FRAME_RING_SIZE    = 4;
+        static constexpr int PACKET_QUEUE_SIZE  = 64;
+        static constexpr int DECODED_QUEUE_SIZE = 2;
+        static constexpr int DECODER_THREADS    = 0; // NOTE `0` lets libav choose the number of threads
+        static constexpr int REVERSE_CACHE_SIZE = 16; // NOTE minimum number of cached frames in reverse playback
+        static constexpr int AUDIO_RING_SECONDS = 2;
+        static constexpr int AUDIO_CONVERT_SIZE = 4096; // NOTE frames converted at once by the demux thread
+
         explicit Movie(const std::string& filename, int channels = -1);
 
         bool  available();
         float duration() const;
         float frameRate() const;
-        void  jump(float seconds) const;
+        void  jump(float seconds);
         void  loop();
         void  noLoop();
         void  pause();
@@ -67,41 +103,155 @@ namespace umfeld {
         float time() const;
         void  reload(PGraphics* graphics = g);
         void  set_listener(MovieListener* listener);
+        int   get_dropped_frames() const { return dropped_frames; } // NOTE frames skipped because a newer frame was due
+        int   get_late_frames() const { return late_frames; }       // NOTE frames presented later than one frame duration
+        void  set_frame_cache_size(int frames);                    // NOTE number of converted frames kept for reverse playback and repeated jumps
+        bool  has_keyframe_index() const { return keyframe_index_ready; }
+        void  set_yuv_mode(bool enable);                           // NOTE upload YUV planes and convert on the GPU
+        bool  is_yuv_mode() const { return yuv_mode; }
+        void  volume(const float v) { audio_volume = v; }
+        bool  has_audio() const { return audio_output_enabled; }
+        int   get_audio_underruns() const { return audio_underruns; } // NOTE audio callbacks that ran out of samples while playing
+        void  mix_audio(float* output, int frames, int channels) override;
 
         ~Movie() override;
 
     private:
-        std::atomic<bool> isLooping            = false;
-        bool              mVideoFrameAvailable = false;
-        std::thread       playbackThread;
-        std::atomic<bool> keepRunning{};
-        std::atomic<bool> isPlaying{};
-        double            frameDuration{}; // Duration of each frame in seconds
+        std::atomic<bool>                     isLooping = false;
+        std::atomic<bool>                     keepRunning{};
+        std::atomic<bool>                     isPlaying{};
+        double                                frameDuration{}; // Duration of each frame in seconds
+        double                                clock_base_pts{0.0};
+        std::chrono::steady_clock::time_point clock_base_time{};
+        float                                 playback_speed{1.0f};
+        double                                current_pts{0.0};
+        int                                   dropped_frames{0};
+        int                                   late_frames{0};
+        std::atomic<bool>                     keyframe_index_ready{false};
+        std::atomic<bool>                     yuv_mode{false};
+        std::atomic<float>                    audio_volume{1.0f};
+        std::atomic<bool>                     audio_output_enabled{false};
+        std::atomic<int>                      audio_underruns{0};
 #ifndef DISABLE_GRAPHICS
 #ifndef DISABLE_VIDEO
-        uint8_t*         buffer{};
-        AVFrame*         frame{};
-        AVFrame*         convertedFrame{};
+        struct PacketItem {
+            AVPacket* packet{nullptr}; // NOTE `nullptr` drains the decoder
+            int       serial{0};
+            double    pts_offset{0.0};
+        };
+
+        struct DecodedFrame {
+            AVFrame* frame{nullptr};
+            int      serial{0};
+            double   pts{0.0};
+        };
+
+        struct VideoFrame {
+            uint8_t* data[4]{};
+            int      linesize[4]{};
+            double   pts{0.0};
+            int      serial{0};
+            AVFrame* yuv_frame{nullptr}; // NOTE reference to the decoded frame in YUV mode
+        };
+
+        struct CachedFrame {
+            double               pts{0.0};
+            std::vector<uint8_t> pixel_data;
+            uint64_t             last_used{0};
+        };
+
+        AVFrame*         frame{}; // NOTE used for audio decoding in demux thread
+        AVPixelFormat    output_pixel_format{AV_PIX_FMT_RGBA};
         AVCodecContext*  videoCodecContext{};
         AVCodecContext*  audioCodecContext{};
         AVFormatContext* formatContext{};
-        AVPacket*        packet{};
         SwsContext*      swsContext{};
         SwrContext*      swrCtx{};
         int              videoStreamIndex{};
         int              audioStreamIndex{};
         int              mFrameCounter = 0;
         MovieListener*   fListener{};
-#endif // DISABLE_VIDEO
-#endif // DISABLE_GRAPHICS
 
-        int init_from_file(const std::string& filename, int _channels = -1);
+        /* --- pipeline --- */
 
-        void playbackLoop();
+        std::thread                demux_thread;
+        std::thread                decode_thread;
+        std::thread                convert_thread;
+        BoundedQueue<PacketItem>   packet_queue{PACKET_QUEUE_SIZE};
+        BoundedQueue<DecodedFrame> decoded_queue{DECODED_QUEUE_SIZE};
+        std::atomic<int>           serial{0}; // NOTE incremented on each seek, stale items are discarded
+        std::atomic<bool>          seek_requested{false};
+        std::atomic<double>        seek_target{0.0};
+        std::atomic<bool>          end_of_stream{false};
 
-        void calculateFrameDuration();
+        std::vector<VideoFrame> frame_ring;
+        std::deque<int>         ready_frames;
+        std::deque<int>         free_frames;
+        int                     displayed_frame{0};
+        std::mutex              frame_ring_mutex;
+        std::condition_variable frame_ring_condition;
+        int                     frame_size_bytes{0};
+
+        /* --- seeking + reverse playback --- */
+
+        std::string              movie_path;
+        std::vector<int64_t>     keyframe_index; // NOTE sorted timestamps of keyframes in stream time base
+        std::mutex               keyframe_index_mutex;
+        std::thread              index_thread;
+        std::vector<CachedFrame> frame_cache;
+        int                      frame_cache_capacity{0};
+        uint64_t                 frame_cache_tick{0};
+        double                   reverse_fill_start{-1.0};
+        double                   reverse_fill_end{-1.0};
+        bool                     reverse_fill_done{true};
+
+        /* --- audio --- */
+
+        int                   audio_output_rate{0};
+        int                   audio_output_channels{0};
+        std::vector<float>    audio_convert_buffer; // NOTE written by demux thread
+        std::vector<float>    audio_mix_buffer;     // NOTE read into by audio thread
+        AudioRingBuffer       audio_ring;
+        double                audio_buffer_duration{0.0};
+        std::atomic<bool>     audio_muted{false}; // NOTE audio is not played back at speeds other than 1
+        std::atomic<int>      audio_write_serial{0};
+        std::atomic<uint64_t> audio_flush_position{0}; // NOTE samples before this position belong to a previous serial
+        std::atomic<int>      audio_base_serial{-1};
+        std::atomic<double>   audio_base_pts{0.0};
+        std::atomic<uint64_t> audio_base_position{0};
+        int                   audio_read_serial{0};
+        std::atomic<int>      audio_clock_serial{-1};
+        std::atomic<double>   audio_clock{0.0};
+        std::atomic<int64_t>  audio_clock_time{0}; // NOTE steady clock time of `audio_clock` in nanoseconds
+
+        void    demux_loop();
+        void    decode_loop();
+        void    convert_loop();
+        void    decode_audio_packet(const AVPacket* audio_packet, int packet_serial, double pts_offset);
+        bool    init_audio_resampler(const AVFrame* audio_frame);
+        void    write_audio(const float* samples, int frames, double pts, int packet_serial);
+        bool    read_audio_clock(double& clock) const;
+        int     acquire_free_frame(int frame_serial);
+        double  to_seconds(int64_t timestamp) const;
+        void    request_seek(double seconds);
+        bool    read_reverse(PGraphics* graphics, double clock);
+        void    request_reverse_fill(double clock);
+        void    cache_frame(const VideoFrame& video_frame);
+        int     find_cached_frame(double clock) const;
+        void    show_cached_frame(PGraphics* graphics, int cache_index);
+        void    upload_video_frame(PGraphics* graphics, const VideoFrame& video_frame);
+        void    build_keyframe_index();
+        bool    load_keyframe_index();
+        void    save_keyframe_index(const std::vector<int64_t>& keyframes) const;
+        int64_t find_keyframe(int64_t timestamp);
+#endif // DISABLE_VIDEO
+#endif // DISABLE_GRAPHICS
 
-        bool processFrame();
+        int    init_from_file(const std::string& filename, int _channels = -1);
+        void   calculateFrameDuration();
+        double playback_clock() const;
+        void   start_pipeline();
+        void   stop_pipeline();
     };
 
 } // namespace umfeld
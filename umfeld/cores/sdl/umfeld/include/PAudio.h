@@ -21,6 +21,7 @@
 
 #include <string>
 #include "UmfeldConstants.h"
+#include "AudioTelemetry.h"
 
 namespace umfeld {
 
@@ -79,6 +80,14 @@ namespace umfeld {
         int         output_device_id{DEFAULT_AUDIO_DEVICE};
         std::string output_device_name{DEFAULT_AUDIO_DEVICE_NAME};
         bool        threaded{DEFAULT_AUDIO_RUN_IN_THREAD};
+        /**
+         * if set blocks are produced in the audio device callback i.e exactly when the device requests
+         * samples. `queue_depth` is the number of blocks that are kept queued ahead of the device. a depth
+         * of 1 yields the lowest latency, larger values trade latency for headroom against xruns.
+         * NOTE takes precedence over `threaded`.
+         */
+        bool callback{DEFAULT_AUDIO_RUN_IN_CALLBACK};
+        int  queue_depth{DEFAULT_AUDIO_QUEUE_DEPTH};
     };
 
     class PAudio : public AudioUnitInfo {
@@ -86,5 +95,27 @@ namespace umfeld {
         explicit PAudio(const AudioUnitInfo* device_info);
         void copy_input_buffer_to_output_buffer() const;
         static void acquire_audio_buffer_per_sample(const PAudio* audio_device);
+        /** timing and xrun statistics written by the audio subsystem ( e.g `telemetry.get_stats()` ) */
+        AudioTelemetry telemetry;
     };
+
+    /**
+     * source of samples that is mixed into the output buffer of the main audio device ( `audio_device` )
+     * after `audioEvent()` was called. `mix_audio()` is called from the audio thread and must neither
+     * block nor allocate memory.
+     */
+    class AudioSource {
+    public:
+        virtual ~AudioSource() = default;
+        /**
+         * adds `frames` frames to the interleaved `output` buffer with `channels` channels.
+         */
+        virtual void mix_audio(float* output, int frames, int channels) = 0;
+    };
+
+    static constexpr int MAX_AUDIO_SOURCES = 16;
+
+    bool register_audio_source(AudioSource* source);
+    void unregister_audio_source(AudioSource* source); // NOTE waits until the source is no longer mixed
+    void mix_audio_sources(const PAudio* audio);
 } // namespace umfeld
\ No newline at end of file
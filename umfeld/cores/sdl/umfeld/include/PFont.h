@@ -25,6 +25,9 @@
 #include <codecvt>
 
 #include <algorithm>
+#include <cmath>
+#include <list>
+#include <memory>
 #include <vector>
 #include <unordered_map>
 
@@ -33,11 +36,21 @@
 #include "ft2build.h"
 #include FT_FREETYPE_H
 #include FT_OUTLINE_H
+#include FT_MODULE_H
+
+#if FREETYPE_MAJOR > 2 || (FREETYPE_MAJOR == 2 && FREETYPE_MINOR >= 11)
+#define PFONT_SDF_AVAILABLE // NOTE `FT_RENDER_MODE_SDF` was added in FreeType 2.11
+#endif
 
 #include "UmfeldFunctionsAdditional.h"
 #include "PImage.h"
+#include "SkylinePacker.h"
+#include "Triangulator.h"
+#include "Vertex.h"
 
 namespace umfeld {
+    class VertexBuffer;
+
     struct TexturedQuad {
         float x0, y0, u0, v0; // Top-left
         float x1, y1, u1, v1; // Top-right
@@ -54,16 +67,69 @@ namespace umfeld {
               x3(_x3), y3(_y3), u3(_u3), v3(_v3) {}
     };
 
+    /**
+     * font rendered from a texture atlas. shaped lines of text are kept in an LRU cache ( see
+     * `set_text_cache_budget()` ) so that labels drawn every frame are only shaped once. the cache is
+     * keyed by the text only, since shaped glyphs and quads are in font pixel units of this font.
+     * `textSize()` and `textAlign()` are applied when drawing and do not invalidate entries.
+     *
+     * glyphs are rasterized when they are drawn for the first time and packed into atlas pages. the
+     * first page is the font image itself, further pages are added when a page is full. only the
+     * regions of new glyphs are uploaded. if the pages exceed the atlas budget ( see
+     * `set_atlas_budget()` ) the least recently drawn page is cleared and its glyphs are rasterized
+     * again when needed.
+     *
+     * in SDF mode ( see `set_sdf_mode()` ) glyphs are stored as signed distance fields generated from
+     * the outlines and drawn with a distance field shader. text then stays sharp at any `textSize()`,
+     * scale or rotation, a font size of 32–64px is usually sufficient for all sizes.
+     */
     class PFont final : public PImage {
-        const std::string character_atlas_default = " ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789!@#$%^&*()[]{}-_=+;:'\",<.>/?`~—";
-
     public:
         explicit PFont(const std::string& filepath, int font_size, float pixelDensity = 1);
         PFont(const uint8_t* data, size_t size, float pixel_size, float pixelDensity = 1);
 
-        static constexpr int atlas_pixel_width       = 512;
-        static constexpr int atlas_character_padding = 2;
-        const float          font_size;
+        static constexpr int    atlas_character_padding   = 2;
+        static constexpr int    DEFAULT_ATLAS_PAGE_SIZE   = 1024;             // NOTE doubled for large font sizes
+        static constexpr size_t DEFAULT_ATLAS_BUDGET      = 16 * 1024 * 1024; // NOTE in bytes
+        static constexpr size_t DEFAULT_TEXT_CACHE_BUDGET = 1024 * 1024;      // NOTE in bytes
+        static constexpr int    DEFAULT_SDF_SPREAD        = 8;                // NOTE in font pixels
+        static constexpr float  DEFAULT_OUTLINE_TOLERANCE = 0.25f;            // NOTE max deviation of flattened curves in font pixels
+        const float             font_size;
+
+        struct TextCacheStats {
+            uint64_t hits{0};
+            uint64_t misses{0};
+            uint64_t evictions{0};
+            size_t   entries{0};
+            size_t   bytes{0};
+            size_t   budget{0};
+
+            float hit_rate() const { return hits + misses > 0 ? static_cast<float>(hits) / static_cast<float>(hits + misses) : 0.0f; }
+        };
+
+        /**
+         * outline and triangles of a glyph in font pixels, relative to the pen position with the y-axis
+         * pointing down. meshes are created once per glyph id and can be reused e.g as instanced meshes.
+         */
+        struct GlyphMesh {
+            std::vector<std::vector<glm::vec2>> contours; // NOTE curves are flattened to `outline_tolerance`
+            std::vector<glm::vec2>              triangles;
+        };
+
+        struct GlyphPlacement {
+            uint32_t  glyph_id{};
+            glm::vec2 position{}; // NOTE pen position in font pixels
+        };
+
+        struct AtlasStats {
+            int      pages{0};
+            int      page_size{0};
+            size_t   glyphs{0}; // NOTE glyphs currently in the atlas
+            uint64_t rasterized{0};
+            uint64_t evicted_pages{0};
+            size_t   bytes{0};
+            size_t   budget{0};
+        };
 
         static PImage* create_image(const std::string& text) {
             error("PImage / implement `create_image`: ", text);
@@ -112,7 +178,7 @@ namespace umfeld {
             }
 
             const float text_scale = text_size / font_size;
-            return get_text_width(*font, str) * text_scale;
+            return get_shaped_text(str).width * text_scale;
         }
 
         void textSize(const float size) {
@@ -123,18 +189,35 @@ namespace umfeld {
             text_leading = leading;
         }
 
+        void           set_text_cache_budget(size_t bytes); // NOTE `0` disables the cache
+        void           clear_text_cache();
+        TextCacheStats get_text_cache_stats() const;
+        void           print_text_cache_stats() const;
+        void           set_atlas_budget(size_t bytes); // NOTE applied when the next page is needed
+        AtlasStats     get_atlas_stats() const;
+        void           print_atlas_stats() const;
+        void           set_sdf_mode(bool enable, int spread = DEFAULT_SDF_SPREAD); // NOTE clears the atlas
+        bool           is_sdf_mode() const { return sdf_mode; }
+
         ~PFont() override;
 
     private:
         struct Glyph {
-            std::vector<unsigned char> bitmap;
-            int                        width{};
-            int                        height{};
-            int                        left{};
-            int                        top{};
-            int                        advance{};
-            int                        atlas_x{};
-            int                        atlas_y{};
+            int width{};
+            int height{};
+            int left{};
+            int top{};
+            int advance{};
+            int page{-1}; // NOTE `-1` if the glyph has no bitmap e.g space
+            int atlas_x{};
+            int atlas_y{};
+        };
+
+        struct AtlasPage {
+            PImage*               image{nullptr};
+            SkylinePacker         packer;
+            std::vector<uint32_t> glyphs;
+            uint64_t              last_used{0}; // NOTE `draw_serial` of the last draw that used the page
         };
 
         struct FontData {
@@ -142,26 +225,65 @@ namespace umfeld {
             int                                 ascent{};
             int                                 descent{};
             int                                 line_gap{};
-            int                                 atlas_width{};
-            int                                 atlas_height{};
-            std::vector<unsigned char>          atlas;
             FT_Face                             face{nullptr};
             hb_font_t*                          hb_font{nullptr};
             hb_buffer_t*                        buffer{nullptr};
+            hb_language_t                       language{nullptr}; // NOTE looked up once, not per shaping call
             std::vector<uint8_t>                bytes;
         };
 
-        std::vector<TexturedQuad> text_quads;
-        FontData*                 font{nullptr};
-        FT_Library                freetype{nullptr};
-        float                     text_size{1};
-        float                     text_leading{0};
-        int                       text_align_x{LEFT};
-        int                       text_align_y{BASELINE};
+        struct ShapedGlyph {
+            uint32_t glyph_id{};
+            int      x_advance{}; // NOTE positions in 26.6 fixed point as returned by harfbuzz
+            int      y_advance{};
+            int      x_offset{};
+            int      y_offset{};
+        };
+
+        struct ShapedText {
+            std::vector<ShapedGlyph>  glyphs;
+            std::vector<TexturedQuad> quads;
+            std::vector<int>          quad_pages;
+            uint64_t                  quads_generation{0}; // NOTE quads are regenerated if the atlas generation changed
+            float                     width{0};
+        };
+
+        struct TextCacheEntry {
+            ShapedText                              shaped;
+            size_t                                  bytes{0};
+            std::list<const std::string*>::iterator lru_position;
+        };
+
+        /* --- shaped text cache --- */
+
+        mutable std::unordered_map<std::string, TextCacheEntry> text_cache;
+        mutable std::list<const std::string*>                   text_cache_lru; // NOTE most recently used first
+        mutable ShapedText                                      text_cache_scratch;
+        mutable TextCacheStats                                  text_cache_stats;
+        size_t                                                  text_cache_budget{DEFAULT_TEXT_CACHE_BUDGET};
+
+        /* --- glyph atlas --- */
+
+        std::vector<AtlasPage> atlas_pages;
+        int                    atlas_page_size{DEFAULT_ATLAS_PAGE_SIZE};
+        size_t                 atlas_budget{DEFAULT_ATLAS_BUDGET};
+        uint64_t               atlas_generation{1};
+        uint64_t               atlas_rasterized{0};
+        uint64_t               atlas_evicted_pages{0};
+        uint64_t               draw_serial{0};
+        bool                   sdf_mode{false};
+        int                    sdf_spread{DEFAULT_SDF_SPREAD};
+
+        FontData*  font{nullptr};
+        FT_Library freetype{nullptr};
+        float      text_size{1};
+        float      text_leading{0};
+        int        text_align_x{LEFT};
+        int        text_align_y{BASELINE};
 
 #ifdef PFONT_DEBUG_FONT
-        void DEBUG_save_font_atlas(const FontData& font, const std::string& output_path) const;
-        void DEBUG_save_text(const FontData& font, const char* text, const std::string& outputfile) const;
+        void DEBUG_save_font_atlas(const std::string& output_path) const;
+        void DEBUG_save_text(const char* text, const std::string& outputfile);
 #endif //PFONT_DEBUG_FONT
 
         // static std::u16string utf8_to_utf16(std::string& utf8) {
@@ -169,44 +291,27 @@ namespace umfeld {
         //     return convert.from_bytes(utf8);
         // }
 
-        static void create_font_atlas(FontData& font, const std::string& characters_in_atlas);
-
-        static void copy_atlas_to_rgba(const FontData& font, unsigned char* atlas_rgba) {
-            for (int y = 0; y < font.atlas_height; y++) {
-                for (int x = 0; x < font.atlas_width; x++) {
-                    const unsigned char val = font.atlas[y * font.atlas_width + x];
-                    const int           idx = (y * font.atlas_width + x) * 4;
-                    // Store grayscale value into RGBA channels (transparent text on white fond)
-                    atlas_rgba[idx + 0] = 255; // R
-                    atlas_rgba[idx + 1] = 255; // G
-                    atlas_rgba[idx + 2] = 255; // B
-                    atlas_rgba[idx + 3] = val; // A (fully opaque)
-                }
-            }
-        }
-
-        static float get_text_width(const FontData& font, const std::string& text) {
-            hb_buffer_clear_contents(font.buffer);
-
-            hb_buffer_add_utf8(font.buffer, text.c_str(), -1, 0, -1);
-            hb_buffer_set_direction(font.buffer, HB_DIRECTION_LTR);
-            hb_buffer_set_script(font.buffer, HB_SCRIPT_LATIN);
-            hb_buffer_set_language(font.buffer, hb_language_from_string("en", 2));
-
-            hb_shape(font.hb_font, font.buffer, nullptr, 0);
-
-            unsigned int               glyph_count;
-            const hb_glyph_position_t* glyph_pos = hb_buffer_get_glyph_positions(font.buffer, &glyph_count);
-
-            float width = 0.0f;
-            for (unsigned int i = 0; i < glyph_count; ++i) {
-                width += static_cast<float>(glyph_pos[i].x_advance) / 64.0f; // divide by 64 to convert from subpixels
-            }
-
-            return width;
+        static void  init_font_metrics(FontData& font);
+        void         init_atlas();
+        const Glyph* get_glyph(uint32_t glyph_id, PGraphics* g);
+        bool         allocate_glyph(int block_width, int block_height, int& page_index, int& x, int& y, PGraphics* g);
+        bool         load_glyph_sdf(uint32_t glyph_id) const;
+        int          add_atlas_page();
+        void         clear_atlas_page(AtlasPage& page);
+        void         evict_atlas_page(int page_index, PGraphics* g);
+        void         clear_atlas();
+        void         generate_quads(ShapedText& shaped, PGraphics* g);
+        void         update_atlas_pages(PGraphics* g) const;
+        static void  copy_bitmap_to_page(const FT_Bitmap& bitmap, PImage* page, int x, int y);
+
+        static void add_vertex(std::vector<Vertex>& vertices, const glm::mat4& transform, const glm::vec4& color, const float x, const float y, const float u, const float v) {
+            const glm::vec4 position = transform * glm::vec4(x, y, 0.0f, 1.0f);
+            vertices.emplace_back(glm::vec3(position), color, glm::vec3(u, v, 0.0f));
         }
 
-        static void generate_text_quads(const FontData& font, const std::string& text, std::vector<TexturedQuad>& quads);
+        static void shape_text(const FontData& font, const std::string& text, ShapedText& shaped);
+        ShapedText& get_shaped_text(const std::string& text) const;
+        void        evict_text_cache(size_t budget) const;
 
         static std::vector<std::string> split_lines(const std::string& text) {
             std::vector<std::string> lines;
@@ -222,39 +327,74 @@ namespace umfeld {
         void draw(PGraphics* g, const std::string& text, float x, float y, float z = 0);
 
     private:
+        /* --- glyph outlines --- */
+
+        static constexpr int MAX_CURVE_SEGMENTS = 64;
+
+        mutable std::unordered_map<uint32_t, GlyphMesh> outline_cache;
+        mutable std::unique_ptr<Triangulator>            outline_triangulator;
+        float                                           outline_tolerance{DEFAULT_OUTLINE_TOLERANCE};
+        std::unordered_map<uint32_t, VertexBuffer*>     glyph_buffers; // NOTE uploaded once per glyph id, drawn with `draw_meshes()`
+
+        VertexBuffer* get_glyph_buffer(uint32_t glyph_id, const glm::vec4& color);
+
         struct OutlineContext {
-            std::vector<std::vector<glm::vec2>>& outlines;
+            std::vector<std::vector<glm::vec2>>& contours;
             glm::vec2                            current_point;
-            float                                scale;
+            float                                tolerance;
 
-            OutlineContext(std::vector<std::vector<glm::vec2>>& out, const float scale)
-                : outlines(out), current_point(), scale(scale) {
-                outlines.emplace_back();
-            }
+            OutlineContext(std::vector<std::vector<glm::vec2>>& out, const float tolerance)
+                : contours(out), current_point(), tolerance(tolerance) {}
 
             void move_to(const float x, const float y) {
-                outlines.emplace_back();
-                current_point = {x * scale, -y * scale}; // flip y and scale
-                outlines.back().push_back(current_point);
+                contours.emplace_back();
+                current_point = {x, -y}; // flip y
+                contours.back().push_back(current_point);
             }
 
             void line_to(const float x, const float y) {
-                current_point = {x * scale, -y * scale};
-                outlines.back().push_back(current_point);
+                current_point = {x, -y};
+                contours.back().push_back(current_point);
             }
 
-            void conic_to(float cx, float cy, const float x, const float y) {
-                // Approximate conic (quadratic Bézier) with straight line
-                // TODO: replace with curve tessellation if needed
-                current_point = {x * scale, -y * scale};
-                outlines.back().push_back(current_point);
+            void conic_to(const float cx, const float cy, const float x, const float y) {
+                const glm::vec2 p0       = current_point;
+                const glm::vec2 p1       = {cx, -cy};
+                const glm::vec2 p2       = {x, -y};
+                const int       segments = segment_count(0.25f * glm::length(p0 - 2.0f * p1 + p2));
+                for (int i = 1; i < segments; ++i) {
+                    const float t = static_cast<float>(i) / static_cast<float>(segments);
+                    const float u = 1.0f - t;
+                    contours.back().push_back(u * u * p0 + 2.0f * u * t * p1 + t * t * p2);
+                }
+                current_point = p2;
+                contours.back().push_back(current_point);
+            }
+
+            void cubic_to(const float cx1, const float cy1, const float cx2, const float cy2, const float x, const float y) {
+                const glm::vec2 p0       = current_point;
+                const glm::vec2 p1       = {cx1, -cy1};
+                const glm::vec2 p2       = {cx2, -cy2};
+                const glm::vec2 p3       = {x, -y};
+                const float     dd       = std::max(glm::length(p0 - 2.0f * p1 + p2), glm::length(p1 - 2.0f * p2 + p3));
+                const int       segments = segment_count(0.75f * dd);
+                for (int i = 1; i < segments; ++i) {
+                    const float t = static_cast<float>(i) / static_cast<float>(segments);
+                    const float u = 1.0f - t;
+                    contours.back().push_back(u * u * u * p0 + 3.0f * u * u * t * p1 + 3.0f * u * t * t * p2 + t * t * t * p3);
+                }
+                current_point = p3;
+                contours.back().push_back(current_point);
             }
 
-            void cubic_to(float cx1, float cy1, float cx2, float cy2, const float x, const float y) {
-                // Approximate cubic Bézier with straight line
-                // TODO: replace with curve tessellation if needed
-                current_point = {x * scale, -y * scale};
-                outlines.back().push_back(current_point);
+            /**
+             * number of segments so that a flattened curve deviates less than `tolerance` from the curve
+             * ( Wang's formula ). `weighted_difference` is `d * ( d - 1 ) / 8` times the largest second
+             * difference of the control points of a curve of degree `d`.
+             */
+            int segment_count(const float weighted_difference) const {
+                const auto segments = static_cast<int>(std::ceil(std::sqrt(weighted_difference / tolerance)));
+                return std::clamp(segments, 1, MAX_CURVE_SEGMENTS);
             }
         };
 
@@ -286,6 +426,12 @@ namespace umfeld {
         }
 
     public:
-        void outline(const std::string& text, std::vector<std::vector<glm::vec2>>& outlines) const;
+        void             outline(const std::string& text, std::vector<std::vector<glm::vec2>>& outlines) const;
+        void             triangulate(const std::string& text, std::vector<glm::vec2>& triangles) const;
+        void             layout_glyphs(const std::string& text, std::vector<GlyphPlacement>& placements) const;
+        const GlyphMesh* get_glyph_mesh(uint32_t glyph_id) const;
+        void             draw_meshes(PGraphics* g, const std::string& text, float x, float y, float z = 0);
+        void             set_outline_tolerance(float tolerance); // NOTE clears the outline cache
+        void             clear_outline_cache();
     };
 } // namespace umfeld
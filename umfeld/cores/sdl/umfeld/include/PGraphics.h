@@ -27,6 +27,7 @@
 #include "UmfeldTypes.h"
 #include "UmfeldFunctionsAdditional.h"
 #include "PImage.h"
+#include "YUV.h"
 #include "Vertex.h"
 #include "UShape.h"
 #include "Triangulator.h"
@@ -37,15 +38,18 @@ namespace umfeld {
     class VertexBuffer;
     class PShader;
     class UShapeRenderer;
+    class TextureAtlas;
 
     class PGraphics : public virtual PImage {
     public:
         struct FrameBufferObject {
             uint32_t id{};
             uint32_t texture_id{};
+            uint32_t depth_buffer_id{};
             int      width{};
             int      height{};
             bool     msaa{false};
+            int      samples{0};
         };
 
         FrameBufferObject framebuffer{};
@@ -154,8 +158,8 @@ namespace umfeld {
         virtual void vertex(float x, float y, float z = 0.0f);
         virtual void vertex(float x, float y, float z, float u, float v);
         virtual void vertex(const Vertex& v);
-        void         submit_stroke_shape(bool closed, bool force_transparent = false) const;
-        void         submit_fill_shape(bool closed, bool force_transparent = false) const;
+        void         submit_stroke_shape(bool closed, bool force_transparent = false);
+        void         submit_fill_shape(bool closed, bool force_transparent = false);
 
         // ## Structure
 
@@ -196,6 +200,8 @@ namespace umfeld {
         virtual void     shader(PShader* shader);
         virtual PShader* loadShader(const std::string& vertex_code, const std::string& fragment_code, const std::string& geometry_code = "") { return nullptr; };
         virtual void     resetShader();
+        PShader*         get_shader() const { return current_custom_shader; }
+        virtual PShader* get_text_sdf_shader() { return nullptr; } // NOTE shader for `PFont` in SDF mode
         virtual void     normal(float x, float y, float z, float w = 0);
         virtual void     blendMode(const BlendMode mode) { current_blend_mode = mode; }
         virtual void     beginCamera();
@@ -223,9 +229,19 @@ namespace umfeld {
         using PImage::loadPixels;
         void         loadPixels() { download_texture(this); }
         void         updatePixels() { update_full_internal(this); }
+        void         loadPixelsAsync() { request_colorbuffer_readback(); }
+        bool         pixelsReady() { return poll_colorbuffer_readback(pixels); }
         virtual void pixelDensity(int density);
         virtual int  displayDensity();
 
+        /* --- text batching --- */
+
+        std::vector<Vertex>& text_batch(PImage* texture, PShader* shader);
+        void                 submit_text_batches();
+        void                 set_text_batching(const bool enable) { text_batching = enable; } // NOTE if disabled each `text()` call is submitted as its own shape
+        bool                 get_text_batching() const { return text_batching; }
+        glm::vec4            get_fill_color() const { return as_vec4(color_fill); }
+
         /* --- additional --- */
 
         virtual void        flush();
@@ -258,12 +274,19 @@ namespace umfeld {
         virtual void        texture_wrap(TextureWrap wrap, glm::vec4 color_fill = glm::vec4(0.0f)) {}
         virtual int         texture_update_and_bind(PImage* img) { return 0; }
         virtual void        upload_texture(PImage* img, const uint32_t* pixel_data, int width, int height, int offset_x, int offset_y) {}
+        virtual void        upload_texture_region(PImage* img, int x, int y, int width, int height);
+        virtual bool        upload_texture_yuv(PImage* img, const YUVFrame& frame) { return false; } // NOTE returns false if the renderer can not convert YUV planes
         virtual void        download_texture(PImage* img) {}
         virtual void        upload_colorbuffer(uint32_t* pixels) {}
         virtual void        download_colorbuffer(uint32_t* pixels) {}
+        virtual void        request_colorbuffer_readback() { colorbuffer_readback_requested = true; }
+        virtual bool        poll_colorbuffer_readback(uint32_t* pixels);
         virtual void        update_full_internal(PImage* img) {}
+        virtual void        release_framebuffer() {}
         virtual void        set_shader_program(PShader* shader, ShaderProgramType shader_role);
         virtual BlendMode   get_blend_mode() const { return current_blend_mode; }
+        void                set_texture_atlas(TextureAtlas* atlas) { texture_atlas = atlas; }
+        TextureAtlas*       get_texture_atlas() const { return texture_atlas; }
 
         template<typename T>
         void text(const T& value, const float x, const float y, const float z = 0.0f) {
@@ -290,6 +313,12 @@ namespace umfeld {
         PShader*                         current_custom_shader{nullptr};
         PImage*                          texture_stack_top{nullptr}; // NOTE not really a stack yet ;)
         bool                             texture_stack_used{false};
+        inline static const glm::vec4    TEXTURE_REGION_FULL{0.0f, 0.0f, 1.0f, 1.0f};
+        TextureAtlas*                    texture_atlas{nullptr};
+        glm::vec4                        current_texture_region{TEXTURE_REGION_FULL}; // NOTE u0, v0, u1, v1 ( e.g atlas region )
+        glm::vec4                        texture_stack_region{TEXTURE_REGION_FULL};
+        PImage*                          current_texture_packed{nullptr}; // NOTE image drawn from an atlas page, `nullptr` if not packed
+        PImage*                          texture_stack_packed{nullptr};
         StrokeState                      current_stroke_state;
         BlendMode                        current_blend_mode{BLEND};
         std::stack<StyleState>           style_stack;
@@ -329,9 +358,23 @@ namespace umfeld {
         RenderMode                       render_mode{RENDER_MODE_SORTED_BY_SUBMISSION_ORDER};
         bool                             in_camera_block{false};
         const UFont*                     debug_font{nullptr};
+
+        struct TextBatch {
+            uint16_t            texture_id{TEXTURE_NONE};
+            PShader*            shader{nullptr};
+            std::vector<Vertex> vertices; // NOTE in world space
+        };
+
+        std::vector<TextBatch> text_batches; // NOTE one batch per font atlas texture and shader
+        bool                   text_batching{true};
+        float                  text_batch_depth{0.0f}; // NOTE view space depth of the text in the current batches
+
+        void begin_text_batch(float x, float y, float z);
+
         void (*triangle_emitter_callback)(std::vector<Vertex>&){nullptr};
         void (*stroke_emitter_callback)(std::vector<Vertex>&, bool){nullptr};
         bool current_force_transparent{false};
+        bool colorbuffer_readback_requested{false};
 
     public:
         glm::mat4              model_matrix{};
@@ -351,8 +394,10 @@ namespace umfeld {
 
         void push_texture_id() {
             if (!texture_stack_used) {
-                texture_stack_top  = current_texture;
-                texture_stack_used = true;
+                texture_stack_top    = current_texture;
+                texture_stack_region = current_texture_region;
+                texture_stack_packed = current_texture_packed;
+                texture_stack_used   = true;
             } else {
                 warning("unbalanced texture id *push*/pop");
             }
@@ -360,9 +405,12 @@ namespace umfeld {
 
         void pop_texture_id() {
             if (texture_stack_used) {
-                current_texture    = texture_stack_top;
-                texture_stack_top  = nullptr;
-                texture_stack_used = false;
+                current_texture        = texture_stack_top;
+                current_texture_region = texture_stack_region;
+                current_texture_packed = texture_stack_packed;
+                texture_stack_top      = nullptr;
+                texture_stack_packed   = nullptr;
+                texture_stack_used     = false;
             } else {
                 warning("unbalanced texture id push/*pop*");
             }
@@ -389,6 +437,12 @@ namespace umfeld {
             vertex(position.x, position.y, position.z, tex_coords.x, tex_coords.y);
         }
 
+        glm::vec3 map_to_texture_region(const glm::vec3& tex_coord) const {
+            return {current_texture_region.x + tex_coord.x * (current_texture_region.z - current_texture_region.x),
+                    current_texture_region.y + tex_coord.y * (current_texture_region.w - current_texture_region.y),
+                    tex_coord.z};
+        }
+
         static glm::vec4 as_vec4(const ColorState& color) {
             return {color.r, color.g, color.b, color.a};
         }
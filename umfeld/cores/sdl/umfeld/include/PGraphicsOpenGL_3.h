@@ -35,11 +35,16 @@ namespace umfeld {
         void restore_fbo_state() override;
         void bind_fbo() override;
         void finish_fbo() override {}
+        void release_framebuffer() override;
 
         void upload_texture(PImage* img, const uint32_t* pixel_data, int width, int height, int offset_x, int offset_y) override;
+        void upload_texture_region(PImage* img, int x, int y, int width, int height) override;
+        bool upload_texture_yuv(PImage* img, const YUVFrame& frame) override;
         void download_texture(PImage* img) override;
         void upload_colorbuffer(uint32_t* pixels) override;
         void download_colorbuffer(uint32_t* pixels) override;
+        void request_colorbuffer_readback() override;
+        bool poll_colorbuffer_readback(uint32_t* pixels) override;
 
         void beginDraw() override;
         void endDraw() override;
@@ -66,6 +71,7 @@ namespace umfeld {
         void        shader(PShader* shader) override;
         PShader*    loadShader(const std::string& vertex_code, const std::string& fragment_code, const std::string& geometry_code = "") override;
         void        resetShader() override;
+        PShader*    get_text_sdf_shader() override { return shader_text_sdf; }
         void        lights() override;
         void        noLights() override;
         void        ambientLight(float r, float g, float b, float x = 0, float y = 0, float z = 0) override;
@@ -96,10 +102,44 @@ namespace umfeld {
         static constexpr uint8_t NUM_FILL_VERTEX_ATTRIBUTES_XYZ_RGBA_UV = 9;
         static constexpr uint8_t NUM_STROKE_VERTEX_ATTRIBUTES_XYZ_RGBA  = 7;
         PShader*                 shader_fullscreen_texture{nullptr};
+        PShader*                 shader_text_sdf{nullptr};
         int32_t                  previously_bound_read_FBO = 0;
         int32_t                  previously_bound_draw_FBO = 0;
         int32_t                  previous_viewport[4]{};
         int32_t                  previous_shader{0};
+        static constexpr int     NUM_UNPACK_PBOS = 2;
+        bool                     async_texture_upload{false};
+        uint32_t                 unpack_pbo[NUM_UNPACK_PBOS]{};
+        int                      unpack_pbo_index{0};
+
+        /* --- asynchronous color buffer readback --- */
+
+        struct ReadbackSlot {
+            uint32_t pbo{0};
+            void*    fence{nullptr}; // NOTE `GLsync`
+            int      width{0};
+            int      height{0};
+            bool     pending{false};
+        };
+
+        static constexpr int NUM_READBACK_SLOTS = 3;
+        ReadbackSlot         readback_slots[NUM_READBACK_SLOTS]{};
+        int                  readback_write_index{0};
+        int                  readback_read_index{0};
+        uint32_t             readback_resolve_fbo{0};
+        uint32_t             readback_resolve_texture{0};
+        int                  readback_resolve_width{0};
+        int                  readback_resolve_height{0};
+
+        /* --- YUV texture conversion --- */
+
+        PShader* shader_yuv_to_rgba{nullptr};
+        uint32_t yuv_plane_textures[3]{};
+        int      yuv_plane_width[3]{};
+        int      yuv_plane_height[3]{};
+        bool     yuv_plane_two_channels[3]{};
+        uint32_t yuv_fbo{0};
+        uint32_t yuv_vao{0};
 
         /* --- lights --- */
 
@@ -121,6 +161,9 @@ namespace umfeld {
         // void        OGL3_update_shader_matrices(PShader* shader) const;
         // static void OGL3_reset_shader_matrices(PShader* shader);
         void OGL3_flip_pixel_buffer(uint32_t* pixels);
+        void OGL3_upload_sub_image(const uint32_t* pixel_data, int row_length, int x, int y, int width, int height);
         void OGL3_draw_fullscreen_texture(uint32_t texture_id) const;
+        void OGL3_bind_readback_framebuffer();
+        void OGL3_upload_yuv_plane(int plane, const uint8_t* data, int stride, int width, int height, bool two_channels);
     };
 } // namespace umfeld
@@ -19,6 +19,7 @@
 
 #pragma once
 
+#include <vector>
 #include <SDL3/SDL.h>
 #include "UmfeldConstants.h"
 
@@ -58,6 +59,23 @@ namespace umfeld {
         void update(PGraphics* graphics, const uint32_t* pixel_data, int width, int height, int offset_x, int offset_y);
         void update(PGraphics* graphics, const float* pixel_data, int width, int height, int offset_x, int offset_y);
 
+        /* --- dirty regions --- */
+
+        struct DirtyRegion {
+            int x;
+            int y;
+            int width;
+            int height;
+        };
+
+        static constexpr int   MAX_DIRTY_REGIONS              = 8;
+        static constexpr float DIRTY_REGIONS_FULL_UPLOAD_RATIO = 0.5f; // NOTE upload full image if dirty regions cover more than this ratio
+
+        void                            mark_dirty(int x, int y, int w, int h);
+        bool                            has_dirty_regions() const { return !dirty_regions.empty(); }
+        const std::vector<DirtyRegion>& get_dirty_regions() const { return dirty_regions; }
+        void                            clear_dirty_regions() { dirty_regions.clear(); }
+
         void set(const uint16_t x, const uint16_t y, const uint32_t c) const {
             if (x >= static_cast<uint16_t>(width) || y >= static_cast<uint16_t>(height)) {
                 return;
@@ -111,6 +129,8 @@ namespace umfeld {
         TextureFilter texture_filter{LINEAR};
         bool          texture_filter_dirty{true};
 
+        std::vector<DirtyRegion> dirty_regions;
+
         void update_full_internal(PGraphics* graphics);
 
     public:
@@ -0,0 +1,105 @@
+/*
+ * Umfeld
+ *
+ * This file is part of the *Umfeld* library (https://github.com/dennisppaul/umfeld).
+ * Copyright (c) 2025 Dennis P Paul.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace umfeld {
+    class PGraphics;
+
+    /**
+     * hands out and recycles offscreen render targets ( `PGraphics` ) by size and MSAA samples. targets
+     * that are released go back into the pool and are reused by the next `acquire()` with the same
+     * configuration. targets that stay idle for more than `max_idle_frames` calls to `update()` are
+     * destroyed.
+     *
+     * NOTE the content of a reused target is undefined, it should be cleared with `background()`.
+     *      all pixels are RGBA8, the format is therefore not part of the key.
+     */
+    class RenderTargetPool {
+    public:
+        static constexpr int DEFAULT_MAX_IDLE_FRAMES = 60;
+
+        struct Stats {
+            int      live_targets{0}; // NOTE targets currently acquired
+            int      idle_targets{0};
+            uint64_t live_bytes{0}; // NOTE estimated GPU memory of color and depth attachments
+            uint64_t idle_bytes{0};
+            int      created{0};
+            int      reused{0};
+            int      destroyed{0};
+        };
+
+        explicit RenderTargetPool(int max_idle_frames = DEFAULT_MAX_IDLE_FRAMES);
+        ~RenderTargetPool();
+
+        RenderTargetPool(const RenderTargetPool&)            = delete;
+        RenderTargetPool& operator=(const RenderTargetPool&) = delete;
+
+        PGraphics* acquire(int width, int height, int msaa_samples = 0);
+        void       release(PGraphics* target);
+        void       update();
+        void       clear();
+        Stats      get_stats() const;
+        void       print_stats() const;
+
+    private:
+        struct Target {
+            PGraphics* graphics{nullptr};
+            int        width{0};
+            int        height{0};
+            int        msaa_samples{0};
+            bool       in_use{false};
+            int        idle_frames{0};
+        };
+
+        const int           max_idle_frames;
+        std::vector<Target> targets;
+        int                 created_count{0};
+        int                 reused_count{0};
+        int                 destroyed_count{0};
+
+        static uint64_t estimate_bytes(const Target& target);
+        void            destroy(const Target& target);
+    };
+
+    /**
+     * pair of render targets for feedback effects. draw `source()` into `target()` and call `swap()`
+     * afterwards, the result is then available as `source()`.
+     */
+    class PingPongTarget {
+    public:
+        PingPongTarget(RenderTargetPool& pool, int width, int height, int msaa_samples = 0);
+        ~PingPongTarget();
+
+        PingPongTarget(const PingPongTarget&)            = delete;
+        PingPongTarget& operator=(const PingPongTarget&) = delete;
+
+        PGraphics* source() const { return targets[source_index]; }
+        PGraphics* target() const { return targets[1 - source_index]; }
+        void       swap() { source_index = 1 - source_index; }
+
+    private:
+        RenderTargetPool& pool;
+        PGraphics*        targets[2]{nullptr, nullptr};
+        int               source_index{0};
+    };
+} // namespace umfeld
@@ -0,0 +1,93 @@
+/*
+ * Umfeld
+ *
+ * This file is part of the *Umfeld* library (https://github.com/dennisppaul/umfeld).
+ * Copyright (c) 2025 Dennis P Paul.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace umfeld {
+    /**
+     * wait-free single-producer single-consumer queue e.g to pass events from the main or a MIDI
+     * thread to the audio thread. neither side blocks or allocates, `try_push()` fails if the queue is
+     * full. the capacity is rounded up to a power of two.
+     *
+     * NOTE items are copied into preallocated slots, `T` should be cheap to copy.
+     */
+    template<typename T>
+    class SPSCQueue {
+    public:
+        explicit SPSCQueue(const size_t min_capacity) {
+            size_t capacity = 1;
+            while (capacity < min_capacity) {
+                capacity <<= 1;
+            }
+            items.resize(capacity);
+            mask = capacity - 1;
+        }
+
+        SPSCQueue(const SPSCQueue&)            = delete;
+        SPSCQueue& operator=(const SPSCQueue&) = delete;
+
+        size_t capacity() const { return items.size(); }
+
+        /* --- producer --- */
+
+        bool try_push(const T& item) {
+            const uint64_t write = write_index.load(std::memory_order_relaxed);
+            if (write - read_index.load(std::memory_order_acquire) >= items.size()) {
+                return false;
+            }
+            items[write & mask] = item;
+            write_index.store(write + 1, std::memory_order_release);
+            return true;
+        }
+
+        /* --- consumer --- */
+
+        bool try_pop(T& item) {
+            const uint64_t read = read_index.load(std::memory_order_relaxed);
+            if (read == write_index.load(std::memory_order_acquire)) {
+                return false;
+            }
+            item = items[read & mask];
+            read_index.store(read + 1, std::memory_order_release);
+            return true;
+        }
+
+        /* --- either side --- */
+
+        size_t size() const {
+            return static_cast<size_t>(write_index.load(std::memory_order_acquire) -
+                                       read_index.load(std::memory_order_acquire));
+        }
+
+        bool empty() const { return size() == 0; }
+
+    private:
+        std::vector<T> items;
+        size_t         mask{0};
+        // NOTE indices on separate cache lines to avoid false sharing between producer and consumer
+        alignas(64) std::atomic<uint64_t> write_index{0};
+        alignas(64) std::atomic<uint64_t> read_index{0};
+    };
+} // namespace umfeld
@@ -0,0 +1,57 @@
+/*
+ * Umfeld
+ *
+ * This file is part of the *Umfeld* library (https://github.com/dennisppaul/umfeld).
+ * Copyright (c) 2025 Dennis P Paul.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace umfeld {
+    /**
+     * packs rectangles into an area with a skyline i.e the upper edge of all packed rectangles. new
+     * rectangles are placed at the lowest position ( bottom-left heuristic, ties are resolved by the
+     * narrowest skyline segment ). space of single rectangles can not be reclaimed, only the whole area
+     * can be reset.
+     */
+    class SkylinePacker {
+    public:
+        SkylinePacker() = default;
+        SkylinePacker(int width, int height);
+
+        void reset(int width, int height);
+        bool pack(int block_width, int block_height, int& x, int& y);
+        int  get_width() const { return width; }
+        int  get_height() const { return height; }
+
+    private:
+        struct SkylineNode {
+            int x;
+            int y;
+            int width;
+        };
+
+        std::vector<SkylineNode> skyline;
+        int                      width{0};
+        int                      height{0};
+
+        int  fit(size_t node_index, int block_width, int block_height) const;
+        void add(size_t node_index, int x, int y, int block_width, int block_height);
+    };
+} // namespace umfeld
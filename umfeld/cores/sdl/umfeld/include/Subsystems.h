@@ -19,6 +19,7 @@
 
 #pragma once
 
+#include <functional>
 #include <SDL3/SDL.h>
 
 #include "PGraphics.h"
@@ -32,6 +33,17 @@ namespace umfeld {
         void set_debounce_interval(int interval);
     } // namespace subsystem::graphics_terminal
 
+    namespace subsystem::audio_offline {
+        // NOTE configure the offline audio subsystem ( `umfeld_create_subsystem_audio_offline()` ) in `settings()`
+        void  set_output_file(const std::string& file_path); // NOTE WAV file, empty path renders without writing
+        void  set_duration(float seconds);                   // NOTE 0 renders until shutdown
+        void  set_input_silence();
+        void  set_input_file(const std::string& file_path); // NOTE WAV or MP3 file, is looped
+        void  set_input_generator(const std::function<float(uint64_t frame, int channel)>& generator);
+        bool  is_finished();
+        float get_realtime_factor();
+    } // namespace subsystem::audio_offline
+
     struct Subsystem {
         void (*set_flags)(uint32_t& subsystem_flags);
         bool (*init)();
@@ -117,5 +129,6 @@ umfeld::SubsystemGraphics*  umfeld_create_subsystem_graphics_openglves30();
 umfeld::SubsystemGraphics*  umfeld_create_subsystem_graphics_openglv33();
 umfeld::SubsystemAudio*     umfeld_create_subsystem_audio_sdl();
 umfeld::SubsystemAudio*     umfeld_create_subsystem_audio_portaudio();
+umfeld::SubsystemAudio*     umfeld_create_subsystem_audio_offline();
 umfeld::Subsystem*          umfeld_create_subsystem_hid();
 umfeld::SubsystemLibraries* umfeld_create_subsystem_libraries();
@@ -0,0 +1,111 @@
+/*
+ * Umfeld
+ *
+ * This file is part of the *Umfeld* library (https://github.com/dennisppaul/umfeld).
+ * Copyright (c) 2025 Dennis P Paul.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <glm/glm.hpp>
+
+#include "UmfeldConstants.h"
+#include "PImage.h"
+#include "SkylinePacker.h"
+
+namespace umfeld {
+    class PGraphics;
+
+    /**
+     * packs small images into shared atlas pages so that many sprites can be drawn with the same texture.
+     * images are packed on first use ( e.g `image()` or `texture()` ) with a skyline packer. the atlas is
+     * opt-in and must be set with `PGraphics::set_texture_atlas()`.
+     *
+     * NOTE images are only packed if they are small enough, have pixel data, use `CLAMP_TO_EDGE` wrapping
+     *      and no mipmaps. pixel changes of packed images must be propagated with `update()`.
+     *      images must be removed with `remove()` before they are deleted.
+     */
+    class TextureAtlas {
+    public:
+        static constexpr int DEFAULT_PAGE_SIZE      = 2048;
+        static constexpr int DEFAULT_MAX_IMAGE_SIZE = 256;
+        static constexpr int DEFAULT_PADDING        = 1;
+
+        struct Region {
+            PImage*   page{nullptr};
+            int       page_index{0};
+            int       x{0}; // NOTE position of the image in the page ( excluding padding )
+            int       y{0};
+            int       width{0};
+            int       height{0};
+            glm::vec4 uv{0.0f, 0.0f, 1.0f, 1.0f}; // NOTE u0, v0, u1, v1
+        };
+
+        struct Stats {
+            int      pages{0};
+            int      images{0};
+            uint64_t used_pixels{0};
+            uint64_t total_pixels{0};
+            float    occupancy{0.0f}; // NOTE ratio of used to total pixels in all pages
+            int      repacks{0};
+            int      rejected_images{0}; // NOTE images that were not packed and are drawn with their own texture
+        };
+
+        explicit TextureAtlas(int page_size = DEFAULT_PAGE_SIZE, int max_image_size = DEFAULT_MAX_IMAGE_SIZE, int padding = DEFAULT_PADDING);
+        ~TextureAtlas();
+
+        TextureAtlas(const TextureAtlas&)            = delete;
+        TextureAtlas& operator=(const TextureAtlas&) = delete;
+
+        const Region* get_region(PGraphics* graphics, PImage* image);
+        bool          accepts(const PImage* image) const;
+        bool          contains(const PImage* image) const { return regions.find(image) != regions.end(); }
+        void          update(PGraphics* graphics, PImage* image);
+        void          remove(const PImage* image);
+        void          repack(PGraphics* graphics);
+        void          clear();
+        Stats         get_stats() const;
+        void          print_stats() const;
+        int           get_page_size() const { return page_size; }
+        int           get_max_image_size() const { return max_image_size; }
+
+    private:
+        struct Page {
+            PImage*       image{nullptr};
+            TextureFilter filter{LINEAR};
+            SkylinePacker packer;
+            uint64_t      used_pixels{0};
+        };
+
+        const int                                  page_size;
+        const int                                  max_image_size;
+        const int                                  padding;
+        std::vector<Page>                          pages;
+        std::unordered_map<const PImage*, Region>  regions;
+        std::unordered_map<const PImage*, PImage*> region_images; // NOTE non-const handles to packed images ( used for repacking )
+        int                                        repack_count{0};
+        std::unordered_set<const PImage*>          rejected_images; // NOTE counted once per image
+        std::vector<uint32_t>                      block_buffer;
+
+        bool        insert(PGraphics* graphics, PImage* image);
+        bool        pack_into_page(int page_index, int block_width, int block_height, int& x, int& y);
+        int         add_page(TextureFilter filter);
+        void        reset_page(Page& page) const;
+        void        copy_into_page(PGraphics* graphics, const Region& region, const PImage* image);
+    };
+} // namespace umfeld
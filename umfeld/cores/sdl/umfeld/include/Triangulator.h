@@ -21,6 +21,7 @@ namespace umfeld {
         ~Triangulator();
         std::vector<Vertex>    triangulate(const std::vector<Vertex>& inputVertices, Winding winding = WINDING_ODD) const;
         std::vector<glm::vec2> triangulate(const std::vector<glm::vec2>& inputVertices, Winding winding = WINDING_ODD) const;
+        std::vector<glm::vec2> triangulate(const std::vector<std::vector<glm::vec2>>& contours, Winding winding = WINDING_NONZERO) const;
 
     private:
         void                            allocate();
@@ -129,4 +130,49 @@ namespace umfeld {
 
         return outputTriangles;
     }
+
+    /**
+     * triangulates a shape made of several contours e.g a glyph with holes.
+     */
+    inline std::vector<glm::vec2> Triangulator::triangulate(const std::vector<std::vector<glm::vec2>>& contours, const Winding winding) const {
+        std::vector<glm::vec2> outputTriangles;
+
+        bool has_contours = false;
+        for (const auto& contour: contours) {
+            if (contour.size() < 3) {
+                continue;
+            }
+            tessAddContour(mTess.get(), 2, contour.data(), sizeof(glm::vec2), static_cast<int>(contour.size()));
+            has_contours = true;
+        }
+        if (!has_contours) {
+            return outputTriangles;
+        }
+
+        if (!tessTesselate(mTess.get(), winding, TESS_POLYGONS, 3, 2, nullptr)) {
+            return outputTriangles;
+        }
+
+        const float* tessVertices = tessGetVertices(mTess.get());
+        const int*   tessElements = tessGetElements(mTess.get());
+        const int    elementCount = tessGetElementCount(mTess.get());
+
+        outputTriangles.reserve(elementCount * 3);
+
+        for (int i = 0; i < elementCount * 3; i += 3) {
+            const int idx0 = tessElements[i];
+            const int idx1 = tessElements[i + 1];
+            const int idx2 = tessElements[i + 2];
+
+            if (idx0 == TESS_UNDEF || idx1 == TESS_UNDEF || idx2 == TESS_UNDEF) {
+                continue;
+            }
+
+            outputTriangles.emplace_back(tessVertices[idx0 * 2], tessVertices[idx0 * 2 + 1]);
+            outputTriangles.emplace_back(tessVertices[idx1 * 2], tessVertices[idx1 * 2 + 1]);
+            outputTriangles.emplace_back(tessVertices[idx2 * 2], tessVertices[idx2 * 2 + 1]);
+        }
+
+        return outputTriangles;
+    }
 } // namespace umfeld
\ No newline at end of file
@@ -0,0 +1,78 @@
+/*
+ * Umfeld
+ *
+ * This file is part of the *Umfeld* library (https://github.com/dennisppaul/umfeld).
+ * Copyright (c) 2025 Dennis P Paul.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace umfeld {
+    /**
+     * lock-free triple buffer to publish the latest value from one writer thread ( e.g the audio thread )
+     * to one reader thread ( e.g the main thread ). the writer fills `write_buffer()` and calls
+     * `publish()`, the reader calls `update()` and then reads `read_buffer()`. neither side blocks,
+     * values that are published faster than they are read are skipped.
+     *
+     * NOTE `T` is constructed three times up front, buffers are swapped and never copied.
+     */
+    template<typename T>
+    class TripleBuffer {
+    public:
+        TripleBuffer() = default;
+
+        /** initializes all three buffers with `value` e.g to preallocate vectors */
+        explicit TripleBuffer(const T& value) : buffers{value, value, value} {}
+
+        TripleBuffer(const TripleBuffer&)            = delete;
+        TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+        /* --- writer --- */
+
+        T& write_buffer() { return buffers[write_index]; }
+
+        void publish() {
+            const uint8_t previous = middle.exchange(static_cast<uint8_t>(write_index | DIRTY), std::memory_order_acq_rel);
+            write_index            = previous & INDEX_MASK;
+        }
+
+        /* --- reader --- */
+
+        /** returns `true` if a new value was published since the last call */
+        bool update() {
+            if ((middle.load(std::memory_order_relaxed) & DIRTY) == 0) {
+                return false;
+            }
+            const uint8_t previous = middle.exchange(read_index, std::memory_order_acq_rel);
+            read_index             = previous & INDEX_MASK;
+            return true;
+        }
+
+        const T& read_buffer() const { return buffers[read_index]; }
+
+    private:
+        static constexpr uint8_t DIRTY      = 0x4;
+        static constexpr uint8_t INDEX_MASK = 0x3;
+
+        T buffers[3];
+        // NOTE indices on separate cache lines to avoid false sharing between writer and reader
+        alignas(64) uint8_t write_index{0};
+        alignas(64) std::atomic<uint8_t> middle{1};
+        alignas(64) uint8_t read_index{2};
+    };
+} // namespace umfeld
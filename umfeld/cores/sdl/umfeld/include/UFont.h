@@ -19,6 +19,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <vector>
 
 #include "Vertex.h"
@@ -73,7 +74,16 @@ namespace umfeld {
 
         PImage* atlas() const { return font_atlas.get(); }
 
-        static std::vector<Vertex> generate(std::vector<Vertex>& vertices, const std::string& text, const float startX, const float startY, glm::vec4 color) {
+        /**
+         * appends two triangles per character to `vertices`. positions are transformed by `transform`
+         * e.g to add text in world space.
+         */
+        static void generate(std::vector<Vertex>& vertices, const std::string& text, const float startX, const float startY, const glm::vec4& color, const glm::mat4& transform = glm::mat4(1.0f)) {
+            // NOTE `vertices` may be a shared text batch, grow geometrically to avoid reallocating on every call
+            const size_t required = vertices.size() + text.size() * 6;
+            if (required > vertices.capacity()) {
+                vertices.reserve(std::max(required, 2 * vertices.capacity()));
+            }
             float x = startX, y = startY;
             for (const char c: text) {
                 const int       index = static_cast<unsigned char>(c) - 32;
@@ -82,17 +92,22 @@ namespace umfeld {
                 constexpr float uSize = 1.0f / ATLAS_COLS;
                 constexpr float vSize = 1.0f / ATLAS_ROWS;
 
-                vertices.emplace_back(x, y, 0, color.r, color.g, color.b, color.a, u, v);
-                vertices.emplace_back(x + _CHAR_WIDTH, y, 0, color.r, color.g, color.b, color.a, u + uSize, v);
-                vertices.emplace_back(x + _CHAR_WIDTH, y + _CHAR_HEIGHT, 0, color.r, color.g, color.b, color.a, u + uSize, v + vSize);
+                add_vertex(vertices, transform, color, x, y, u, v);
+                add_vertex(vertices, transform, color, x + _CHAR_WIDTH, y, u + uSize, v);
+                add_vertex(vertices, transform, color, x + _CHAR_WIDTH, y + _CHAR_HEIGHT, u + uSize, v + vSize);
 
-                vertices.emplace_back(x, y, 0, color.r, color.g, color.b, color.a, u, v);
-                vertices.emplace_back(x + _CHAR_WIDTH, y + _CHAR_HEIGHT, 0, color.r, color.g, color.b, color.a, u + uSize, v + vSize);
-                vertices.emplace_back(x, y + _CHAR_HEIGHT, 0, color.r, color.g, color.b, color.a, u, v + vSize);
+                add_vertex(vertices, transform, color, x, y, u, v);
+                add_vertex(vertices, transform, color, x + _CHAR_WIDTH, y + _CHAR_HEIGHT, u + uSize, v + vSize);
+                add_vertex(vertices, transform, color, x, y + _CHAR_HEIGHT, u, v + vSize);
 
                 x += _CHAR_WIDTH;
             }
-            return vertices;
+        }
+
+    private:
+        static void add_vertex(std::vector<Vertex>& vertices, const glm::mat4& transform, const glm::vec4& color, const float x, const float y, const float u, const float v) {
+            const glm::vec4 position = transform * glm::vec4(x, y, 0.0f, 1.0f);
+            vertices.emplace_back(position.x, position.y, position.z, color.r, color.g, color.b, color.a, u, v);
         }
     };
 } // namespace umfeld
@@ -71,8 +71,10 @@ namespace umfeld {
 #ifndef UMFELD_DISABLE_DEPRECATED_AUDIO
     [[deprecated("use 'audio_device' instead")]]
 #endif
-    inline PAudio*& a                   = audio_device;
-    inline bool     run_audio_in_thread = DEFAULT_AUDIO_RUN_IN_THREAD;
+    inline PAudio*& a                     = audio_device;
+    inline bool     run_audio_in_thread   = DEFAULT_AUDIO_RUN_IN_THREAD;
+    inline bool     run_audio_in_callback = DEFAULT_AUDIO_RUN_IN_CALLBACK; // NOTE see `AudioUnitInfo::callback`
+    inline int      audio_queue_depth     = DEFAULT_AUDIO_QUEUE_DEPTH;
 #ifndef UMFELD_DISABLE_DEPRECATED_AUDIO
     [[deprecated("use 'void audioEvent(const PAudio& audio) {}' instead")]]
 #endif
@@ -56,6 +56,8 @@ namespace umfeld {
     static constexpr int8_t   DEFAULT_INPUT_CHANNELS        = -1;
     static constexpr int8_t   DEFAULT_OUTPUT_CHANNELS       = -1;
     static constexpr bool     DEFAULT_AUDIO_RUN_IN_THREAD   = false;
+    static constexpr bool     DEFAULT_AUDIO_RUN_IN_CALLBACK = false;
+    static constexpr int      DEFAULT_AUDIO_QUEUE_DEPTH     = 1;
     static constexpr bool     DEFAULT_UPDATE_RUN_IN_THREAD  = false;
     static constexpr int      DEFAULT_BYTES_PER_PIXELS      = 4;
     static constexpr int      DEFAULT_SPHERE_RESOLUTION     = 15;
@@ -189,7 +191,9 @@ namespace umfeld {
         ENABLE_SMOOTH_LINES = 0xA0,
         DISABLE_SMOOTH_LINES,
         ENABLE_DEPTH_TEST,
-        DISABLE_DEPTH_TEST
+        DISABLE_DEPTH_TEST,
+        ENABLE_ASYNC_TEXTURE_UPLOAD, // upload textures via double-buffered pixel unpack buffers
+        DISABLE_ASYNC_TEXTURE_UPLOAD
     };
     enum Renderer {
         RENDERER_DEFAULT = DEFAULT,          // default renderer based on platform and configuration
@@ -148,6 +148,8 @@ namespace umfeld {
     void     lights();
     void     noLights();
     void     loadPixels(bool update_logical_buffer = true);
+    void     loadPixelsAsync();
+    bool     pixelsReady(bool update_logical_buffer = true);
     void     updatePixels(bool update_logical_buffer = true);
 
     /* --- additional --- */
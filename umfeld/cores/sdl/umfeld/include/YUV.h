@@ -0,0 +1,74 @@
+/*
+ * Umfeld
+ *
+ * This file is part of the *Umfeld* library (https://github.com/dennisppaul/umfeld).
+ * Copyright (c) 2025 Dennis P Paul.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace umfeld {
+    enum YUVFormat {
+        YUV_FORMAT_I420 = 0, // NOTE Y, U and V planes, chroma subsampled horizontally and vertically
+        YUV_FORMAT_I422,     // NOTE Y, U and V planes, chroma subsampled horizontally
+        YUV_FORMAT_NV12,     // NOTE Y plane and interleaved UV plane, chroma subsampled horizontally and vertically
+    };
+
+    enum YUVColorSpace {
+        YUV_COLOR_SPACE_BT601 = 0,
+        YUV_COLOR_SPACE_BT709,
+    };
+
+    /**
+     * view onto the planes of a YUV frame e.g decoded by libav. `planes[2]` is unused for NV12.
+     */
+    struct YUVFrame {
+        const uint8_t* planes[3]{nullptr, nullptr, nullptr};
+        int            strides[3]{0, 0, 0}; // NOTE in bytes
+        int            width{0};
+        int            height{0};
+        YUVFormat      format{YUV_FORMAT_I420};
+        YUVColorSpace  color_space{YUV_COLOR_SPACE_BT601};
+        bool           full_range{false};
+
+        int chroma_width() const { return (width + 1) / 2; }
+        int chroma_height() const { return format == YUV_FORMAT_I422 ? height : (height + 1) / 2; }
+    };
+
+    /**
+     * coefficients of the YUV to RGB conversion:
+     *
+     *     R = y_scale * ( Y - y_offset ) + v_to_r * ( V - 0.5 )
+     *     G = y_scale * ( Y - y_offset ) - u_to_g * ( U - 0.5 ) - v_to_g * ( V - 0.5 )
+     *     B = y_scale * ( Y - y_offset ) + u_to_b * ( U - 0.5 )
+     */
+    struct YUVCoefficients {
+        float y_offset;
+        float y_scale;
+        float v_to_r;
+        float u_to_g;
+        float v_to_g;
+        float u_to_b;
+    };
+
+    YUVCoefficients get_yuv_coefficients(YUVColorSpace color_space, bool full_range);
+    /**
+     * converts a YUV frame to RGBA pixels in the layout of `PImage::pixels` ( `width * height` pixels ).
+     * uses SSE2 or NEON if available.
+     */
+    void yuv_to_rgba(const YUVFrame& frame, uint32_t* pixels);
+} // namespace umfeld
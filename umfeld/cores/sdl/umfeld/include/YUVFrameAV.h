@@ -0,0 +1,76 @@
+/*
+ * Umfeld
+ *
+ * This file is part of the *Umfeld* library (https://github.com/dennisppaul/umfeld).
+ * Copyright (c) 2025 Dennis P Paul.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#if !defined(DISABLE_GRAPHICS) && !defined(DISABLE_VIDEO)
+
+extern "C" {
+#include <libavutil/frame.h>
+#include <libavutil/pixfmt.h>
+}
+
+#include "YUV.h"
+
+namespace umfeld {
+    /**
+     * wraps the planes of a decoded frame without copying. returns false for pixel formats that have no
+     * YUV texture path ( i.e everything except 4:2:0, 4:2:2 and NV12 with 8 bits per sample ).
+     */
+    inline bool get_yuv_frame(const AVFrame* frame, YUVFrame& yuv) {
+        if (frame == nullptr || frame->data[0] == nullptr) {
+            return false;
+        }
+        bool jpeg_range = false;
+        switch (frame->format) {
+            case AV_PIX_FMT_YUVJ420P:
+                jpeg_range = true;
+                [[fallthrough]];
+            case AV_PIX_FMT_YUV420P:
+                yuv.format = YUV_FORMAT_I420;
+                break;
+            case AV_PIX_FMT_YUVJ422P:
+                jpeg_range = true;
+                [[fallthrough]];
+            case AV_PIX_FMT_YUV422P:
+                yuv.format = YUV_FORMAT_I422;
+                break;
+            case AV_PIX_FMT_NV12:
+                yuv.format = YUV_FORMAT_NV12;
+                break;
+            default:
+                return false;
+        }
+        const int num_planes = yuv.format == YUV_FORMAT_NV12 ? 2 : 3;
+        for (int i = 0; i < 3; i++) {
+            if (i < num_planes && frame->linesize[i] < 0) {
+                return false; // NOTE bottom-up planes are not supported
+            }
+            yuv.planes[i]  = i < num_planes ? frame->data[i] : nullptr;
+            yuv.strides[i] = i < num_planes ? frame->linesize[i] : 0;
+        }
+        yuv.width       = frame->width;
+        yuv.height      = frame->height;
+        yuv.color_space = frame->colorspace == AVCOL_SPC_BT709 ? YUV_COLOR_SPACE_BT709 : YUV_COLOR_SPACE_BT601;
+        yuv.full_range  = jpeg_range || frame->color_range == AVCOL_RANGE_JPEG;
+        return true;
+    }
+} // namespace umfeld
+
+#endif // !DISABLE_GRAPHICS && !DISABLE_VIDEO
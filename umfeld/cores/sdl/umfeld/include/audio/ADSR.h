@@ -147,6 +147,10 @@ namespace umfeld {
             return fState == ENVELOPE_STATE::IDLE;
         }
 
+        float get_amplitude() const {
+            return fAmp;
+        }
+
     private:
         enum class ENVELOPE_STATE {
             IDLE,
@@ -28,21 +28,21 @@
 #include "Umfeld.h"
 
 /**
- * @brief write audio files in WAV format, mono 32-bit float
- * TODO add support for other formats and multi-channels
+ * @brief write audio files in WAV format, 32-bit float. multi-channel buffers are interleaved.
+ * TODO add support for other formats
  */
 class AudioFileWriter {
 public:
-    explicit AudioFileWriter(uint32_t sample_rate = DEFAULT_SAMPLE_RATE) : opened(false), wav() {
+    explicit AudioFileWriter(uint32_t sample_rate = umfeld::DEFAULT_SAMPLE_RATE, uint16_t channels = 1) : opened(false), wav() {
         format.container     = drwav_container_riff; // <-- drwav_container_riff = normal WAV files, drwav_container_w64 = Sony Wave64.
         format.format        = DR_WAVE_FORMAT_IEEE_FLOAT;
-        format.channels      = 1;
+        format.channels      = channels > 0 ? channels : 1;
         format.sampleRate    = sample_rate;
         format.bitsPerSample = 32;
     }
 
     ~AudioFileWriter() {
-        drwav_uninit(&wav);
+        close();
     }
 
     bool open(const std::string& filename) {
@@ -57,6 +57,10 @@ public:
         return true;
     }
 
+    /**
+     * @param length number of frames
+     * @param buffer interleaved samples i.e `length * channels` samples
+     */
     int write(size_t length, const float* buffer) {
         if (!opened) {
             return 0;
@@ -0,0 +1,467 @@
+/*
+ * Umfeld
+ *
+ * This file is part of the *Umfeld* library (https://github.com/dennisppaul/umfeld).
+ * Copyright (c) 2025 Dennis P Paul.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "ADSR.h"
+#include "Filter.h"
+#include "LowPassFilter.h"
+#include "Reverb.h"
+#include "Sampler.h"
+#include "Trigger.h"
+#include "Wavetable.h"
+
+namespace umfeld {
+    /**
+     * node in an `AudioGraph`. the signals of all connected sources are summed into `signal_buffer`
+     * which is then processed in place i.e generators overwrite it, effects transform it and analysers
+     * just read it.
+     */
+    class AudioNode {
+    public:
+        virtual ~AudioNode()                                              = default;
+        virtual void process(float* signal_buffer, uint32_t buffer_length) = 0;
+    };
+
+    /**
+     * wraps one of the DSP classes ( `ADSR`, `Filter`, `LowPassFilter`, `Wavetable`, `Sampler`,
+     * `Reverb` or `Trigger` ) as a node. the node owns the processor, it is accessible as `processor`.
+     */
+    template<class PROCESSOR>
+    class AudioProcessorNode final : public AudioNode {
+    public:
+        template<typename... Args>
+        explicit AudioProcessorNode(Args&&... args) : processor(std::forward<Args>(args)...) {}
+
+        void process(float* signal_buffer, const uint32_t buffer_length) override {
+            processor.process(signal_buffer, buffer_length);
+        }
+
+        PROCESSOR processor;
+    };
+
+    template<>
+    inline void AudioProcessorNode<Reverb>::process(float* signal_buffer, const uint32_t buffer_length) {
+        for (uint32_t i = 0; i < buffer_length; i++) {
+            signal_buffer[i] = processor.process(signal_buffer[i]);
+        }
+    }
+
+    using ADSRNode          = AudioProcessorNode<ADSR>;
+    using FilterNode        = AudioProcessorNode<Filter>;
+    using LowPassFilterNode = AudioProcessorNode<LowPassFilter>;
+    using WavetableNode     = AudioProcessorNode<Wavetable>;
+    using SamplerNode       = AudioProcessorNode<Sampler>;
+    using ReverbNode        = AudioProcessorNode<Reverb>;
+    using TriggerNode       = AudioProcessorNode<Trigger>;
+
+    /**
+     * block-based processing graph of mono audio nodes.
+     *
+     * the graph is edited from the main thread with `add()`, `remove()`, `connect()` and `disconnect()`.
+     * each edit compiles a new schedule: the nodes in topological order plus an assignment of
+     * intermediate buffers from a pool. a buffer returns to the pool after the last node reading it
+     * has been processed, and a node with a single source that is the last node reading the source's
+     * buffer processes it in place. the schedule is handed to the audio thread through an atomic
+     * pointer, neither thread blocks and `process()` does not allocate.
+     *
+     * NOTE replaced schedules and the nodes only they reference are freed on the main thread in the
+     *      next edit or in `update()`, which should be called regularly e.g once per frame.
+     *
+     * e.g:
+     *
+     *     auto osc = graph.add<WavetableNode>(512, 48000);
+     *     auto env = graph.add<ADSRNode>(48000);
+     *     graph.connect(osc, env);
+     *     graph.connect_output(env);
+     *     ...
+     *     graph.process(output_buffer, buffer_length); // in the audio thread
+     */
+    class AudioGraph {
+    public:
+        static constexpr uint32_t DEFAULT_MAX_BLOCK_SIZE = 512;
+
+        struct Stats {
+            int nodes{0};
+            int connections{0};
+            int buffers{0}; // NOTE intermediate buffers after liveness reuse
+        };
+
+        explicit AudioGraph(const uint32_t max_block_size = DEFAULT_MAX_BLOCK_SIZE) : max_block_size(std::max(max_block_size, 1u)) {}
+
+        ~AudioGraph() {
+            // NOTE the audio thread must no longer call `process()`
+            delete pending.exchange(nullptr, std::memory_order_acq_rel);
+            delete retired.exchange(nullptr, std::memory_order_acq_rel);
+            delete active;
+        }
+
+        AudioGraph(const AudioGraph&)            = delete;
+        AudioGraph& operator=(const AudioGraph&) = delete;
+
+        /* --- main thread --- */
+
+        template<class NODE, typename... Args>
+        std::shared_ptr<NODE> add(Args&&... args) {
+            auto node = std::make_shared<NODE>(std::forward<Args>(args)...);
+            add(node);
+            return node;
+        }
+
+        void add(const std::shared_ptr<AudioNode>& node) {
+            if (node == nullptr || index_of(node.get()) >= 0) {
+                return;
+            }
+            nodes.push_back(node);
+            publish();
+        }
+
+        /**
+         * removes a node and all its connections.
+         */
+        void remove(const std::shared_ptr<AudioNode>& node) {
+            const int index = index_of(node.get());
+            if (index < 0) {
+                return;
+            }
+            connections.erase(std::remove_if(connections.begin(), connections.end(),
+                                             [&node](const Connection& c) { return c.source == node.get() || c.destination == node.get(); }),
+                              connections.end());
+            outputs.erase(std::remove(outputs.begin(), outputs.end(), node.get()), outputs.end());
+            nodes.erase(nodes.begin() + index);
+            publish();
+        }
+
+        /**
+         * adds the signal of `source` to the input of `destination`. returns false if one of the nodes is
+         * not part of the graph or if the connection would create a cycle.
+         */
+        bool connect(const std::shared_ptr<AudioNode>& source, const std::shared_ptr<AudioNode>& destination) {
+            if (index_of(source.get()) < 0 || index_of(destination.get()) < 0 || source == destination) {
+                return false;
+            }
+            if (is_connected(source.get(), destination.get())) {
+                return true;
+            }
+            if (is_reachable(destination.get(), source.get())) {
+                return false;
+            }
+            connections.push_back({source.get(), destination.get()});
+            publish();
+            return true;
+        }
+
+        void disconnect(const std::shared_ptr<AudioNode>& source, const std::shared_ptr<AudioNode>& destination) {
+            const auto it = std::find_if(connections.begin(), connections.end(),
+                                         [&](const Connection& c) { return c.source == source.get() && c.destination == destination.get(); });
+            if (it == connections.end()) {
+                return;
+            }
+            connections.erase(it);
+            publish();
+        }
+
+        /**
+         * adds the signal of `node` to the output of the graph.
+         */
+        bool connect_output(const std::shared_ptr<AudioNode>& node) {
+            if (index_of(node.get()) < 0) {
+                return false;
+            }
+            if (std::find(outputs.begin(), outputs.end(), node.get()) == outputs.end()) {
+                outputs.push_back(node.get());
+                publish();
+            }
+            return true;
+        }
+
+        void disconnect_output(const std::shared_ptr<AudioNode>& node) {
+            const auto it = std::find(outputs.begin(), outputs.end(), node.get());
+            if (it == outputs.end()) {
+                return;
+            }
+            outputs.erase(it);
+            publish();
+        }
+
+        /**
+         * frees schedules that the audio thread no longer uses.
+         */
+        void update() {
+            delete retired.exchange(nullptr, std::memory_order_acq_rel);
+        }
+
+        Stats get_stats() const {
+            Stats stats;
+            stats.nodes       = static_cast<int>(nodes.size());
+            stats.connections = static_cast<int>(connections.size());
+            stats.buffers     = compiled_buffer_count;
+            return stats;
+        }
+
+        uint32_t get_max_block_size() const { return max_block_size; }
+
+        /* --- audio thread --- */
+
+        /**
+         * renders `buffer_length` samples of the graph output into `signal_buffer`. blocks longer than
+         * `max_block_size` are split.
+         */
+        void process(float* signal_buffer, const uint32_t buffer_length) {
+            acquire_schedule();
+            if (active == nullptr) {
+                std::fill_n(signal_buffer, buffer_length, 0.0f);
+                return;
+            }
+            for (uint32_t offset = 0; offset < buffer_length; offset += max_block_size) {
+                process_block(*active, signal_buffer + offset, std::min(max_block_size, buffer_length - offset));
+            }
+        }
+
+        void process(float* signal_buffer_left, float* signal_buffer_right, const uint32_t buffer_length) {
+            process(signal_buffer_left, buffer_length);
+            std::copy_n(signal_buffer_left, buffer_length, signal_buffer_right);
+        }
+
+    private:
+        struct Connection {
+            AudioNode* source;
+            AudioNode* destination;
+        };
+
+        struct Step {
+            AudioNode*       node{nullptr};
+            int              buffer{-1};
+            bool             in_place{false}; // NOTE buffer already holds the signal of the only source
+            std::vector<int> inputs;
+        };
+
+        struct Schedule {
+            std::vector<std::shared_ptr<AudioNode>> nodes; // NOTE keeps nodes alive while the schedule is in use
+            std::vector<Step>                       steps;
+            std::vector<int>                        outputs;
+            std::vector<float>                      buffers;
+            uint32_t                                max_block_size{0};
+
+            float* buffer(const int index) { return buffers.data() + static_cast<size_t>(index) * max_block_size; }
+        };
+
+        const uint32_t                          max_block_size;
+        std::vector<std::shared_ptr<AudioNode>> nodes;
+        std::vector<Connection>                 connections;
+        std::vector<AudioNode*>                 outputs;
+        int                                     compiled_buffer_count{0};
+        std::atomic<Schedule*>                  pending{nullptr}; // NOTE written by main thread, taken by audio thread
+        std::atomic<Schedule*>                  retired{nullptr}; // NOTE written by audio thread, freed by main thread
+        Schedule*                               active{nullptr};  // NOTE only accessed by audio thread
+
+        int index_of(const AudioNode* node) const {
+            for (size_t i = 0; i < nodes.size(); ++i) {
+                if (nodes[i].get() == node) {
+                    return static_cast<int>(i);
+                }
+            }
+            return -1;
+        }
+
+        bool is_connected(const AudioNode* source, const AudioNode* destination) const {
+            return std::any_of(connections.begin(), connections.end(),
+                               [&](const Connection& c) { return c.source == source && c.destination == destination; });
+        }
+
+        bool is_reachable(const AudioNode* from, const AudioNode* to) const {
+            std::vector<const AudioNode*> stack{from};
+            std::vector<const AudioNode*> visited;
+            while (!stack.empty()) {
+                const AudioNode* node = stack.back();
+                stack.pop_back();
+                if (node == to) {
+                    return true;
+                }
+                if (std::find(visited.begin(), visited.end(), node) != visited.end()) {
+                    continue;
+                }
+                visited.push_back(node);
+                for (const auto& c: connections) {
+                    if (c.source == node) {
+                        stack.push_back(c.destination);
+                    }
+                }
+            }
+            return false;
+        }
+
+        /**
+         * sorts the nodes topologically and assigns pooled buffers by liveness.
+         */
+        Schedule* compile() {
+            auto* schedule           = new Schedule();
+            schedule->nodes          = nodes;
+            schedule->max_block_size = max_block_size;
+
+            const size_t     n = nodes.size();
+            std::vector<int> in_degree(n, 0);
+            for (const auto& c: connections) {
+                in_degree[index_of(c.destination)]++;
+            }
+            std::vector<int> order;
+            order.reserve(n);
+            for (size_t i = 0; i < n; ++i) {
+                if (in_degree[i] == 0) {
+                    order.push_back(static_cast<int>(i));
+                }
+            }
+            for (size_t i = 0; i < order.size(); ++i) {
+                for (const auto& c: connections) {
+                    if (c.source == nodes[order[i]].get()) {
+                        const int d = index_of(c.destination);
+                        if (--in_degree[d] == 0) {
+                            order.push_back(d);
+                        }
+                    }
+                }
+            }
+
+            // NOTE a buffer is live until the last step reading it, outputs are read after all steps
+            std::vector<int> position(n, 0);
+            for (size_t i = 0; i < order.size(); ++i) {
+                position[order[i]] = static_cast<int>(i);
+            }
+            const int        end = static_cast<int>(order.size());
+            std::vector<int> last_use(n, -1);
+            for (const auto& c: connections) {
+                const int s = index_of(c.source);
+                last_use[s] = std::max(last_use[s], position[index_of(c.destination)]);
+            }
+            for (const auto* output: outputs) {
+                last_use[index_of(output)] = end;
+            }
+
+            std::vector<int> node_buffer(n, -1);
+            std::vector<int> free_buffers;
+            int              buffer_count = 0;
+            for (int i = 0; i < end; ++i) {
+                const int node_index = order[i];
+                Step      step;
+                step.node = nodes[node_index].get();
+                for (const auto& c: connections) {
+                    if (c.destination == step.node) {
+                        step.inputs.push_back(node_buffer[index_of(c.source)]);
+                    }
+                }
+                const int source = step.inputs.size() == 1 ? find_single_source(step.node) : -1;
+                if (source >= 0 && last_use[source] == i) {
+                    step.buffer   = node_buffer[source];
+                    step.in_place = true;
+                    step.inputs.clear();
+                } else {
+                    if (free_buffers.empty()) {
+                        step.buffer = buffer_count++;
+                    } else {
+                        step.buffer = free_buffers.back();
+                        free_buffers.pop_back();
+                    }
+                    for (const auto& c: connections) {
+                        if (c.destination == step.node) {
+                            const int s = index_of(c.source);
+                            if (last_use[s] == i) {
+                                free_buffers.push_back(node_buffer[s]);
+                            }
+                        }
+                    }
+                }
+                node_buffer[node_index] = step.buffer;
+                if (last_use[node_index] < 0) {
+                    free_buffers.push_back(step.buffer); // NOTE signal is not read by anyone e.g a `Trigger`
+                }
+                schedule->steps.push_back(std::move(step));
+            }
+            for (const auto* output: outputs) {
+                schedule->outputs.push_back(node_buffer[index_of(output)]);
+            }
+            schedule->buffers.assign(static_cast<size_t>(buffer_count) * max_block_size, 0.0f);
+            compiled_buffer_count = buffer_count;
+            return schedule;
+        }
+
+        int find_single_source(const AudioNode* destination) const {
+            for (const auto& c: connections) {
+                if (c.destination == destination) {
+                    return index_of(c.source);
+                }
+            }
+            return -1;
+        }
+
+        void publish() {
+            update();
+            // NOTE a schedule that was replaced before the audio thread took it was never used
+            delete pending.exchange(compile(), std::memory_order_acq_rel);
+        }
+
+        void acquire_schedule() {
+            // NOTE the previous schedule can only be retired once the main thread freed the last one
+            if (retired.load(std::memory_order_acquire) != nullptr) {
+                return;
+            }
+            Schedule* next = pending.exchange(nullptr, std::memory_order_acq_rel);
+            if (next == nullptr) {
+                return;
+            }
+            retired.store(active, std::memory_order_release);
+            active = next;
+        }
+
+        static void process_block(Schedule& schedule, float* signal_buffer, const uint32_t length) {
+            for (auto& step: schedule.steps) {
+                float* buffer = schedule.buffer(step.buffer);
+                if (!step.in_place) {
+                    if (step.inputs.empty()) {
+                        std::fill_n(buffer, length, 0.0f);
+                    } else {
+                        std::copy_n(schedule.buffer(step.inputs[0]), length, buffer);
+                        for (size_t j = 1; j < step.inputs.size(); ++j) {
+                            const float* input = schedule.buffer(step.inputs[j]);
+                            for (uint32_t i = 0; i < length; ++i) {
+                                buffer[i] += input[i];
+                            }
+                        }
+                    }
+                }
+                step.node->process(buffer, length);
+            }
+            std::fill_n(signal_buffer, length, 0.0f);
+            for (const int output: schedule.outputs) {
+                const float* buffer = schedule.buffer(output);
+                for (uint32_t i = 0; i < length; ++i) {
+                    signal_buffer[i] += buffer[i];
+                }
+            }
+        }
+    };
+} // namespace umfeld
@@ -0,0 +1,268 @@
+/*
+ * Umfeld
+ *
+ * This file is part of the *Umfeld* library (https://github.com/dennisppaul/umfeld).
+ * Copyright (c) 2025 Dennis P Paul.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+
+#include "Filter.h"
+#include "LowPassFilter.h"
+#include "Reverb.h"
+#include "Wavetable.h"
+
+namespace umfeld {
+    /**
+     * parameter that is set from any thread ( e.g `draw()` or an OSC or MIDI callback ) and read by the
+     * audio thread. `set()` only stores the target atomically. the audio thread picks up the target at
+     * the beginning of each block with `update()` and then either smoothes per sample with `next()` or
+     * per block with `advance()`.
+     *
+     * NOTE `update()`, `next()`, `advance()` and `get()` must only be called from the audio thread.
+     */
+    class AudioParameter {
+    public:
+        static constexpr float DEFAULT_SMOOTHING_TIME = 0.02f; // NOTE in seconds
+
+        AudioParameter(const float initial_value, const float sample_rate, const float smoothing_time = DEFAULT_SMOOTHING_TIME)
+            : target(initial_value),
+              sample_rate(sample_rate),
+              value(initial_value),
+              destination(initial_value) {
+            set_smoothing_time(smoothing_time);
+        }
+
+        /* --- any thread --- */
+
+        void  set(const float new_value) { target.store(new_value, std::memory_order_relaxed); }
+        float get_target() const { return target.load(std::memory_order_relaxed); }
+
+        /**
+         * @param smoothing_time time in seconds to glide from the current value to a new target, 0 jumps
+         */
+        void set_smoothing_time(const float smoothing_time) {
+            smoothing_samples.store(static_cast<uint32_t>(std::max(smoothing_time, 0.0f) * sample_rate), std::memory_order_relaxed);
+        }
+
+        /* --- audio thread --- */
+
+        /**
+         * picks up a new target, should be called once at the beginning of each block. returns true if
+         * the value changes in this block i.e if dependent coefficients need to be recomputed.
+         */
+        bool update() {
+            const float new_target = target.load(std::memory_order_relaxed);
+            if (new_target != destination) {
+                destination              = new_target;
+                const uint32_t smoothing = smoothing_samples.load(std::memory_order_relaxed);
+                if (smoothing == 0) {
+                    value = destination;
+                    steps = 0;
+                    return true;
+                }
+                steps = smoothing;
+                delta = (destination - value) / static_cast<float>(steps);
+            }
+            return steps > 0;
+        }
+
+        /**
+         * per sample smoothing, returns the next value.
+         */
+        float next() {
+            if (steps > 0) {
+                steps--;
+                value = steps == 0 ? destination : value + delta;
+            }
+            return value;
+        }
+
+        /**
+         * per block smoothing, skips `length` samples and returns the value at the end of the block.
+         */
+        float advance(const uint32_t length) {
+            if (steps > 0) {
+                if (length >= steps) {
+                    steps = 0;
+                    value = destination;
+                } else {
+                    steps -= length;
+                    value += delta * static_cast<float>(length);
+                }
+            }
+            return value;
+        }
+
+        /**
+         * jumps to `new_value` without smoothing.
+         */
+        void set_now(const float new_value) {
+            target.store(new_value, std::memory_order_relaxed);
+            value       = new_value;
+            destination = new_value;
+            steps       = 0;
+        }
+
+        float get() const { return value; }
+        bool  is_smoothing() const { return steps > 0; }
+
+    private:
+        std::atomic<float>    target;
+        std::atomic<uint32_t> smoothing_samples{0};
+        const float           sample_rate;
+        float                 value;
+        float                 destination;
+        float                 delta{0.0f};
+        uint32_t              steps{0};
+    };
+
+    /**
+     * `Filter` with smoothed parameters. biquad coefficients are recomputed at most once per block in
+     * the audio thread and only while a parameter changes.
+     */
+    class SmoothedFilter {
+    public:
+        SmoothedFilter(const uint8_t type, const float sample_rate, const bool use_fast_math = true)
+            : frequency(1000.0f, sample_rate),
+              bandwidth(1.0f, sample_rate),
+              gain(0.0f, sample_rate),
+              filter(sample_rate, use_fast_math),
+              type(type),
+              sample_rate(sample_rate) {
+            update_coefficients();
+        }
+
+        void process(float* signal_buffer, const uint32_t length) {
+            // NOTE no short-circuit, each parameter must pick up its target
+            const bool changed = frequency.update() | bandwidth.update() | gain.update();
+            if (changed) {
+                frequency.advance(length);
+                bandwidth.advance(length);
+                gain.advance(length);
+                update_coefficients();
+            }
+            filter.process(signal_buffer, length);
+        }
+
+        AudioParameter frequency; // NOTE center frequency in Hz
+        AudioParameter bandwidth; // NOTE in octaves
+        AudioParameter gain;      // NOTE in dB
+        Filter         filter;
+
+    private:
+        const uint8_t type;
+        const float   sample_rate;
+
+        void update_coefficients() {
+            filter.set(type, gain.get(), frequency.get(), bandwidth.get(), sample_rate);
+        }
+    };
+
+    /**
+     * `LowPassFilter` with smoothed cutoff frequency and resonance, applied once per block.
+     */
+    class SmoothedLowPassFilter {
+    public:
+        explicit SmoothedLowPassFilter(const float sample_rate) : frequency(1000.0f, sample_rate),
+                                                                  resonance(0.4f, sample_rate),
+                                                                  filter(sample_rate) {}
+
+        void process(float* signal_buffer, const uint32_t length) {
+            if (frequency.update()) {
+                filter.set_frequency(frequency.advance(length));
+            }
+            if (resonance.update()) {
+                filter.set_resonance(resonance.advance(length));
+            }
+            filter.process(signal_buffer, length);
+        }
+
+        AudioParameter frequency;
+        AudioParameter resonance;
+        LowPassFilter  filter;
+    };
+
+    /**
+     * `Wavetable` with frequency and amplitude smoothed per sample.
+     */
+    class SmoothedWavetable {
+    public:
+        SmoothedWavetable(const uint32_t wavetable_size, const float sample_rate) : frequency(220.0f, sample_rate),
+                                                                                    amplitude(0.75f, sample_rate),
+                                                                                    oscillator(wavetable_size, sample_rate) {
+            oscillator.set_frequency(frequency.get());
+            oscillator.set_amplitude(amplitude.get());
+        }
+
+        void process(float* signal_buffer, const uint32_t length) {
+            const bool frequency_changed = frequency.update();
+            const bool amplitude_changed = amplitude.update();
+            if (!frequency_changed && !amplitude_changed) {
+                oscillator.process(signal_buffer, length);
+                return;
+            }
+            for (uint32_t i = 0; i < length; i++) {
+                if (frequency_changed) {
+                    oscillator.set_frequency(frequency.next());
+                }
+                if (amplitude_changed) {
+                    oscillator.set_amplitude(amplitude.next());
+                }
+                signal_buffer[i] = oscillator.process();
+            }
+        }
+
+        AudioParameter frequency;
+        AudioParameter amplitude;
+        Wavetable      oscillator;
+    };
+
+    /**
+     * `Reverb` with parameters handed over once per block. the reverb glides its parameters itself.
+     */
+    class SmoothedReverb {
+    public:
+        explicit SmoothedReverb(const float sample_rate) : roomsize(0.5f, sample_rate, 0.0f),
+                                                           damp(0.5f, sample_rate, 0.0f),
+                                                           wet(0.3333f, sample_rate, 0.0f) {}
+
+        void process(float* signal_buffer, const uint32_t length) {
+            if (roomsize.update()) {
+                reverb.set_roomsize(roomsize.get());
+            }
+            if (damp.update()) {
+                reverb.set_damp(damp.get());
+            }
+            if (wet.update()) {
+                reverb.set_wet(wet.get());
+            }
+            for (uint32_t i = 0; i < length; i++) {
+                signal_buffer[i] = reverb.process(signal_buffer[i]);
+            }
+        }
+
+        AudioParameter roomsize;
+        AudioParameter damp;
+        AudioParameter wet;
+        Reverb         reverb;
+    };
+} // namespace umfeld
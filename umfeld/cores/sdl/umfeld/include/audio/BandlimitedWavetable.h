@@ -0,0 +1,384 @@
+/*
+ * Umfeld
+ *
+ * This file is part of the *Umfeld* library (https://github.com/dennisppaul/umfeld).
+ * Copyright (c) 2025 Dennis P Paul.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * PROCESSOR INTERFACE
+ *
+ * - [x] float process()
+ * - [ ] float process(float)
+ * - [ ] void process(AudioSignal&)
+ * - [x] void process(float*, uint32_t) *overwrite*
+ * - [ ] void process(float*, float*, uint32_t)
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "pffft.h"
+#include "AudioUtilities.h"
+#include "Wavetable.h"
+
+namespace umfeld {
+    /**
+     * set of band-limited single-cycle tables, one per octave. the table of octave `n` is used for
+     * frequencies from `lowest_frequency * 2^n` to `lowest_frequency * 2^(n+1)` and contains only the
+     * harmonics that stay below the nyquist frequency at the top of that range. the tables are built
+     * once from a spectrum with an inverse FFT and can be shared by many oscillators.
+     *
+     * NOTE the table size is rounded up to a power of two of at least 64 samples ( required by pffft ).
+     */
+    class WavetableMipmap {
+    public:
+        static constexpr uint32_t DEFAULT_TABLE_SIZE       = 2048;
+        static constexpr float    DEFAULT_LOWEST_FREQUENCY = 20.0f;
+        static constexpr int      MAX_OCTAVES              = 16;
+
+        explicit WavetableMipmap(const float    sample_rate,
+                                 const uint32_t table_size       = DEFAULT_TABLE_SIZE,
+                                 const float    lowest_frequency = DEFAULT_LOWEST_FREQUENCY)
+            : sample_rate(sample_rate),
+              table_size(valid_table_size(table_size)),
+              lowest_frequency(std::max(lowest_frequency, 1.0f)) {
+            octave_harmonics.clear();
+            const int max_harmonics = static_cast<int>(this->table_size / 2 - 1);
+            for (int octave = 0; octave < MAX_OCTAVES; ++octave) {
+                const float top       = this->lowest_frequency * std::pow(2.0f, static_cast<float>(octave + 1));
+                const int   harmonics = std::clamp(static_cast<int>(sample_rate * 0.5f / top), 1, max_harmonics);
+                octave_harmonics.push_back(harmonics);
+                if (harmonics == 1) {
+                    break;
+                }
+            }
+            tables.assign(octave_harmonics.size() * (this->table_size + 1), 0.0f);
+            build(WAVEFORM_SINE);
+        }
+
+        /**
+         * builds the tables from the exact harmonic series of sine, triangle, square and sawtooth waves.
+         * the phase and polarity match `Wavetable::fill()`. other waveforms are sampled with
+         * `Wavetable::fill()` and band-limited with `build(const float*)`.
+         */
+        void build(const uint8_t waveform) {
+            std::vector<float> spectrum(table_size, 0.0f);
+            const int          harmonics = static_cast<int>(table_size / 2 - 1);
+            for (int k = 1; k <= harmonics; ++k) {
+                const auto kf = static_cast<float>(k);
+                float      b  = 0.0f; // NOTE amplitude of `sin( 2 * PI * k * phase )`
+                switch (waveform) {
+                    case WAVEFORM_SINE:
+                        b = k == 1 ? 1.0f : 0.0f;
+                        break;
+                    case WAVEFORM_TRIANGLE:
+                    case WAVEFORM_TRIANGLE_HARMONICS:
+                        b = k % 2 == 1 ? (((k - 1) / 2) % 2 == 0 ? 1.0f : -1.0f) * 8.0f / (PIf * PIf * kf * kf) : 0.0f;
+                        break;
+                    case WAVEFORM_SQUARE:
+                    case WAVEFORM_SQUARE_HARMONICS:
+                        b = k % 2 == 1 ? 4.0f / (PIf * kf) : 0.0f;
+                        break;
+                    case WAVEFORM_SAWTOOTH:
+                    case WAVEFORM_SAWTOOTH_HARMONICS:
+                        b = -2.0f / (PIf * kf);
+                        break;
+                    default: {
+                        std::vector<float> single_cycle(table_size);
+                        Wavetable::fill(single_cycle.data(), table_size, waveform);
+                        build(single_cycle.data());
+                        return;
+                    }
+                }
+                // NOTE imaginary part of bin `k` such that the inverse transform yields `b * sin(...)`
+                spectrum[2 * k + 1] = -0.5f * b;
+            }
+            build_from_spectrum(spectrum);
+        }
+
+        /**
+         * builds the tables from a waveform that takes a parameter e.g `WAVEFORM_PULSE` with the pulse
+         * width in percent ( see `Wavetable::fill()` ).
+         */
+        void build(const uint8_t waveform, const int value) {
+            std::vector<float> single_cycle(table_size);
+            Wavetable::fill(single_cycle.data(), table_size, waveform, value);
+            build(single_cycle.data());
+        }
+
+        /**
+         * builds the tables from an arbitrary single cycle of `get_table_size()` samples.
+         */
+        void build(const float* single_cycle) {
+            std::vector<float> spectrum(table_size);
+            transform(single_cycle, spectrum.data(), PFFFT_FORWARD);
+            const float scale = 1.0f / static_cast<float>(table_size);
+            for (auto& s: spectrum) {
+                s *= scale;
+            }
+            build_from_spectrum(spectrum);
+        }
+
+        uint32_t get_table_size() const { return table_size; }
+        int      get_octave_count() const { return static_cast<int>(octave_harmonics.size()); }
+        int      get_harmonics(const int octave) const { return octave_harmonics[std::clamp(octave, 0, get_octave_count() - 1)]; }
+
+        /**
+         * returns the table of an octave. it has `get_table_size() + 1` samples, the last one repeats the
+         * first one to simplify interpolation.
+         */
+        const float* get_table(const int octave) const {
+            return tables.data() + static_cast<size_t>(std::clamp(octave, 0, get_octave_count() - 1)) * (table_size + 1);
+        }
+
+        /**
+         * returns the fractional octave of `frequency` e.g 2.5 is halfway between the tables of octave 2
+         * and 3.
+         */
+        float get_octave(const float frequency) const {
+            if (frequency <= lowest_frequency) {
+                return 0.0f;
+            }
+            return std::min(std::log2(frequency / lowest_frequency), static_cast<float>(get_octave_count() - 1));
+        }
+
+        float get_sample_rate() const { return sample_rate; }
+
+    private:
+        static constexpr float PIf = static_cast<float>(M_PI);
+
+        const float        sample_rate;
+        const uint32_t     table_size;
+        const float        lowest_frequency;
+        std::vector<int>   octave_harmonics;
+        std::vector<float> tables;
+
+        static uint32_t valid_table_size(const uint32_t table_size) {
+            uint32_t size = 64;
+            while (size < table_size) {
+                size <<= 1;
+            }
+            return size;
+        }
+
+        void transform(const float* input, float* output, const pffft_direction_t direction) const {
+            PFFFT_Setup* setup   = pffft_new_setup(static_cast<int>(table_size), PFFFT_REAL);
+            auto*        in      = static_cast<float*>(pffft_aligned_malloc(table_size * sizeof(float)));
+            auto*        out     = static_cast<float*>(pffft_aligned_malloc(table_size * sizeof(float)));
+            auto*        work    = static_cast<float*>(pffft_aligned_malloc(table_size * sizeof(float)));
+            std::copy_n(input, table_size, in);
+            pffft_transform_ordered(setup, in, out, work, direction);
+            std::copy_n(out, table_size, output);
+            pffft_aligned_free(work);
+            pffft_aligned_free(out);
+            pffft_aligned_free(in);
+            pffft_destroy_setup(setup);
+        }
+
+        /**
+         * `spectrum` is in the ordered layout of pffft i.e DC, nyquist and then the real and imaginary
+         * part of each bin. bins above the harmonic limit of each octave are removed. all tables are
+         * scaled by the same factor so that the fullest table peaks at 1.
+         */
+        void build_from_spectrum(const std::vector<float>& spectrum) {
+            std::vector<float> truncated(table_size);
+            std::vector<float> signal(table_size);
+            float              peak = 0.0f;
+            for (int octave = 0; octave < get_octave_count(); ++octave) {
+                std::fill(truncated.begin(), truncated.end(), 0.0f);
+                truncated[0]                = spectrum[0];
+                const uint32_t harmonics    = octave_harmonics[octave];
+                const uint32_t last_element = std::min(2 * harmonics + 2, table_size);
+                std::copy(spectrum.begin() + 2, spectrum.begin() + last_element, truncated.begin() + 2);
+                transform(truncated.data(), signal.data(), PFFFT_BACKWARD);
+
+                float* table = tables.data() + static_cast<size_t>(octave) * (table_size + 1);
+                std::copy_n(signal.data(), table_size, table);
+                table[table_size] = table[0];
+                if (octave == 0) {
+                    for (uint32_t i = 0; i < table_size; ++i) {
+                        peak = std::max(peak, std::fabs(table[i]));
+                    }
+                }
+            }
+            if (peak > 0.0f) {
+                for (auto& s: tables) {
+                    s /= peak;
+                }
+            }
+        }
+    };
+
+    /**
+     * alias-free wavetable oscillator. depending on the frequency it crossfades between the two
+     * tables of a `WavetableMipmap` that are closest in octave, i.e harmonics above the nyquist
+     * frequency fade out smoothly instead of folding back. the mipmap can be shared by many
+     * oscillators and must outlive them.
+     */
+    class BandlimitedWavetable {
+    public:
+        BandlimitedWavetable(const WavetableMipmap* mipmap, const float sample_rate) : mipmap(mipmap), sample_rate(sample_rate) {
+            set_frequency(M_DEFAULT_FREQUENCY);
+        }
+
+        void set_mipmap(const WavetableMipmap* wavetable_mipmap) {
+            mipmap = wavetable_mipmap;
+            update_tables();
+        }
+
+        float get_frequency() const {
+            return frequency;
+        }
+
+        void set_frequency(const float value) {
+            const float new_frequency = std::fabs(value);
+            if (frequency != new_frequency) {
+                frequency = new_frequency;
+                update_tables();
+            }
+        }
+
+        /**
+         * glides from the current to the new frequency in `interpolation_duration_in_samples`.
+         */
+        void set_frequency(const float value, const uint16_t interpolation_duration_in_samples) {
+            if (interpolation_duration_in_samples > 0) {
+                desired_frequency          = value;
+                desired_frequency_steps    = interpolation_duration_in_samples;
+                desired_frequency_fraction = (desired_frequency - frequency) / interpolation_duration_in_samples;
+            } else {
+                set_frequency(value);
+            }
+        }
+
+        float get_amplitude() const {
+            return amplitude;
+        }
+
+        void set_amplitude(const float value) {
+            amplitude               = value;
+            desired_amplitude_steps = 0;
+        }
+
+        void set_amplitude(const float value, const uint32_t interpolation_duration_in_samples) {
+            if (interpolation_duration_in_samples > 0) {
+                desired_amplitude          = value;
+                desired_amplitude_steps    = interpolation_duration_in_samples;
+                desired_amplitude_fraction = (desired_amplitude - amplitude) / interpolation_duration_in_samples;
+            } else {
+                set_amplitude(value);
+            }
+        }
+
+        void reset() {
+            signal = 0.0f;
+            phase  = 0.0f;
+        }
+
+        float current() const {
+            return signal;
+        }
+
+        float process() {
+            if (desired_amplitude_steps > 0) {
+                desired_amplitude_steps--;
+                if (desired_amplitude_steps == 0) {
+                    amplitude = desired_amplitude;
+                } else {
+                    amplitude += desired_amplitude_fraction;
+                }
+            }
+
+            if (desired_frequency_steps > 0) {
+                desired_frequency_steps--;
+                if (desired_frequency_steps == 0) {
+                    set_frequency(desired_frequency);
+                } else {
+                    set_frequency(frequency + desired_frequency_fraction);
+                }
+            }
+
+            if (table_lower == nullptr) {
+                signal = 0.0f;
+                return signal;
+            }
+
+            const float    position = phase * static_cast<float>(table_size);
+            const auto     index    = std::min(static_cast<uint32_t>(position), table_size - 1);
+            const float    frac     = position - static_cast<float>(index);
+            const float    lower    = table_lower[index] + frac * (table_lower[index + 1] - table_lower[index]);
+            float          sample   = lower;
+            if (table_mix > 0.0f) {
+                const float upper = table_upper[index] + frac * (table_upper[index + 1] - table_upper[index]);
+                sample += table_mix * (upper - lower);
+            }
+
+            phase += phase_increment;
+            phase -= std::floor(phase);
+
+            signal = sample * amplitude;
+            return signal;
+        }
+
+        void process(float* signal_buffer, const uint32_t buffer_length) {
+            for (uint32_t i = 0; i < buffer_length; i++) {
+                signal_buffer[i] = process();
+            }
+        }
+
+    private:
+        static constexpr float M_DEFAULT_AMPLITUDE = 0.75f;
+        static constexpr float M_DEFAULT_FREQUENCY = 220.0f;
+
+        const WavetableMipmap* mipmap;
+        const float            sample_rate;
+        const float*           table_lower{nullptr};
+        const float*           table_upper{nullptr};
+        uint32_t               table_size{0};
+        float                  table_mix{0.0f};
+        float                  frequency{0.0f};
+        float                  phase{0.0f};
+        float                  phase_increment{0.0f};
+        float                  amplitude{M_DEFAULT_AMPLITUDE};
+        float                  desired_amplitude{0.0f};
+        float                  desired_amplitude_fraction{0.0f};
+        uint32_t               desired_amplitude_steps{0};
+        float                  desired_frequency{0.0f};
+        float                  desired_frequency_fraction{0.0f};
+        uint16_t               desired_frequency_steps{0};
+        float                  signal{0.0f};
+
+        void update_tables() {
+            phase_increment = std::min(frequency / sample_rate, 0.5f);
+            if (mipmap == nullptr) {
+                table_lower = nullptr;
+                table_upper = nullptr;
+                return;
+            }
+            const float octave = mipmap->get_octave(frequency);
+            const int   lower  = static_cast<int>(octave);
+            table_size         = mipmap->get_table_size();
+            table_lower        = mipmap->get_table(lower);
+            table_upper        = mipmap->get_table(lower + 1);
+            table_mix          = octave - static_cast<float>(lower);
+        }
+    };
+} // namespace umfeld
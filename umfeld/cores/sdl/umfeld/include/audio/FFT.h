@@ -27,6 +27,9 @@
 
 namespace umfeld {
 
+    // NOTE the `fft_*` functions share one global context i.e only one FFT size at a time and not
+    //      thread-safe. see `FFTAnalyzer` for independent instances that do not allocate memory.
+
     // TODO add `fast_sqrt`
 
 inline void aligned_free_wrapper(void* ptr) {
@@ -0,0 +1,284 @@
+/*
+ * Umfeld
+ *
+ * This file is part of the *Umfeld* library (https://github.com/dennisppaul/umfeld).
+ * Copyright (c) 2025 Dennis P Paul.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "pffft.h"
+#include "FFT.h"
+
+namespace umfeld {
+    /**
+     * FFT analyzer that owns its pffft setup, window and aligned buffers i.e several analyzers with
+     * different sizes can be used at the same time and on different threads. `process()` transforms
+     * one block of samples, the results are then written into caller-provided arrays. the mapping of
+     * FFT bins to bands is computed once in `set_bands()`, so `process()` and all getters neither
+     * allocate memory nor scan the spectrum more than once.
+     *
+     * values are normalized to the window i.e a full scale sine wave has an amplitude of 1 ( 0 dB ).
+     *
+     * NOTE the FFT size is rounded up to a power of two of at least 32 samples ( required by pffft ).
+     */
+    class FFTAnalyzer {
+    public:
+        enum Window {
+            WINDOW_HANN = 0,
+            WINDOW_HAMMING,
+            WINDOW_RECTANGULAR
+        };
+
+        enum Bands {
+            BANDS_LINEAR = 0,
+            BANDS_LOG,
+            BANDS_MEL,
+            BANDS_OCTAVE // NOTE `num_bands` is the number of bands per octave e.g 3 for third-octave bands
+        };
+
+        static constexpr float DEFAULT_DB_FLOOR = -120.0f;
+
+        explicit FFTAnalyzer(const int fft_size, const float sample_rate, const Window window_type = WINDOW_HANN)
+            : fft_size(next_power_of_two(fft_size)),
+              sample_rate(sample_rate) {
+            setup  = pffft_new_setup(this->fft_size, PFFFT_REAL);
+            input  = static_cast<float*>(pffft_aligned_malloc(this->fft_size * sizeof(float)));
+            output = static_cast<float*>(pffft_aligned_malloc(this->fft_size * sizeof(float)));
+            work   = static_cast<float*>(pffft_aligned_malloc(this->fft_size * sizeof(float)));
+            power.assign(get_num_bins(), 0.0f);
+            set_window(window_type);
+        }
+
+        ~FFTAnalyzer() {
+            pffft_aligned_free(work);
+            pffft_aligned_free(output);
+            pffft_aligned_free(input);
+            if (setup != nullptr) {
+                pffft_destroy_setup(setup);
+            }
+        }
+
+        FFTAnalyzer(const FFTAnalyzer&)            = delete;
+        FFTAnalyzer& operator=(const FFTAnalyzer&) = delete;
+
+        int   get_fft_size() const { return fft_size; }
+        int   get_num_bins() const { return fft_size / 2 + 1; } // NOTE including DC and nyquist
+        float get_sample_rate() const { return sample_rate; }
+        float get_bin_width() const { return sample_rate / static_cast<float>(fft_size); }
+        float get_bin_frequency(const int bin) const { return static_cast<float>(bin) * get_bin_width(); }
+
+        /**
+         * sets the window that is applied before the transform. allocates memory, call from main thread.
+         */
+        void set_window(const Window window_type) {
+            switch (window_type) {
+                case WINDOW_HAMMING:
+                    window = fft_make_hamming_window(fft_size);
+                    break;
+                case WINDOW_RECTANGULAR:
+                    window.assign(fft_size, 1.0f);
+                    break;
+                case WINDOW_HANN:
+                default:
+                    window = fft_make_hann_window(fft_size);
+                    break;
+            }
+            float sum = 0.0f;
+            for (const float w: window) {
+                sum += w;
+            }
+            // NOTE amplitude of bin `k` is `2 * |X[k]| / sum( window )`
+            const float scale = sum > 0.0f ? 2.0f / sum : 0.0f;
+            power_scale       = scale * scale;
+        }
+
+        /**
+         * sets up `num_bands` bands between `min_freq` and `max_freq`. each band covers a contiguous range
+         * of bins, bands that are narrower than a bin use the nearest bin. allocates memory, call from main
+         * thread.
+         */
+        void set_bands(const int num_bands, const Bands scale, const float min_freq = 20.0f, const float max_freq = 20000.0f) {
+            const float nyquist = sample_rate * 0.5f;
+            const float f_min   = std::max(0.0f, std::min(min_freq, nyquist));
+            const float f_max   = std::max(f_min, std::min(max_freq, nyquist));
+
+            int num = std::max(1, num_bands);
+            if (scale == BANDS_OCTAVE) {
+                const float octaves = std::log2(f_max / std::max(f_min, 1.0f));
+                num                 = std::max(1, static_cast<int>(std::ceil(octaves * static_cast<float>(num) - 1e-4f)));
+            }
+
+            band_edges.resize(num + 1);
+            for (int i = 0; i <= num; ++i) {
+                const float t = static_cast<float>(i) / static_cast<float>(num);
+                switch (scale) {
+                    case BANDS_LOG: {
+                        const float lo = std::max(f_min, 1.0f);
+                        band_edges[i]  = lo * std::pow(f_max / lo, t);
+                        break;
+                    }
+                    case BANDS_OCTAVE: {
+                        const float lo               = std::max(f_min, 1.0f);
+                        const float bands_per_octave = static_cast<float>(std::max(1, num_bands));
+                        band_edges[i]                = std::min(f_max, lo * std::pow(2.0f, static_cast<float>(i) / bands_per_octave));
+                        break;
+                    }
+                    case BANDS_MEL: {
+                        const float mel_min = hz_to_mel(f_min);
+                        const float mel_max = hz_to_mel(f_max);
+                        band_edges[i]       = mel_to_hz(mel_min + (mel_max - mel_min) * t);
+                        break;
+                    }
+                    case BANDS_LINEAR:
+                    default:
+                        band_edges[i] = f_min + (f_max - f_min) * t;
+                        break;
+                }
+            }
+
+            band_first_bin.resize(num);
+            band_last_bin.resize(num);
+            band_center.resize(num);
+            const float bin_width = get_bin_width();
+            const int   last_bin  = get_num_bins() - 1;
+            for (int b = 0; b < num; ++b) {
+                const float lo    = band_edges[b];
+                const float hi    = band_edges[b + 1];
+                int         first = static_cast<int>(std::ceil(lo / bin_width));
+                int         last  = static_cast<int>(std::ceil(hi / bin_width)) - 1; // NOTE bins in [ lo, hi )
+                if (last < first) {
+                    first = last = static_cast<int>(std::lround(0.5f * (lo + hi) / bin_width));
+                }
+                band_first_bin[b] = std::clamp(first, 0, last_bin);
+                band_last_bin[b]  = std::clamp(last, 0, last_bin);
+                band_center[b]    = scale == BANDS_LINEAR || scale == BANDS_MEL ? 0.5f * (lo + hi) : std::sqrt(std::max(lo, 1.0f) * hi);
+            }
+        }
+
+        int   get_num_bands() const { return static_cast<int>(band_center.size()); }
+        float get_band_frequency(const int band) const { return band_center[band]; } // NOTE center frequency
+        float get_band_min_frequency(const int band) const { return band_edges[band]; }
+        float get_band_max_frequency(const int band) const { return band_edges[band + 1]; }
+
+        /**
+         * windows and transforms `fft_size` samples from `samples`. does not allocate memory.
+         */
+        void process(const float* samples) {
+            if (setup == nullptr || samples == nullptr) {
+                return;
+            }
+            for (int i = 0; i < fft_size; ++i) {
+                input[i] = samples[i] * window[i];
+            }
+            pffft_transform_ordered(setup, input, output, work, PFFFT_FORWARD);
+            // NOTE ordered layout of pffft: DC, nyquist, then real and imaginary part of bins 1 … N/2-1
+            const int nyquist_bin = fft_size / 2;
+            power[0]              = 0.25f * output[0] * output[0] * power_scale; // NOTE DC and nyquist are not mirrored
+            power[nyquist_bin]    = 0.25f * output[1] * output[1] * power_scale;
+            for (int k = 1; k < nyquist_bin; ++k) {
+                power[k] = fft_power(output[2 * k], output[2 * k + 1]) * power_scale;
+            }
+        }
+
+        /** raw spectrum of the last `process()` call in the ordered layout of pffft ( `fft_size` values ) */
+        const float* get_spectrum() const { return output; }
+
+        /* --- per bin ( `output` must hold `get_num_bins()` values, fewer are written if `size` is smaller ) --- */
+
+        void get_power(float* output_values, const int size) const {
+            const int n = std::min(size, get_num_bins());
+            std::copy_n(power.data(), n, output_values);
+        }
+
+        void get_amplitude(float* output_values, const int size) const {
+            const int n = std::min(size, get_num_bins());
+            for (int k = 0; k < n; ++k) {
+                output_values[k] = std::sqrt(power[k]);
+            }
+        }
+
+        void get_db(float* output_values, const int size, const float floor = DEFAULT_DB_FLOOR) const {
+            const int n = std::min(size, get_num_bins());
+            for (int k = 0; k < n; ++k) {
+                output_values[k] = to_db(power[k], floor);
+            }
+        }
+
+        /* --- per band ( `output` must hold `get_num_bands()` values ) --- */
+
+        /** mean power of the bins in each band */
+        void get_band_power(float* output_values, const int size) const {
+            const int n = std::min(size, get_num_bands());
+            for (int b = 0; b < n; ++b) {
+                float sum = 0.0f;
+                for (int k = band_first_bin[b]; k <= band_last_bin[b]; ++k) {
+                    sum += power[k];
+                }
+                output_values[b] = sum / static_cast<float>(band_last_bin[b] - band_first_bin[b] + 1);
+            }
+        }
+
+        void get_band_amplitude(float* output_values, const int size) const {
+            get_band_power(output_values, size);
+            const int n = std::min(size, get_num_bands());
+            for (int b = 0; b < n; ++b) {
+                output_values[b] = std::sqrt(output_values[b]);
+            }
+        }
+
+        void get_band_db(float* output_values, const int size, const float floor = DEFAULT_DB_FLOOR) const {
+            get_band_power(output_values, size);
+            const int n = std::min(size, get_num_bands());
+            for (int b = 0; b < n; ++b) {
+                output_values[b] = to_db(output_values[b], floor);
+            }
+        }
+
+        static float hz_to_mel(const float frequency) { return 2595.0f * std::log10(1.0f + frequency / 700.0f); }
+        static float mel_to_hz(const float mel) { return 700.0f * (std::pow(10.0f, mel / 2595.0f) - 1.0f); }
+
+    private:
+        const int          fft_size;
+        const float        sample_rate;
+        PFFFT_Setup*       setup{nullptr};
+        float*             input{nullptr};
+        float*             output{nullptr};
+        float*             work{nullptr};
+        std::vector<float> window;
+        float              power_scale{1.0f};
+        std::vector<float> power;
+        std::vector<float> band_edges;
+        std::vector<int>   band_first_bin;
+        std::vector<int>   band_last_bin;
+        std::vector<float> band_center;
+
+        static int next_power_of_two(const int size) {
+            int n = 32;
+            while (n < size) {
+                n <<= 1;
+            }
+            return n;
+        }
+
+        static float to_db(const float power_value, const float floor) {
+            return power_value > 0.0f ? std::max(floor, 10.0f * std::log10(power_value)) : floor;
+        }
+    };
+} // namespace umfeld
@@ -0,0 +1,258 @@
+/*
+ * Umfeld
+ *
+ * This file is part of the *Umfeld* library (https://github.com/dennisppaul/umfeld).
+ * Copyright (c) 2025 Dennis P Paul.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * PROCESSOR INTERFACE
+ *
+ * - [ ] float process()
+ * - [ ] float process(float)
+ * - [ ] void process(AudioSignal&)
+ * - [x] void process(float*, uint32_t)
+ * - [x] void process(float*, float*, uint32_t)
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+#include "pffft.h"
+#include "FFT.h"
+#include "FFTAnalyzer.h"
+#include "TripleBuffer.h"
+
+namespace umfeld {
+    /**
+     * streaming short-time fourier transform that runs in the audio thread. input samples are collected
+     * in a ring and every `hop_size` samples the latest `fft_size` samples are windowed and transformed.
+     *
+     * - the magnitudes of each frame are published through a lock-free triple buffer and can be read
+     *   from the main thread with `update()` and `get_magnitudes()` ( independent of the frame rate ).
+     * - an optional spectral processor may modify each spectrum in place. it is then transformed back
+     *   and overlap-added to the output, e.g for spectral effects like denoise, freeze or vocoder.
+     *
+     * the output is delayed by `get_latency()` samples ( `fft_size` ). overlap-add is
+     * normalized by the summed squared windows, so an unmodified spectrum reconstructs the input.
+     *
+     * NOTE the FFT size is rounded up to a power of two of at least 32 samples ( required by pffft ).
+     *      the spectrum passed to the spectral processor is in the ordered layout of pffft i.e DC,
+     *      nyquist and then real and imaginary part of bins 1 … N/2-1.
+     */
+    class STFT {
+    public:
+        /** called in the audio thread for every frame with `fft_size` values, must not block or allocate */
+        using SpectralProcessor = std::function<void(float* spectrum, int fft_size)>;
+
+        static constexpr int DEFAULT_FFT_SIZE = 2048;
+        static constexpr int DEFAULT_OVERLAP  = 4;
+
+        explicit STFT(const float               sample_rate,
+                      const int                 fft_size    = DEFAULT_FFT_SIZE,
+                      const int                 hop_size    = DEFAULT_FFT_SIZE / DEFAULT_OVERLAP,
+                      const FFTAnalyzer::Window window_type = FFTAnalyzer::WINDOW_HANN)
+            : sample_rate(sample_rate),
+              fft_size(next_power_of_two(fft_size)),
+              hop_size(std::clamp(hop_size, 1, this->fft_size)),
+              overlap(this->fft_size - this->hop_size),
+              input_ring(this->fft_size, 0.0f),
+              output_ring(this->hop_size, 0.0f),
+              accumulator(this->fft_size, 0.0f),
+              overlap_gain(this->hop_size, 0.0f),
+              spectra(std::vector<float>(this->fft_size / 2 + 1, 0.0f)) {
+            setup    = pffft_new_setup(this->fft_size, PFFFT_REAL);
+            frame    = static_cast<float*>(pffft_aligned_malloc(this->fft_size * sizeof(float)));
+            spectrum = static_cast<float*>(pffft_aligned_malloc(this->fft_size * sizeof(float)));
+            work     = static_cast<float*>(pffft_aligned_malloc(this->fft_size * sizeof(float)));
+            switch (window_type) {
+                case FFTAnalyzer::WINDOW_HAMMING:
+                    window = fft_make_hamming_window(this->fft_size);
+                    break;
+                case FFTAnalyzer::WINDOW_RECTANGULAR:
+                    window.assign(this->fft_size, 1.0f);
+                    break;
+                case FFTAnalyzer::WINDOW_HANN:
+                default:
+                    window = fft_make_hann_window(this->fft_size);
+                    break;
+            }
+            float window_sum = 0.0f;
+            for (const float w: window) {
+                window_sum += w;
+            }
+            magnitude_scale = window_sum > 0.0f ? 2.0f / window_sum : 0.0f;
+            // NOTE each output sample is the sum of all overlapping frames, each weighted by analysis and synthesis window
+            for (int i = 0; i < this->hop_size; ++i) {
+                float sum = 0.0f;
+                for (int j = i; j < this->fft_size; j += this->hop_size) {
+                    sum += window[j] * window[j];
+                }
+                overlap_gain[i] = sum > 1e-6f ? 1.0f / (sum * static_cast<float>(this->fft_size)) : 0.0f;
+            }
+            position = overlap;
+        }
+
+        ~STFT() {
+            pffft_aligned_free(work);
+            pffft_aligned_free(spectrum);
+            pffft_aligned_free(frame);
+            if (setup != nullptr) {
+                pffft_destroy_setup(setup);
+            }
+        }
+
+        STFT(const STFT&)            = delete;
+        STFT& operator=(const STFT&) = delete;
+
+        int   get_fft_size() const { return fft_size; }
+        int   get_hop_size() const { return hop_size; }
+        int   get_latency() const { return fft_size; }
+        int   get_num_bins() const { return fft_size / 2 + 1; }
+        float get_bin_frequency(const int bin) const { return static_cast<float>(bin) * sample_rate / static_cast<float>(fft_size); }
+
+        /** sets the spectral processor. call before audio processing starts, `nullptr` disables it */
+        void set_spectral_processor(const SpectralProcessor& processor) { spectral_processor = processor; }
+
+        /* --- audio thread --- */
+
+        /** analyzes `input` only e.g for visualization */
+        void process(const float* input, const uint32_t length) {
+            process(input, nullptr, length);
+        }
+
+        /** analyzes `input` and writes the resynthesized ( and possibly processed ) signal to `output` */
+        void process(const float* input, float* output, const uint32_t length) {
+            for (uint32_t i = 0; i < length; ++i) {
+                input_ring[position] = input[i];
+                if (output != nullptr) {
+                    output[i] = output_ring[position - overlap];
+                }
+                position++;
+                if (position >= fft_size) {
+                    position = overlap;
+                    process_frame(output != nullptr);
+                }
+            }
+        }
+
+        /* --- main thread --- */
+
+        /** returns `true` if a new frame was published since the last call */
+        bool update() { return spectra.update(); }
+
+        /**
+         * magnitudes of the latest frame that was read with `update()` ( `get_num_bins()` values ). values
+         * are normalized to the window i.e a full scale sine wave has a magnitude of 1.
+         */
+        const float* get_magnitudes() const { return spectra.read_buffer().data(); }
+
+        /* --- spectrum helpers ( for spectral processors ) --- */
+
+        static float get_magnitude(const float* spectrum, const int bin, const int fft_size) {
+            if (bin == 0) {
+                return std::abs(spectrum[0]);
+            }
+            if (bin == fft_size / 2) {
+                return std::abs(spectrum[1]);
+            }
+            return std::sqrt(fft_power(spectrum[2 * bin], spectrum[2 * bin + 1]));
+        }
+
+        /** scales the magnitude of `bin` by `gain`, the phase is kept */
+        static void scale_bin(float* spectrum, const int bin, const int fft_size, const float gain) {
+            if (bin == 0) {
+                spectrum[0] *= gain;
+            } else if (bin == fft_size / 2) {
+                spectrum[1] *= gain;
+            } else {
+                spectrum[2 * bin] *= gain;
+                spectrum[2 * bin + 1] *= gain;
+            }
+        }
+
+    private:
+        const float                      sample_rate;
+        const int                        fft_size;
+        const int                        hop_size;
+        const int                        overlap; // NOTE samples shared by consecutive frames
+        PFFFT_Setup*                     setup{nullptr};
+        float*                           frame{nullptr};
+        float*                           spectrum{nullptr};
+        float*                           work{nullptr};
+        std::vector<float>               window;
+        std::vector<float>               input_ring;
+        std::vector<float>               output_ring;
+        std::vector<float>               accumulator;
+        std::vector<float>               overlap_gain;
+        float                            magnitude_scale{1.0f};
+        int                              position{0};
+        SpectralProcessor                spectral_processor;
+        TripleBuffer<std::vector<float>> spectra;
+
+        static int next_power_of_two(const int size) {
+            int n = 32;
+            while (n < size) {
+                n <<= 1;
+            }
+            return n;
+        }
+
+        void process_frame(const bool resynthesize) {
+            if (setup == nullptr) {
+                return;
+            }
+            for (int i = 0; i < fft_size; ++i) {
+                frame[i] = input_ring[i] * window[i];
+            }
+            pffft_transform_ordered(setup, frame, spectrum, work, PFFFT_FORWARD);
+
+            /* publish magnitudes */
+
+            std::vector<float>& magnitudes = spectra.write_buffer();
+            const int           nyquist    = fft_size / 2;
+            magnitudes[0]                  = 0.5f * std::abs(spectrum[0]) * magnitude_scale; // NOTE DC and nyquist are not mirrored
+            magnitudes[nyquist]            = 0.5f * std::abs(spectrum[1]) * magnitude_scale;
+            for (int k = 1; k < nyquist; ++k) {
+                magnitudes[k] = std::sqrt(fft_power(spectrum[2 * k], spectrum[2 * k + 1])) * magnitude_scale;
+            }
+            spectra.publish();
+
+            /* resynthesize with overlap-add */
+
+            if (resynthesize) {
+                if (spectral_processor) {
+                    spectral_processor(spectrum, fft_size);
+                }
+                pffft_transform_ordered(setup, spectrum, frame, work, PFFFT_BACKWARD);
+                for (int i = 0; i < fft_size; ++i) {
+                    accumulator[i] += frame[i] * window[i];
+                }
+                for (int i = 0; i < hop_size; ++i) {
+                    output_ring[i] = accumulator[i] * overlap_gain[i];
+                }
+                std::memmove(accumulator.data(), accumulator.data() + hop_size, overlap * sizeof(float));
+                std::fill_n(accumulator.data() + overlap, hop_size, 0.0f);
+            }
+
+            std::memmove(input_ring.data(), input_ring.data() + hop_size, overlap * sizeof(float));
+        }
+    };
+} // namespace umfeld
@@ -0,0 +1,464 @@
+/*
+ * Umfeld
+ *
+ * This file is part of the *Umfeld* library (https://github.com/dennisppaul/umfeld).
+ * Copyright (c) 2025 Dennis P Paul.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "SPSCQueue.h"
+#include "ADSR.h"
+#include "AudioUtilities.h"
+#include "Sampler.h"
+#include "Wavetable.h"
+
+namespace umfeld {
+    enum VoiceStealing {
+        VOICE_STEALING_NONE,     // NOTE notes are dropped if all voices are busy
+        VOICE_STEALING_OLDEST,   // NOTE voice that was started first
+        VOICE_STEALING_QUIETEST, // NOTE voice with the lowest envelope level
+        VOICE_STEALING_LOWEST,   // NOTE voice playing the lowest note
+        VOICE_STEALING_HIGHEST,  // NOTE voice playing the highest note
+    };
+
+    enum VoiceParameter : uint16_t {
+        VOICE_PARAMETER_ATTACK,
+        VOICE_PARAMETER_DECAY,
+        VOICE_PARAMETER_SUSTAIN,
+        VOICE_PARAMETER_RELEASE,
+        VOICE_PARAMETER_AMPLITUDE,  // NOTE applies to notes started afterwards
+        VOICE_PARAMETER_PITCH_BEND, // NOTE in semitones
+        VOICE_PARAMETER_USER,       // NOTE first id for parameters of custom voices
+    };
+
+    /**
+     * `Wavetable` oscillator with an `ADSR` envelope. all voices of a `VoiceManager` share one table.
+     */
+    class WavetableVoice {
+    public:
+        WavetableVoice(float* wavetable, const uint32_t wavetable_size, const float sample_rate) : oscillator(wavetable, wavetable_size, sample_rate),
+                                                                                                   envelope(sample_rate) {}
+
+        void note_on(const uint8_t note, const uint8_t velocity) {
+            base_frequency = AudioUtilities::midi_note_to_frequency(note);
+            oscillator.set_frequency(base_frequency * pitch_bend);
+            oscillator.set_amplitude(amplitude * AudioUtilities::clamp127(velocity) / 127.0f);
+            envelope.start();
+        }
+
+        void note_off() { envelope.stop(); }
+
+        bool  is_active() const { return !envelope.is_idle(); }
+        float get_level() const { return envelope.get_amplitude(); }
+
+        void set_parameter(const uint16_t parameter, const float value) {
+            switch (parameter) {
+                case VOICE_PARAMETER_ATTACK:
+                    envelope.set_attack(value);
+                    break;
+                case VOICE_PARAMETER_DECAY:
+                    envelope.set_decay(value);
+                    break;
+                case VOICE_PARAMETER_SUSTAIN:
+                    envelope.set_sustain(value);
+                    break;
+                case VOICE_PARAMETER_RELEASE:
+                    envelope.set_release(value);
+                    break;
+                case VOICE_PARAMETER_AMPLITUDE:
+                    amplitude = value;
+                    break;
+                case VOICE_PARAMETER_PITCH_BEND:
+                    pitch_bend = std::pow(2.0f, value / 12.0f);
+                    oscillator.set_frequency(base_frequency * pitch_bend);
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        void add(float* signal_buffer, const uint32_t buffer_length) {
+            for (uint32_t i = 0; i < buffer_length; i++) {
+                signal_buffer[i] += envelope.process(oscillator.process());
+            }
+        }
+
+        Wavetable oscillator;
+        ADSR      envelope;
+
+    private:
+        float base_frequency{0.0f};
+        float pitch_bend{1.0f};
+        float amplitude{1.0f};
+    };
+
+    /**
+     * `Sampler` with an `ADSR` envelope. all voices of a `VoiceManager` share one sample buffer.
+     *
+     * NOTE the sampler must be tuned with `tune_frequency_to()` to play notes at the correct pitch.
+     */
+    class SamplerVoice {
+    public:
+        SamplerVoice(float* buffer, const int32_t buffer_length, const float sample_rate) : sampler(buffer, buffer_length, sample_rate),
+                                                                                            envelope(sample_rate) {}
+
+        void note_on(const uint8_t note, const uint8_t velocity) {
+            base_frequency = AudioUtilities::midi_note_to_frequency(note);
+            sampler.note_on(note, velocity);
+            sampler.set_frequency(base_frequency * pitch_bend);
+            sampler.set_amplitude(amplitude * AudioUtilities::clamp127(velocity) / 127.0f);
+            envelope.start();
+        }
+
+        void note_off() {
+            sampler.note_off();
+            envelope.stop();
+        }
+
+        bool  is_active() const { return !envelope.is_idle(); }
+        float get_level() const { return envelope.get_amplitude(); }
+
+        void set_parameter(const uint16_t parameter, const float value) {
+            switch (parameter) {
+                case VOICE_PARAMETER_ATTACK:
+                    envelope.set_attack(value);
+                    break;
+                case VOICE_PARAMETER_DECAY:
+                    envelope.set_decay(value);
+                    break;
+                case VOICE_PARAMETER_SUSTAIN:
+                    envelope.set_sustain(value);
+                    break;
+                case VOICE_PARAMETER_RELEASE:
+                    envelope.set_release(value);
+                    break;
+                case VOICE_PARAMETER_AMPLITUDE:
+                    amplitude = value;
+                    break;
+                case VOICE_PARAMETER_PITCH_BEND:
+                    pitch_bend = std::pow(2.0f, value / 12.0f);
+                    sampler.set_frequency(base_frequency * pitch_bend);
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        void add(float* signal_buffer, const uint32_t buffer_length) {
+            for (uint32_t i = 0; i < buffer_length; i++) {
+                signal_buffer[i] += envelope.process(sampler.process());
+            }
+        }
+
+        Sampler sampler;
+        ADSR    envelope;
+
+    private:
+        float base_frequency{0.0f};
+        float pitch_bend{1.0f};
+        float amplitude{1.0f};
+    };
+
+    /**
+     * polyphonic voice allocator. note and parameter events are sent from any single thread ( e.g the
+     * main or the MIDI thread ) through a wait-free queue and applied by `process()` in the audio thread
+     * at their sample offset inside the block. voices are preallocated and stored contiguously.
+     *
+     * a voice type must provide:
+     *
+     *     void  note_on(uint8_t note, uint8_t velocity);
+     *     void  note_off();
+     *     bool  is_active() const;
+     *     float get_level() const;
+     *     void  set_parameter(uint16_t parameter, float value);
+     *     void  add(float* signal_buffer, uint32_t buffer_length); // NOTE mixes into the buffer
+     *
+     * e.g:
+     *
+     *     VoiceManager<WavetableVoice> voices(16, wavetable, 1024, 48000);
+     *     voices.note_on(60, 100);                          // in `MIDIListener::note_on`
+     *     voices.process(output_buffer, buffer_length);    // in the audio thread
+     */
+    template<class VOICE>
+    class VoiceManager {
+    public:
+        static constexpr size_t DEFAULT_EVENT_CAPACITY = 256;
+
+        struct Stats {
+            uint32_t active_voices{0};
+            uint64_t stolen_voices{0};
+            uint64_t dropped_notes{0};  // NOTE all voices busy with `VOICE_STEALING_NONE`
+            uint64_t dropped_events{0}; // NOTE event queue was full
+        };
+
+        template<typename... Args>
+        explicit VoiceManager(const uint32_t number_of_voices, Args&&... args) : events(DEFAULT_EVENT_CAPACITY) {
+            voices.reserve(number_of_voices);
+            for (uint32_t i = 0; i < number_of_voices; ++i) {
+                voices.emplace_back(args...);
+            }
+            voice_notes.assign(number_of_voices, NO_NOTE);
+            voice_start.assign(number_of_voices, 0);
+            block_events.resize(events.capacity());
+        }
+
+        VoiceManager(const VoiceManager&)            = delete;
+        VoiceManager& operator=(const VoiceManager&) = delete;
+
+        /* --- producer e.g main or MIDI thread --- */
+
+        /**
+         * @param note     MIDI note
+         * @param velocity MIDI velocity, 0 is treated as note off
+         * @param offset   sample offset inside the next processed block
+         */
+        bool note_on(const uint8_t note, const uint8_t velocity, const uint32_t offset = 0) {
+            return push({velocity > 0 ? EVENT_NOTE_ON : EVENT_NOTE_OFF, note, velocity, 0, 0.0f, offset});
+        }
+
+        bool note_off(const uint8_t note, const uint32_t offset = 0) {
+            return push({EVENT_NOTE_OFF, note, 0, 0, 0.0f, offset});
+        }
+
+        bool all_notes_off(const uint32_t offset = 0) {
+            return push({EVENT_ALL_NOTES_OFF, 0, 0, 0, 0.0f, offset});
+        }
+
+        /**
+         * sets a parameter of all voices ( see `VoiceParameter` ).
+         */
+        bool set_parameter(const uint16_t parameter, const float value, const uint32_t offset = 0) {
+            return push({EVENT_PARAMETER, 0, 0, parameter, value, offset});
+        }
+
+        /* --- either thread --- */
+
+        void          set_voice_stealing(const VoiceStealing policy) { voice_stealing.store(policy, std::memory_order_relaxed); }
+        VoiceStealing get_voice_stealing() const { return voice_stealing.load(std::memory_order_relaxed); }
+
+        Stats get_stats() const {
+            Stats stats;
+            stats.active_voices  = active_voice_count.load(std::memory_order_relaxed);
+            stats.stolen_voices  = stolen_voices.load(std::memory_order_relaxed);
+            stats.dropped_notes  = dropped_notes.load(std::memory_order_relaxed);
+            stats.dropped_events = dropped_events.load(std::memory_order_relaxed);
+            return stats;
+        }
+
+        /* --- audio thread --- */
+
+        /**
+         * renders all voices into `signal_buffer`. queued events are applied at their offset, events with
+         * an offset beyond the block are applied at its last sample.
+         */
+        void process(float* signal_buffer, const uint32_t buffer_length) {
+            std::fill_n(signal_buffer, buffer_length, 0.0f);
+            add(signal_buffer, buffer_length);
+        }
+
+        void add(float* signal_buffer, const uint32_t buffer_length) {
+            if (buffer_length == 0) {
+                return;
+            }
+            size_t event_count = 0;
+            while (event_count < block_events.size() && events.try_pop(block_events[event_count])) {
+                block_events[event_count].offset = std::min(block_events[event_count].offset, buffer_length - 1);
+                event_count++;
+            }
+            // NOTE events arrive mostly in order, insertion sort is stable and does not allocate
+            for (size_t i = 1; i < event_count; ++i) {
+                const Event event = block_events[i];
+                size_t      j     = i;
+                while (j > 0 && block_events[j - 1].offset > event.offset) {
+                    block_events[j] = block_events[j - 1];
+                    j--;
+                }
+                block_events[j] = event;
+            }
+
+            uint32_t position = 0;
+            size_t   e        = 0;
+            while (position < buffer_length) {
+                while (e < event_count && block_events[e].offset <= position) {
+                    apply(block_events[e++]);
+                }
+                const uint32_t end = e < event_count ? block_events[e].offset : buffer_length;
+                render(signal_buffer + position, end - position);
+                position = end;
+            }
+
+            uint32_t active = 0;
+            for (const auto& voice: voices) {
+                active += voice.is_active() ? 1 : 0;
+            }
+            active_voice_count.store(active, std::memory_order_relaxed);
+        }
+
+        /**
+         * NOTE voices should only be modified from the audio thread e.g to fill a shared table before
+         *      audio is started.
+         */
+        std::vector<VOICE>& get_voices() { return voices; }
+
+    private:
+        static constexpr int16_t NO_NOTE = -1;
+
+        enum EventType : uint8_t {
+            EVENT_NOTE_ON,
+            EVENT_NOTE_OFF,
+            EVENT_ALL_NOTES_OFF,
+            EVENT_PARAMETER,
+        };
+
+        struct Event {
+            EventType type{EVENT_NOTE_OFF};
+            uint8_t   note{0};
+            uint8_t   velocity{0};
+            uint16_t  parameter{0};
+            float     value{0.0f};
+            uint32_t  offset{0};
+        };
+
+        std::vector<VOICE>         voices;
+        std::vector<int16_t>       voice_notes;
+        std::vector<uint64_t>      voice_start;
+        uint64_t                   note_counter{0};
+        SPSCQueue<Event>           events;
+        std::vector<Event>         block_events;
+        std::atomic<VoiceStealing> voice_stealing{VOICE_STEALING_OLDEST};
+        std::atomic<uint32_t>      active_voice_count{0};
+        std::atomic<uint64_t>      stolen_voices{0};
+        std::atomic<uint64_t>      dropped_notes{0};
+        std::atomic<uint64_t>      dropped_events{0};
+
+        bool push(const Event& event) {
+            if (!events.try_push(event)) {
+                dropped_events.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            return true;
+        }
+
+        void render(float* signal_buffer, const uint32_t length) {
+            if (length == 0) {
+                return;
+            }
+            for (auto& voice: voices) {
+                if (voice.is_active()) {
+                    voice.add(signal_buffer, length);
+                }
+            }
+        }
+
+        void apply(const Event& event) {
+            switch (event.type) {
+                case EVENT_NOTE_ON: {
+                    const int v = allocate_voice(event.note);
+                    if (v < 0) {
+                        dropped_notes.fetch_add(1, std::memory_order_relaxed);
+                        return;
+                    }
+                    voice_notes[v] = event.note;
+                    voice_start[v] = ++note_counter;
+                    voices[v].note_on(event.note, event.velocity);
+                    break;
+                }
+                case EVENT_NOTE_OFF:
+                    for (size_t v = 0; v < voices.size(); ++v) {
+                        if (voice_notes[v] == event.note) {
+                            voices[v].note_off();
+                            voice_notes[v] = NO_NOTE;
+                        }
+                    }
+                    break;
+                case EVENT_ALL_NOTES_OFF:
+                    for (size_t v = 0; v < voices.size(); ++v) {
+                        if (voice_notes[v] != NO_NOTE) {
+                            voices[v].note_off();
+                            voice_notes[v] = NO_NOTE;
+                        }
+                    }
+                    break;
+                case EVENT_PARAMETER:
+                    for (auto& voice: voices) {
+                        voice.set_parameter(event.parameter, event.value);
+                    }
+                    break;
+            }
+        }
+
+        /**
+         * returns the voice already playing `note`, a free voice or a voice to steal. prefers free
+         * voices that are released over voices that are still held.
+         */
+        int allocate_voice(const uint8_t note) {
+            int free_voice = -1;
+            for (size_t v = 0; v < voices.size(); ++v) {
+                if (voice_notes[v] == note) {
+                    return static_cast<int>(v);
+                }
+                if (free_voice < 0 && !voices[v].is_active()) {
+                    free_voice = static_cast<int>(v);
+                }
+            }
+            if (free_voice >= 0) {
+                return free_voice;
+            }
+
+            const VoiceStealing policy = voice_stealing.load(std::memory_order_relaxed);
+            if (policy == VOICE_STEALING_NONE || voices.empty()) {
+                return -1;
+            }
+            int    steal         = -1;
+            bool   best_released = false;
+            double best_score    = 0.0;
+            for (size_t v = 0; v < voices.size(); ++v) {
+                // NOTE released voices are stolen first, they are already fading out
+                const bool released = voice_notes[v] == NO_NOTE;
+                double     score    = 0.0;
+                switch (policy) {
+                    case VOICE_STEALING_QUIETEST:
+                        score = voices[v].get_level();
+                        break;
+                    case VOICE_STEALING_LOWEST:
+                        score = voice_notes[v];
+                        break;
+                    case VOICE_STEALING_HIGHEST:
+                        score = -voice_notes[v];
+                        break;
+                    default:
+                        score = static_cast<double>(voice_start[v]);
+                        break;
+                }
+                if (steal < 0 || (released && !best_released) || (released == best_released && score < best_score)) {
+                    steal         = static_cast<int>(v);
+                    best_released = released;
+                    best_score    = score;
+                }
+            }
+            stolen_voices.fetch_add(1, std::memory_order_relaxed);
+            return steal;
+        }
+    };
+} // namespace umfeld
@@ -0,0 +1,404 @@
+/*
+ * Umfeld
+ *
+ * This file is part of the *Umfeld* library (https://github.com/dennisppaul/umfeld).
+ * Copyright (c) 2025 Dennis P Paul.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "AudioUtilities.h"
+#include "Wavetable.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define UMFELD_WAVETABLE_BANK_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define UMFELD_WAVETABLE_BANK_NEON
+#include <arm_neon.h>
+#endif
+
+namespace umfeld {
+    /**
+     * bank of wavetable oscillators that share one table, e.g for additive synthesis or drones with
+     * hundreds of partials. the state of all voices is stored as structure-of-arrays and
+     * `WavetableBank::LANES` voices are rendered at once with SSE2 or NEON ( or plain loops as
+     * fallback ). amplitude and frequency ramps are applied branch-free and only in blocks where a ramp
+     * is active.
+     *
+     * NOTE the phase of a voice is normalized to [0, 1), frequencies are limited to the nyquist
+     *      frequency and the output of all voices is summed into a mono signal.
+     */
+    class WavetableBank {
+    public:
+        static constexpr uint32_t LANES                  = 4;
+        static constexpr uint32_t DEFAULT_MAX_BLOCK_SIZE = 512;
+
+        WavetableBank(const uint32_t number_of_voices,
+                      const uint32_t wavetable_size,
+                      const float    sample_rate,
+                      const uint32_t max_block_size = DEFAULT_MAX_BLOCK_SIZE)
+            : voice_count(number_of_voices),
+              padded_voice_count((number_of_voices + LANES - 1) / LANES * LANES),
+              wavetable_size(std::max(wavetable_size, 1u)),
+              sample_rate(sample_rate),
+              max_block_size(std::max(max_block_size, 1u)) {
+            // NOTE one guard sample before and three after the table avoid wrapping indices when interpolating
+            table.assign(this->wavetable_size + GUARD_SAMPLES, 0.0f);
+            phase.assign(padded_voice_count, 0.0f);
+            increment.assign(padded_voice_count, 0.0f);
+            amplitude.assign(padded_voice_count, 0.0f);
+            amplitude_target.assign(padded_voice_count, 0.0f);
+            amplitude_delta.assign(padded_voice_count, 0.0f);
+            amplitude_steps.assign(padded_voice_count, 0.0f);
+            increment_target.assign(padded_voice_count, 0.0f);
+            increment_delta.assign(padded_voice_count, 0.0f);
+            increment_steps.assign(padded_voice_count, 0.0f);
+            mix.assign(static_cast<size_t>(this->max_block_size) * LANES, 0.0f);
+            set_waveform(WAVEFORM_SINE);
+        }
+
+        /* --- wavetable --- */
+
+        /**
+         * table shared by all voices. call `update_wavetable()` after writing to it.
+         */
+        float*   get_wavetable() { return table.data() + 1; }
+        uint32_t get_wavetable_size() const { return wavetable_size; }
+
+        void set_waveform(const uint8_t waveform) {
+            Wavetable::fill(get_wavetable(), wavetable_size, waveform);
+            update_wavetable();
+        }
+
+        void set_waveform(const uint8_t waveform, const int harmonics) {
+            Wavetable::fill(get_wavetable(), wavetable_size, waveform, harmonics);
+            update_wavetable();
+        }
+
+        void update_wavetable() {
+            const float* wavetable = get_wavetable();
+            table[0]               = wavetable[wavetable_size - 1];
+            for (uint32_t i = 0; i < GUARD_SAMPLES - 1; ++i) {
+                table[wavetable_size + 1 + i] = wavetable[i % wavetable_size];
+            }
+        }
+
+        void set_interpolation(const uint8_t interpolation_type) { interpolation = interpolation_type; }
+
+        /* --- voices --- */
+
+        uint32_t get_voice_count() const { return voice_count; }
+
+        float get_frequency(const uint32_t voice) const {
+            return voice < voice_count ? increment[voice] * sample_rate : 0.0f;
+        }
+
+        void set_frequency(const uint32_t voice, const float frequency) {
+            if (voice >= voice_count) {
+                return;
+            }
+            increment[voice]       = to_increment(frequency);
+            increment_steps[voice] = 0.0f;
+        }
+
+        /**
+         * glides linearly from the current to the new frequency in `interpolation_duration_in_samples`.
+         */
+        void set_frequency(const uint32_t voice, const float frequency, const uint32_t interpolation_duration_in_samples) {
+            if (voice >= voice_count) {
+                return;
+            }
+            if (interpolation_duration_in_samples == 0) {
+                set_frequency(voice, frequency);
+                return;
+            }
+            increment_target[voice] = to_increment(frequency);
+            increment_steps[voice]  = static_cast<float>(interpolation_duration_in_samples);
+            increment_delta[voice]  = (increment_target[voice] - increment[voice]) / static_cast<float>(interpolation_duration_in_samples);
+        }
+
+        float get_amplitude(const uint32_t voice) const {
+            return voice < voice_count ? amplitude[voice] : 0.0f;
+        }
+
+        void set_amplitude(const uint32_t voice, const float value) {
+            if (voice >= voice_count) {
+                return;
+            }
+            amplitude[voice]       = value;
+            amplitude_steps[voice] = 0.0f;
+        }
+
+        void set_amplitude(const uint32_t voice, const float value, const uint32_t interpolation_duration_in_samples) {
+            if (voice >= voice_count) {
+                return;
+            }
+            if (interpolation_duration_in_samples == 0) {
+                set_amplitude(voice, value);
+                return;
+            }
+            amplitude_target[voice] = value;
+            amplitude_steps[voice]  = static_cast<float>(interpolation_duration_in_samples);
+            amplitude_delta[voice]  = (value - amplitude[voice]) / static_cast<float>(interpolation_duration_in_samples);
+        }
+
+        /**
+         * @param voice       index of voice
+         * @param phase_value normalized phase in [0, 1)
+         */
+        void set_phase(const uint32_t voice, const float phase_value) {
+            if (voice >= voice_count) {
+                return;
+            }
+            phase[voice] = phase_value - std::floor(phase_value);
+        }
+
+        /* --- processing --- */
+
+        /**
+         * renders the sum of all voices into `signal_buffer`.
+         */
+        void process(float* signal_buffer, const uint32_t buffer_length) {
+            std::fill_n(signal_buffer, buffer_length, 0.0f);
+            add(signal_buffer, buffer_length);
+        }
+
+        /**
+         * adds the sum of all voices to `signal_buffer`.
+         */
+        void add(float* signal_buffer, const uint32_t buffer_length) {
+            for (uint32_t offset = 0; offset < buffer_length; offset += max_block_size) {
+                const uint32_t length = std::min(max_block_size, buffer_length - offset);
+                render_block(length);
+                for (uint32_t i = 0; i < length; ++i) {
+                    const float* m = &mix[i * LANES];
+                    signal_buffer[offset + i] += (m[0] + m[1]) + (m[2] + m[3]);
+                }
+            }
+        }
+
+    private:
+        static constexpr uint32_t GUARD_SAMPLES = 4;
+
+        const uint32_t     voice_count;
+        const uint32_t     padded_voice_count; // NOTE unused voices have zero amplitude
+        const uint32_t     wavetable_size;
+        const float        sample_rate;
+        const uint32_t     max_block_size;
+        uint8_t            interpolation{AudioUtilities::WAVESHAPE_INTERPOLATE_LINEAR};
+        std::vector<float> table;
+        std::vector<float> phase;
+        std::vector<float> increment; // NOTE phase increment per sample i.e `frequency / sample_rate`
+        std::vector<float> amplitude;
+        std::vector<float> amplitude_target;
+        std::vector<float> amplitude_delta;
+        std::vector<float> amplitude_steps;
+        std::vector<float> increment_target;
+        std::vector<float> increment_delta;
+        std::vector<float> increment_steps;
+        std::vector<float> mix; // NOTE per sample partial sums of each lane
+
+        float to_increment(const float frequency) const {
+            return std::min(std::fabs(frequency) / sample_rate, 0.5f);
+        }
+
+        /* --- vector of `LANES` floats --- */
+
+#if defined(UMFELD_WAVETABLE_BANK_SSE2)
+        using Vec = __m128;
+        static Vec  load(const float* p) { return _mm_loadu_ps(p); }
+        static void store(float* p, const Vec v) { _mm_storeu_ps(p, v); }
+        static Vec  set1(const float f) { return _mm_set1_ps(f); }
+        static Vec  add(const Vec a, const Vec b) { return _mm_add_ps(a, b); }
+        static Vec  sub(const Vec a, const Vec b) { return _mm_sub_ps(a, b); }
+        static Vec  mul(const Vec a, const Vec b) { return _mm_mul_ps(a, b); }
+        static Vec  max(const Vec a, const Vec b) { return _mm_max_ps(a, b); }
+        static Vec  select_gt(const Vec a, const Vec b, const Vec t, const Vec f) {
+            const __m128 m = _mm_cmpgt_ps(a, b);
+            return _mm_or_ps(_mm_and_ps(m, t), _mm_andnot_ps(m, f));
+        }
+        static Vec  select_eq(const Vec a, const Vec b, const Vec t, const Vec f) {
+            const __m128 m = _mm_cmpeq_ps(a, b);
+            return _mm_or_ps(_mm_and_ps(m, t), _mm_andnot_ps(m, f));
+        }
+        static Vec  truncate(const Vec v, int32_t* index) {
+            const __m128i i = _mm_cvttps_epi32(v);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(index), i);
+            return _mm_cvtepi32_ps(i);
+        }
+        static Vec  gather(const float* t, const int32_t* i, const int o) { return _mm_setr_ps(t[i[0] + o], t[i[1] + o], t[i[2] + o], t[i[3] + o]); }
+#elif defined(UMFELD_WAVETABLE_BANK_NEON)
+        using Vec = float32x4_t;
+        static Vec  load(const float* p) { return vld1q_f32(p); }
+        static void store(float* p, const Vec v) { vst1q_f32(p, v); }
+        static Vec  set1(const float f) { return vdupq_n_f32(f); }
+        static Vec  add(const Vec a, const Vec b) { return vaddq_f32(a, b); }
+        static Vec  sub(const Vec a, const Vec b) { return vsubq_f32(a, b); }
+        static Vec  mul(const Vec a, const Vec b) { return vmulq_f32(a, b); }
+        static Vec  max(const Vec a, const Vec b) { return vmaxq_f32(a, b); }
+        static Vec  select_gt(const Vec a, const Vec b, const Vec t, const Vec f) { return vbslq_f32(vcgtq_f32(a, b), t, f); }
+        static Vec  select_eq(const Vec a, const Vec b, const Vec t, const Vec f) { return vbslq_f32(vceqq_f32(a, b), t, f); }
+        static Vec  truncate(const Vec v, int32_t* index) {
+            const int32x4_t i = vcvtq_s32_f32(v);
+            vst1q_s32(index, i);
+            return vcvtq_f32_s32(i);
+        }
+        static Vec gather(const float* t, const int32_t* i, const int o) {
+            const float values[LANES] = {t[i[0] + o], t[i[1] + o], t[i[2] + o], t[i[3] + o]};
+            return vld1q_f32(values);
+        }
+#else
+        struct Vec {
+            float v[LANES];
+        };
+        static Vec  load(const float* p) { return {{p[0], p[1], p[2], p[3]}}; }
+        static void store(float* p, const Vec a) { std::copy_n(a.v, LANES, p); }
+        static Vec  set1(const float f) { return {{f, f, f, f}}; }
+        template<typename F>
+        static Vec map(const Vec a, const Vec b, F f) { return {{f(a.v[0], b.v[0]), f(a.v[1], b.v[1]), f(a.v[2], b.v[2]), f(a.v[3], b.v[3])}}; }
+        static Vec add(const Vec a, const Vec b) { return map(a, b, [](const float x, const float y) { return x + y; }); }
+        static Vec sub(const Vec a, const Vec b) { return map(a, b, [](const float x, const float y) { return x - y; }); }
+        static Vec mul(const Vec a, const Vec b) { return map(a, b, [](const float x, const float y) { return x * y; }); }
+        static Vec max(const Vec a, const Vec b) { return map(a, b, [](const float x, const float y) { return std::max(x, y); }); }
+        static Vec select_gt(const Vec a, const Vec b, const Vec t, const Vec f) {
+            Vec r;
+            for (uint32_t l = 0; l < LANES; ++l) {
+                r.v[l] = a.v[l] > b.v[l] ? t.v[l] : f.v[l];
+            }
+            return r;
+        }
+        static Vec select_eq(const Vec a, const Vec b, const Vec t, const Vec f) {
+            Vec r;
+            for (uint32_t l = 0; l < LANES; ++l) {
+                r.v[l] = a.v[l] == b.v[l] ? t.v[l] : f.v[l];
+            }
+            return r;
+        }
+        static Vec truncate(const Vec a, int32_t* index) {
+            Vec r;
+            for (uint32_t l = 0; l < LANES; ++l) {
+                index[l] = static_cast<int32_t>(a.v[l]);
+                r.v[l]   = static_cast<float>(index[l]);
+            }
+            return r;
+        }
+        static Vec gather(const float* t, const int32_t* i, const int o) { return {{t[i[0] + o], t[i[1] + o], t[i[2] + o], t[i[3] + o]}}; }
+#endif
+
+        /* --- rendering --- */
+
+        bool is_ramping() const {
+            for (uint32_t v = 0; v < voice_count; ++v) {
+                if (amplitude_steps[v] > 0.0f || increment_steps[v] > 0.0f) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void render_block(const uint32_t length) {
+            std::fill_n(mix.data(), static_cast<size_t>(length) * LANES, 0.0f);
+            const bool ramping = is_ramping();
+            switch (interpolation) {
+                case AudioUtilities::WAVESHAPE_INTERPOLATE_NONE:
+                    ramping ? render<AudioUtilities::WAVESHAPE_INTERPOLATE_NONE, true>(length)
+                            : render<AudioUtilities::WAVESHAPE_INTERPOLATE_NONE, false>(length);
+                    break;
+                case AudioUtilities::WAVESHAPE_INTERPOLATE_CUBIC:
+                    ramping ? render<AudioUtilities::WAVESHAPE_INTERPOLATE_CUBIC, true>(length)
+                            : render<AudioUtilities::WAVESHAPE_INTERPOLATE_CUBIC, false>(length);
+                    break;
+                default:
+                    ramping ? render<AudioUtilities::WAVESHAPE_INTERPOLATE_LINEAR, true>(length)
+                            : render<AudioUtilities::WAVESHAPE_INTERPOLATE_LINEAR, false>(length);
+                    break;
+            }
+        }
+
+        /**
+         * renders `LANES` voices at a time, the voice state stays in registers for the whole block.
+         */
+        template<uint8_t INTERPOLATION, bool RAMPING>
+        void render(const uint32_t length) {
+            const float* t         = table.data() + 1;
+            const Vec    size      = set1(static_cast<float>(wavetable_size));
+            const Vec    zero      = set1(0.0f);
+            const Vec    one       = set1(1.0f);
+            int32_t      index[LANES];
+            for (uint32_t v = 0; v < padded_voice_count; v += LANES) {
+                Vec p      = load(&phase[v]);
+                Vec inc    = load(&increment[v]);
+                Vec amp    = load(&amplitude[v]);
+                Vec amp_n  = load(&amplitude_steps[v]);
+                Vec inc_n  = load(&increment_steps[v]);
+                Vec amp_d  = load(&amplitude_delta[v]);
+                Vec inc_d  = load(&increment_delta[v]);
+                Vec amp_to = load(&amplitude_target[v]);
+                Vec inc_to = load(&increment_target[v]);
+                for (uint32_t i = 0; i < length; ++i) {
+                    if constexpr (RAMPING) {
+                        // NOTE the last step of a ramp lands exactly on the target value
+                        amp   = select_eq(amp_n, one, amp_to, select_gt(amp_n, zero, add(amp, amp_d), amp));
+                        inc   = select_eq(inc_n, one, inc_to, select_gt(inc_n, zero, add(inc, inc_d), inc));
+                        amp_n = max(sub(amp_n, one), zero);
+                        inc_n = max(sub(inc_n, one), zero);
+                    }
+                    const Vec position = mul(p, size);
+                    const Vec frac     = sub(position, truncate(position, index));
+                    Vec       sample;
+                    if constexpr (INTERPOLATION == AudioUtilities::WAVESHAPE_INTERPOLATE_NONE) {
+                        sample = gather(t, index, 0);
+                    } else if constexpr (INTERPOLATION == AudioUtilities::WAVESHAPE_INTERPOLATE_LINEAR) {
+                        const Vec a = gather(t, index, 0);
+                        const Vec b = gather(t, index, 1);
+                        sample      = add(a, mul(frac, sub(b, a)));
+                    } else {
+                        // NOTE same cubic interpolation as `Wavetable`
+                        const Vec a       = gather(t, index, -1);
+                        const Vec b       = gather(t, index, 0);
+                        const Vec c       = gather(t, index, 1);
+                        const Vec d       = gather(t, index, 2);
+                        const Vec tmp     = add(d, mul(set1(3.0f), b));
+                        const Vec frac_sq = mul(frac, frac);
+                        const Vec frac_cb = mul(frac, frac_sq);
+                        const Vec c0      = mul(sub(sub(zero, a), sub(mul(set1(3.0f), c), tmp)), set1(1.0f / 6.0f));
+                        const Vec c1      = sub(mul(add(a, c), set1(0.5f)), b);
+                        const Vec c2      = add(c, mul(sub(sub(zero, mul(set1(2.0f), a)), tmp), set1(1.0f / 6.0f)));
+                        sample            = add(add(mul(frac_cb, c0), mul(frac_sq, c1)), add(mul(frac, c2), b));
+                    }
+                    float* m = &mix[i * LANES];
+                    store(m, add(load(m), mul(sample, amp)));
+                    p = add(p, inc);
+                    int32_t wrap[LANES];
+                    p = sub(p, truncate(p, wrap));
+                }
+                store(&phase[v], p);
+                if constexpr (RAMPING) {
+                    store(&increment[v], inc);
+                    store(&amplitude[v], amp);
+                    store(&amplitude_steps[v], amp_n);
+                    store(&increment_steps[v], inc_n);
+                }
+            }
+        }
+    };
+} // namespace umfeld
@@ -0,0 +1,69 @@
+/*
+ * Umfeld
+ *
+ * This file is part of the *Umfeld* library (https://github.com/dennisppaul/umfeld).
+ * Copyright (c) 2025 Dennis P Paul.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "ShaderSource.h"
+
+namespace umfeld {
+    /* converts YUV planes into an RGBA texture bound as render target */
+    inline ShaderSource shader_source_yuv_to_rgba{
+        .vertex   = R"(
+out vec2 vUV;
+
+void main() {
+    const vec2 pos[3] = vec2[](
+        vec2(-1.0, -1.0),
+        vec2( 3.0, -1.0),
+        vec2(-1.0,  3.0)
+    );
+    vec2 p = pos[gl_VertexID];
+    vUV = p * 0.5 + 0.5; // NOTE no flip, first row of the planes ends up in the first row of the texture
+    gl_Position = vec4(p, 0.0, 1.0);
+}
+        )",
+        .fragment = R"(
+in vec2 vUV;
+
+out vec4 FragColor;
+
+uniform sampler2D u_texture_y;
+uniform sampler2D u_texture_u; // NOTE interleaved UV for NV12
+uniform sampler2D u_texture_v;
+uniform int       u_interleaved_uv;
+uniform vec2      u_luma;   // NOTE offset, scale
+uniform vec4      u_chroma; // NOTE V to R, U to G, V to G, U to B
+
+void main() {
+    float y = texture(u_texture_y, vUV).r;
+    vec2  uv;
+    if (u_interleaved_uv == 1) {
+        uv = texture(u_texture_u, vUV).rg;
+    } else {
+        uv = vec2(texture(u_texture_u, vUV).r, texture(u_texture_v, vUV).r);
+    }
+    uv -= 0.5;
+    float l   = u_luma.y * (y - u_luma.x);
+    vec3  rgb = vec3(l + u_chroma.x * uv.y,
+                     l - u_chroma.y * uv.x - u_chroma.z * uv.y,
+                     l + u_chroma.w * uv.x);
+    FragColor = vec4(clamp(rgb, 0.0, 1.0), 1.0);
+}
+        )"};
+}
@@ -0,0 +1,112 @@
+/*
+ * Umfeld
+ *
+ * This file is part of the *Umfeld* library (https://github.com/dennisppaul/umfeld).
+ * Copyright (c) 2025 Dennis P Paul.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string>
+
+#include "Umfeld.h"
+#include "AudioTelemetry.h"
+
+using namespace umfeld;
+
+AudioTelemetry::Stats AudioTelemetry::get_stats() const {
+    Stats stats;
+    stats.blocks = blocks.load(std::memory_order_acquire);
+    for (int i = 0; i < NUM_HISTOGRAM_BINS; ++i) {
+        stats.histogram[i] = histogram[i].load(std::memory_order_relaxed);
+    }
+    stats.block_duration_us = block_duration_us.load(std::memory_order_relaxed);
+    stats.last_duration_us  = last_duration_us.load(std::memory_order_relaxed);
+    stats.max_duration_us   = max_duration_us.load(std::memory_order_relaxed);
+    stats.load              = load.load(std::memory_order_relaxed);
+    stats.max_load          = max_load.load(std::memory_order_relaxed);
+    stats.max_jitter_us     = max_jitter_us.load(std::memory_order_relaxed);
+    stats.late_blocks       = late_blocks.load(std::memory_order_relaxed);
+    stats.underruns         = underruns.load(std::memory_order_relaxed);
+    stats.overruns          = overruns.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void AudioTelemetry::print_stats() const {
+    const Stats stats = get_stats();
+    console(format_label("audio blocks"), stats.blocks, " ( ", stats.block_duration_us, " µs per block )");
+    console(format_label("audio callback duration"), stats.last_duration_us, " µs ( max ", stats.max_duration_us, " µs )");
+    console(format_label("audio DSP load"), stats.load, "% ( max ", stats.max_load, "% )");
+    console(format_label("audio max jitter"), stats.max_jitter_us, " µs");
+    console(format_label("audio late blocks"), stats.late_blocks);
+    console(format_label("audio underruns"), stats.underruns);
+    console(format_label("audio overruns"), stats.overruns);
+    for (int i = 0; i < NUM_HISTOGRAM_BINS; ++i) {
+        const std::string range = i < NUM_HISTOGRAM_BINS - 1 ? std::to_string(i * 10) + "-" + std::to_string(i * 10 + 10) + "%" : ">" + std::to_string(i * 10) + "%";
+        console(format_label("audio load " + range), stats.histogram[i]);
+    }
+}
+
+bool AudioTelemetry::start_logging(const std::string& file_path, const float interval_seconds) {
+    stop_logging();
+    log_file = fopen(file_path.c_str(), "w");
+    if (log_file == nullptr) {
+        error_in_function("could not open audio telemetry log: ", file_path);
+        return false;
+    }
+    fprintf(log_file, "time,blocks,block_duration_us,last_duration_us,max_duration_us,load,max_load,max_jitter_us,late_blocks,underruns,overruns");
+    for (int i = 0; i < NUM_HISTOGRAM_BINS; ++i) {
+        fprintf(log_file, ",bin_%d", i * 10);
+    }
+    fprintf(log_file, "\n");
+    log_interval_seconds = interval_seconds > 0.0f ? interval_seconds : 1.0f;
+    log_start            = Clock::now();
+    log_last             = log_start;
+    return true;
+}
+
+void AudioTelemetry::stop_logging() {
+    if (log_file != nullptr) {
+        fclose(log_file);
+        log_file = nullptr;
+    }
+}
+
+void AudioTelemetry::update_log() {
+    if (log_file == nullptr) {
+        return;
+    }
+    const auto now = Clock::now();
+    if (std::chrono::duration<float>(now - log_last).count() < log_interval_seconds) {
+        return;
+    }
+    log_last          = now;
+    const Stats stats = get_stats();
+    fprintf(log_file, "%.3f,%llu,%.1f,%.1f,%.1f,%.2f,%.2f,%.1f,%llu,%llu,%llu",
+            std::chrono::duration<double>(now - log_start).count(),
+            static_cast<unsigned long long>(stats.blocks),
+            stats.block_duration_us,
+            stats.last_duration_us,
+            stats.max_duration_us,
+            stats.load,
+            stats.max_load,
+            stats.max_jitter_us,
+            static_cast<unsigned long long>(stats.late_blocks),
+            static_cast<unsigned long long>(stats.underruns),
+            static_cast<unsigned long long>(stats.overruns));
+    for (const auto bin: stats.histogram) {
+        fprintf(log_file, ",%llu", static_cast<unsigned long long>(bin));
+    }
+    fprintf(log_file, "\n");
+    fflush(log_file);
+}
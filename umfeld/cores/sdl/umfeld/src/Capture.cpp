@@ -22,6 +22,8 @@
 #endif
 
 #include "Capture.h"
+#include "YUVFrameAV.h"
+#include "UmfeldFunctionsAdditional.h"
 
 #if defined(ENABLE_CAPTURE) && !defined(DISABLE_GRAPHICS) && !defined(DISABLE_VIDEO)
 #ifdef __cplusplus
@@ -39,6 +41,8 @@ extern "C" {
 #endif
 #endif // ENABLE_CAPTURE && !DISABLE_GRAPHICS && !DISABLE_VIDEO
 
+#include <algorithm>
+#include <chrono>
 #include <iostream>
 #include <vector>
 #include <string>
@@ -57,16 +61,21 @@ namespace umfeld {
 #endif
     }
 
+    static constexpr auto TEST_SOURCE_PREFIX = "lavfi:";
+
     Capture::Capture() {
-        keepRunning    = true;
-        isPlaying      = false;
-        playbackThread = std::thread(&Capture::playbackLoop, this);
+        keepRunning = true;
+        isPlaying   = false;
     }
 
     bool Capture::init(const char* device_name,
                        const char* resolution,
                        const char* frame_rate,
                        const char* pixel_format) {
+        if (fIsInitialized) {
+            warning_in_function("capture is already initialized");
+            return false;
+        }
         const int result = connect(device_name,
                                    resolution,
                                    frame_rate,
@@ -75,42 +84,95 @@ namespace umfeld {
             std::cerr << "Failed to connect to camera" << std::endl;
             return false;
         }
-        fDeviceName = device_name;
-        // TODO not sure how smart this is … better if the devices decides?
-        frameDuration  = 1.0f / (frame_rate ? std::stof(frame_rate) : 30.0f);
+        fDeviceName = device_name != nullptr ? device_name : "";
+        // NOTE prefer the frame rate reported by the device
+        const AVRational stream_frame_rate = formatContext->streams[videoStreamIndex]->avg_frame_rate;
+        if (stream_frame_rate.num > 0 && stream_frame_rate.den > 0) {
+            frameDuration = av_q2d(av_inv_q(stream_frame_rate));
+        } else {
+            frameDuration = 1.0f / (frame_rate ? std::stof(frame_rate) : 30.0f);
+        }
         fIsInitialized = true;
+        capture_thread = std::thread(&Capture::capture_loop, this);
+        convert_thread = std::thread(&Capture::convert_loop, this);
         return true;
     }
 
+    /**
+     * returns a timestamp in microseconds from a monotonic clock. used for the capture time of frames.
+     */
+    int64_t Capture::capture_timestamp() {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /**
+     * returns the device name of an FFmpeg test source ( `testsrc2` ) with the given size and frame
+     * rate. the name can be passed to `init()` like a camera name.
+     */
+    std::string Capture::test_source(const int width, const int height, const int frame_rate) {
+        return std::string(TEST_SOURCE_PREFIX) + "testsrc2=size=" + std::to_string(width) + "x" + std::to_string(height) + ":rate=" + std::to_string(frame_rate);
+    }
+
+    /**
+     * returns true if a new frame is ready to be read.
+     */
+    bool Capture::available() {
+        std::lock_guard lock(frame_ring_mutex);
+        return ready_frame >= 0;
+    }
+
+    /**
+     * uploads the most recent converted frame. returns false without blocking if there is no new frame.
+     */
     bool Capture::read(PGraphics* graphics) {
         if (graphics == nullptr) {
             return false;
         }
 
-        if (convertedFrame == nullptr) {
+        if (frame_ring.empty()) {
             return false;
         }
 
-        if (!processFrame()) {
-            return false; // No frame available or error processing frame
+        {
+            std::lock_guard lock(frame_ring_mutex);
+            if (ready_frame < 0) {
+                return false; // No frame available
+            }
+            // NOTE the previously displayed frame becomes free for the convert thread
+            displayed_frame = ready_frame;
+            ready_frame     = -1;
         }
 
-        pixels = reinterpret_cast<uint32_t*>(convertedFrame->data[0]);
-        update_full_internal(graphics);
+        capture_time = frame_ring[displayed_frame].capture_time;
+        latency      = static_cast<float>(capture_timestamp() - capture_time) * 1e-6f;
+        upload_frame(graphics);
         return true;
     }
 
+    void Capture::upload_frame(PGraphics* graphics) {
+        const CaptureFrame& capture_frame = frame_ring[displayed_frame];
+        pixels                            = reinterpret_cast<uint32_t*>(capture_frame.data[0]);
+        YUVFrame yuv;
+        if (get_yuv_frame(capture_frame.yuv_frame, yuv)) {
+            if (graphics->upload_texture_yuv(this, yuv)) {
+                return;
+            }
+            // NOTE renderer can not convert YUV planes, convert on the CPU instead
+            yuv_to_rgba(yuv, pixels);
+        }
+        update_full_internal(graphics);
+    }
+
     void Capture::reload(PGraphics* graphics) {
         if (graphics == nullptr) {
             return;
         }
 
-        if (convertedFrame == nullptr) {
+        if (frame_ring.empty()) {
             return;
         }
 
-        pixels = reinterpret_cast<uint32_t*>(convertedFrame->data[0]);
-        update_full_internal(graphics);
+        upload_frame(graphics);
     }
 
     int Capture::connect(const char* device_name,
@@ -119,8 +181,6 @@ namespace umfeld {
                          const char* pixel_format) {
         register_all_devices();
 
-        // Set the input channels for your platform:
-        const AVInputFormat* inputFormat = av_find_input_format(get_platform_inputformat());
 #ifdef _WIN32
         auto default_device_name = "video=Integrated Camera";
 #elif __linux__
@@ -135,20 +195,45 @@ namespace umfeld {
         } else {
             device_name_str = device_name;
         }
-        const auto deviceName = device_name_str.c_str();
 
         formatContext = nullptr;
+        options       = nullptr;
 
-        options = nullptr;
-        if (resolution != nullptr) {
-            av_dict_set(&options, "video_size", resolution, 0);
-        }
-        if (frame_rate != nullptr) {
-            av_dict_set(&options, "framerate", frame_rate, 0);
-        }
-        if (pixel_format != nullptr) {
-            av_dict_set(&options, "pixel_format", pixel_format, 0);
+        // Set the input channels for your platform:
+        const AVInputFormat* inputFormat;
+        if (begins_with(device_name_str, TEST_SOURCE_PREFIX)) {
+            // NOTE test source is a filter graph e.g `testsrc2=size=1920x1080:rate=60`
+            inputFormat     = av_find_input_format("lavfi");
+            is_test_source  = true;
+            device_name_str = device_name_str.substr(std::string(TEST_SOURCE_PREFIX).length());
+            if (device_name_str.find('=') == std::string::npos) {
+                std::string filter_options;
+                if (resolution != nullptr) {
+                    filter_options += std::string("size=") + resolution;
+                }
+                if (frame_rate != nullptr) {
+                    filter_options += (filter_options.empty() ? "" : ":") + std::string("rate=") + frame_rate;
+                }
+                if (!filter_options.empty()) {
+                    device_name_str += "=" + filter_options;
+                }
+            }
+            if (pixel_format != nullptr) {
+                device_name_str += std::string(",format=") + pixel_format;
+            }
+        } else {
+            inputFormat = av_find_input_format(get_platform_inputformat());
+            if (resolution != nullptr) {
+                av_dict_set(&options, "video_size", resolution, 0);
+            }
+            if (frame_rate != nullptr) {
+                av_dict_set(&options, "framerate", frame_rate, 0);
+            }
+            if (pixel_format != nullptr) {
+                av_dict_set(&options, "pixel_format", pixel_format, 0);
+            }
         }
+        const auto deviceName = device_name_str.c_str();
 
         av_dict_set(&options, "probesize", "10000000", 0);      // 1MB probe size
         av_dict_set(&options, "analyzeduration", "3000000", 0); // 5 seconds analysis duration
@@ -207,28 +292,12 @@ namespace umfeld {
         }
 
         // Allocate video frame
-        frame = av_frame_alloc();
+        frame  = av_frame_alloc();
+        packet = av_packet_alloc();
 
         // Determine the pixel channels and number of channels based on input file
-        constexpr int           default_channels_RGBA = 4;
-        constexpr AVPixelFormat dst_pix_fmt           = AV_PIX_FMT_RGBA;
-        const AVPixelFormat     src_pix_fmt           = codecContext->pix_fmt;
-
-        // AVPixelFormat             dst_pix_fmt;
-        // const AVPixFmtDescriptor* desc      = av_pix_fmt_desc_get(src_pix_fmt);
-        // if (_channels < 0) {
-        //     _channels   = 4;
-        //     dst_pix_fmt = AV_PIX_FMT_RGBA;
-        //     std::cout << "not looking for channels. defaulting to RGBA ( 4 channels )" << std::endl;
-        // } else if (desc && desc->nb_components == 4) {
-        //     _channels   = 4;
-        //     dst_pix_fmt = AV_PIX_FMT_RGBA;
-        //     std::cout << "found RGBA video" << std::endl;
-        // } else {
-        //     _channels   = 3;
-        //     dst_pix_fmt = AV_PIX_FMT_RGB24;
-        //     std::cout << "found RGB video" << std::endl;
-        // }
+        constexpr AVPixelFormat dst_pix_fmt = AV_PIX_FMT_RGBA;
+        const AVPixelFormat     src_pix_fmt = codecContext->pix_fmt;
 
         swsContext = sws_getContext(
             codecContext->width, codecContext->height, src_pix_fmt,
@@ -236,47 +305,28 @@ namespace umfeld {
             SWS_FAST_BILINEAR,
             nullptr, nullptr, nullptr);
 
-        // swsContext = sws_getContext(
-        //     codecContext->width, codecContext->height, codecContext->pix_fmt,
-        //     codecContext->width, codecContext->height, AV_PIX_FMT_RGB24,
-        //     SWS_BILINEAR, nullptr, nullptr, nullptr);
-
-        convertedFrame = av_frame_alloc();
-        if (!convertedFrame) {
-            std::cerr << "+++ Movie: ERROR: Failed to allocate converted frame" << std::endl;
-            return -1;
+        // Allocate the ring of converted frames
+        frame_ring.resize(FRAME_RING_SIZE);
+        for (auto& capture_frame: frame_ring) {
+            if (av_image_alloc(capture_frame.data,
+                               capture_frame.linesize,
+                               codecContext->width,
+                               codecContext->height,
+                               dst_pix_fmt,
+                               1) < 0) {
+                std::cerr << "+++ Capture: ERROR: Failed to allocate converted frame" << std::endl;
+                return -1;
+            }
+            capture_frame.yuv_frame = av_frame_alloc();
         }
-
         const int numBytes = av_image_get_buffer_size(dst_pix_fmt,
                                                       codecContext->width,
                                                       codecContext->height,
                                                       1);
-        buffer             = static_cast<uint8_t*>(av_malloc(numBytes * sizeof(uint8_t)));
-        av_image_fill_arrays(convertedFrame->data,
-                             convertedFrame->linesize,
-                             buffer,
-                             dst_pix_fmt,
-                             codecContext->width,
-                             codecContext->height,
-                             1);
-        // Prepare for frame conversion (if you need to scale or convert pixel channels)
-        // swsContext         = sws_getContext(codecContext->width, codecContext->height, codecContext->pix_fmt,
-        //                                     codecContext->width, codecContext->height, AV_PIX_FMT_RGB24,
-        //                                     SWS_BILINEAR, nullptr, nullptr, nullptr);
-        // rgbFrame           = av_frame_alloc();
-        // const int numBytes = av_image_get_buffer_size(AV_PIX_FMT_RGB24, codecContext->width, codecContext->height, 1);
-        // buffer             = static_cast<uint8_t*>(av_malloc(numBytes * sizeof(uint8_t)));
-        // av_image_fill_arrays(rgbFrame->data, rgbFrame->linesize, buffer, AV_PIX_FMT_RGB24, codecContext->width, codecContext->height, 1);
-        av_image_fill_arrays(convertedFrame->data,
-                             convertedFrame->linesize,
-                             buffer,
-                             dst_pix_fmt,
-                             codecContext->width,
-                             codecContext->height,
-                             1);
-        packet = av_packet_alloc();
+        std::fill_n(frame_ring[0].data[0], numBytes, 0);
+        displayed_frame = 0;
 
-        PImage::init(reinterpret_cast<uint32_t*>(buffer),
+        PImage::init(reinterpret_cast<uint32_t*>(frame_ring[displayed_frame].data[0]),
                      codecContext->width,
                      codecContext->height);
         return 0;
@@ -284,153 +334,135 @@ namespace umfeld {
 
     Capture::~Capture() {
         keepRunning = false;
-        if (playbackThread.joinable()) {
-            playbackThread.join();
+        decoded_queue.close();
+        if (capture_thread.joinable()) {
+            capture_thread.join();
         }
+        if (convert_thread.joinable()) {
+            convert_thread.join();
+        }
+        decoded_queue.clear([](DecodedFrame& decoded) { av_frame_free(&decoded.frame); });
+        for (auto& capture_frame: frame_ring) {
+            av_freep(&capture_frame.data[0]);
+            av_frame_free(&capture_frame.yuv_frame);
+        }
+        frame_ring.clear();
+        pixels = nullptr;
         av_dict_free(&options);
-        av_free(buffer);
         av_frame_free(&frame);
-        av_frame_free(&convertedFrame);
-        // av_frame_free(&rgbFrame);
         av_packet_free(&packet);
         avcodec_free_context(&codecContext);
         avformat_close_input(&formatContext);
+        sws_freeContext(swsContext);
     }
 
-    void Capture::playbackLoop() {
+    /**
+     * reads and decodes frames from the device. each frame is stamped with the time it was received and
+     * passed on to the convert thread. if the convert thread falls behind the oldest frame is dropped.
+     */
+    void Capture::capture_loop() {
+        auto next_frame_time = std::chrono::steady_clock::now();
         while (keepRunning) {
-            if (isPlaying) {
-                auto frame_start = std::chrono::steady_clock::now();
-                if (available()) {
-                    if (processFrame()) {
-                        // TODO flag that a texture reload is required
-                        if (listener) {
-                            listener->captureEvent(this);
-                        }
-                    }
-                }
-
-                auto                          frame_end = std::chrono::steady_clock::now();
-                std::chrono::duration<double> elapsed   = frame_end - frame_start;
-
-                if (elapsed.count() < frameDuration) {
-                    std::this_thread::sleep_for(std::chrono::duration<double>(frameDuration - elapsed.count()));
-                }
-            } else {
+            if (!isPlaying) {
                 // If not playing, sleep for a short duration to prevent busy waiting
                 std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                next_frame_time = std::chrono::steady_clock::now();
+                continue;
             }
-        }
-    }
-
-    bool Capture::available() {
-        if (convertedFrame == nullptr) {
-            return false;
-        }
 
-        if (codecContext == nullptr) {
-            return false;
-        }
+            // NOTE a physical device blocks until the next frame arrives, a test source does not
+            if (is_test_source && realtime) {
+                std::this_thread::sleep_until(next_frame_time);
+                next_frame_time += std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(frameDuration));
+            }
 
-        if (formatContext == nullptr) {
-            return false;
-        }
+            const int ret = av_read_frame(formatContext, packet);
+            if (ret == AVERROR_EOF) {
+                stop();
+                continue;
+            }
+            if (ret < 0) {
+                if (ret != AVERROR(EAGAIN)) {
+                    char err_buf[AV_ERROR_MAX_STRING_SIZE];
+                    av_strerror(ret, err_buf, AV_ERROR_MAX_STRING_SIZE);
+#ifdef UMFELD_CAPTURE_PRINT_ERRORS
+                    printf("Error occurred: %s\n", err_buf);
+#endif
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                continue;
+            }
 
-        const int ret = av_read_frame(formatContext, packet);
-        if (ret >= 0) {
+            const int64_t packet_capture_time = capture_timestamp();
             if (packet->stream_index == videoStreamIndex) {
-                fVideoFrameAvailable = true;
                 avcodec_send_packet(codecContext, packet);
+                while (avcodec_receive_frame(codecContext, frame) == 0) {
+                    DecodedFrame decoded;
+                    decoded.frame        = av_frame_alloc();
+                    decoded.capture_time = packet_capture_time;
+                    av_frame_move_ref(decoded.frame, frame);
+                    if (!decoded_queue.push_latest(decoded, [](DecodedFrame& dropped) { av_frame_free(&dropped.frame); })) {
+                        dropped_frames++;
+                    }
+                }
             }
             av_packet_unref(packet);
-        } else if (ret == AVERROR_EOF) {
-            stop();
-        } else {
-            char err_buf[AV_ERROR_MAX_STRING_SIZE];
-            av_strerror(ret, err_buf, AV_ERROR_MAX_STRING_SIZE);
-#ifdef UMFELD_CAPTURE_PRINT_ERRORS
-            printf("Error occurred: %s\n", err_buf);
-#endif
         }
-        return fVideoFrameAvailable;
     }
 
-    bool Capture::processFrame() {
-        if (codecContext == nullptr) {
-            return false;
-        }
-
-        if (convertedFrame == nullptr) {
-            return false;
-        }
-
-        if (fVideoFrameAvailable) {
-            const int ret = avcodec_receive_frame(codecContext, frame);
-            if (ret == 0) {
-                // Successfully received a frame
-                fFrameCounter++;
+    /**
+     * converts decoded frames into a free slot of the frame ring and publishes it as the most recent
+     * frame. a frame that was published but not read yet is replaced.
+     */
+    void Capture::convert_loop() {
+        DecodedFrame decoded;
+        while (keepRunning && decoded_queue.pop(decoded)) {
+            int index = -1;
+            {
+                std::lock_guard lock(frame_ring_mutex);
+                for (int i = 0; i < static_cast<int>(frame_ring.size()); i++) {
+                    if (i != displayed_frame && i != ready_frame) {
+                        index = i;
+                        break;
+                    }
+                }
+            }
+            if (index < 0) {
+                av_frame_free(&decoded.frame);
+                continue;
+            }
 
-                // Convert data to RGBA or RGB
+            CaptureFrame& capture_frame = frame_ring[index];
+            av_frame_unref(capture_frame.yuv_frame);
+            YUVFrame yuv;
+            if (yuv_mode && get_yuv_frame(decoded.frame, yuv)) {
+                // NOTE keep a reference to the decoded planes, they are converted on upload
+                av_frame_move_ref(capture_frame.yuv_frame, decoded.frame);
+            } else {
+                // Convert data to RGBA
                 sws_scale(swsContext,
-                          frame->data,
-                          frame->linesize,
+                          decoded.frame->data,
+                          decoded.frame->linesize,
                           0,
-                          frame->height,
-                          convertedFrame->data,
-                          convertedFrame->linesize);
-
-                av_frame_unref(frame);
+                          decoded.frame->height,
+                          capture_frame.data,
+                          capture_frame.linesize);
+            }
+            capture_frame.capture_time = decoded.capture_time;
+            av_frame_free(&decoded.frame);
 
-                fVideoFrameAvailable = false;
-                return true;
-            } else {
-                if (ret == AVERROR_EOF) {
-                    // Handle end of stream
-                    std::cout << "+++ AVERROR_EOF" << std::endl;
-                } else if (ret == AVERROR(EAGAIN)) {
-                    // No frame available right now, try again later
-                    //                std::cout << "+++ AVERROR(EAGAIN)" << std::endl;
-                } else {
-                    // std::cerr << "+++ Movie: ERROR: Error receiving frame: " << av_err2str(ret));
+            {
+                std::lock_guard lock(frame_ring_mutex);
+                if (ready_frame >= 0) {
+                    dropped_frames++;
                 }
-                av_frame_unref(frame);
-                return false;
+                ready_frame = index;
+            }
+            fFrameCounter++;
+            if (listener) {
+                listener->captureEvent(this);
             }
         }
-        return false;
-        // // Capture and process frames
-        // while (av_read_frame(formatContext, packet) >= 0) {
-        //     // Ensure the packet belongs to the video stream
-        //     if (packet->stream_index == videoStreamIndex) {
-        //         int response = avcodec_send_packet(codecContext, packet);
-        //         if (response < 0) {
-        //             std::cerr << "Error while sending packet to decoder: " << av_err2str(response) << std::endl;
-        //             break;
-        //         }
-        //
-        //         while (response >= 0) {
-        //             response = avcodec_receive_frame(codecContext, frame);
-        //             if (response == AVERROR(EAGAIN) || response == AVERROR_EOF) {
-        //                 break;
-        //             } else if (response < 0) {
-        //                 std::cerr << "Error while receiving frame from decoder: " << av_err2str(response) << std::endl;
-        //                 break;
-        //             }
-        //
-        //             // Convert the frame to RGB
-        //             sws_scale(swsContext, frame->data,
-        //                       frame->linesize,
-        //                       0,
-        //                       codecContext->height,
-        //                       rgbFrame->data,
-        //                       rgbFrame->linesize);
-        //
-        //             // Process the RGB frame (you could display it or save it)
-        //             std::cout << "Captured frame with width " << codecContext->width << " and height " << codecContext->height << std::endl;
-        //         }
-        //     }
-        //     av_packet_unref(packet);
-        // }
     }
 
     void Capture::start() {
@@ -610,6 +642,17 @@ namespace umfeld {
 
     Capture::~Capture() = default;
 
+    int64_t Capture::capture_timestamp() {
+        return 0;
+    }
+
+    std::string Capture::test_source(int width, int height, int frame_rate) {
+        (void) width;
+        (void) height;
+        (void) frame_rate;
+        return "";
+    }
+
     void Capture::list_capabilities(const std::string& device_name) {
         (void) device_name;
     }
@@ -0,0 +1,449 @@
+/*
+ * Umfeld
+ *
+ * This file is part of the *Umfeld* library (https://github.com/dennisppaul/umfeld).
+ * Copyright (c) 2025 Dennis P Paul.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include <map>
+#include <memory>
+
+#if defined(SYSTEM_WINDOWS)
+#ifndef NOMINMAX
+#define NOMINMAX // NOTE `std::min` and `std::max` are used below
+#endif
+#ifndef _WIN32_WINNT
+#define _WIN32_WINNT 0x0602 // NOTE `PrefetchVirtualMemory` requires windows 8
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "Umfeld.h"
+#include "ImageSequence.h"
+#include "PGraphics.h"
+
+using namespace umfeld;
+
+static_assert(sizeof(ImageSequenceHeader) == 64, "image sequence header must be 64 bytes");
+
+static bool file_seek(FILE* file, const uint64_t offset) {
+#if defined(SYSTEM_WINDOWS)
+    return _fseeki64(file, static_cast<__int64>(offset), SEEK_SET) == 0;
+#else
+    return fseeko(file, static_cast<off_t>(offset), SEEK_SET) == 0;
+#endif
+}
+
+/* --- ImageSequenceHeader --- */
+
+uint64_t ImageSequenceHeader::stride_for(const uint32_t width, const uint32_t height) {
+    const uint64_t frame_size = static_cast<uint64_t>(width) * static_cast<uint64_t>(height) * sizeof(uint32_t);
+    return (frame_size + FRAME_ALIGNMENT - 1) / FRAME_ALIGNMENT * FRAME_ALIGNMENT;
+}
+
+bool ImageSequenceHeader::is_valid() const {
+    return std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0 &&
+           version == VERSION &&
+           pixel_format == PIXEL_FORMAT_RGBA8 &&
+           width > 0 && height > 0 &&
+           data_offset >= sizeof(ImageSequenceHeader) &&
+           frame_stride >= static_cast<uint64_t>(width) * static_cast<uint64_t>(height) * sizeof(uint32_t);
+}
+
+/* --- ImageSequence --- */
+
+ImageSequence::ImageSequence(const std::string& filepath) : PImage() {
+    if (!map_file(filepath)) {
+        return;
+    }
+
+    std::memcpy(&header, mapped_data, sizeof(ImageSequenceHeader));
+    if (!header.is_valid()) {
+        error_in_function("not a valid image sequence file: ", filepath);
+        unmap_file();
+        return;
+    }
+
+    /* NOTE frame count is limited by the file size in case the file was not completely written */
+    const uint64_t frames_in_file = mapped_size > header.data_offset ? (mapped_size - header.data_offset) / header.frame_stride : 0;
+    frame_count                   = static_cast<int>(std::min(static_cast<uint64_t>(header.frame_count), frames_in_file));
+    if (frame_count < static_cast<int>(header.frame_count)) {
+        warning_in_function("image sequence is truncated. found ", frame_count, " of ", header.frame_count, " frames");
+    }
+
+#if !defined(SYSTEM_WINDOWS)
+    madvise(mapped_data, mapped_size, MADV_SEQUENTIAL);
+#endif
+
+    width  = static_cast<float>(header.width);
+    height = static_cast<float>(header.height);
+    if (frame_count > 0) {
+        pixels = const_cast<uint32_t*>(frame_pixels(0));
+        prefetch(0, prefetch_frames);
+    }
+}
+
+ImageSequence::~ImageSequence() {
+    pixels = nullptr; // NOTE pixels point into the mapped file
+    unmap_file();
+}
+
+const uint32_t* ImageSequence::frame_pixels(const int frame_index) const {
+    if (mapped_data == nullptr || frame_index < 0 || frame_index >= frame_count) {
+        return nullptr;
+    }
+    const uint64_t offset = header.data_offset + static_cast<uint64_t>(frame_index) * header.frame_stride;
+    return reinterpret_cast<const uint32_t*>(mapped_data + offset);
+}
+
+float ImageSequence::duration() const {
+    if (header.frame_rate <= 0.0f) {
+        return 0.0f;
+    }
+    return static_cast<float>(frame_count) / header.frame_rate;
+}
+
+/**
+ * points `pixels` to the requested frame and uploads it to the texture. the following frames are
+ * prefetched ( see `set_prefetch_frames()` ).
+ */
+bool ImageSequence::read(const int frame_index, PGraphics* graphics) {
+    if (graphics == nullptr) {
+        return false;
+    }
+    const uint32_t* frame = frame_pixels(frame_index);
+    if (frame == nullptr) {
+        return false;
+    }
+    if (frame_index == frame_index_current) {
+        return true;
+    }
+    pixels              = const_cast<uint32_t*>(frame);
+    frame_index_current = frame_index;
+    update_full_internal(graphics);
+    prefetch(frame_index + 1, prefetch_frames);
+    return true;
+}
+
+bool ImageSequence::read_at_time(const float seconds, const bool loop, PGraphics* graphics) {
+    if (frame_count <= 0) {
+        return false;
+    }
+    int frame_index = static_cast<int>(std::floor(seconds * header.frame_rate));
+    if (loop) {
+        frame_index %= frame_count;
+        if (frame_index < 0) {
+            frame_index += frame_count;
+        }
+    } else {
+        frame_index = std::clamp(frame_index, 0, frame_count - 1);
+    }
+    return read(frame_index, graphics);
+}
+
+/**
+ * hints the operating system to load the pages of the requested frames into memory.
+ */
+void ImageSequence::prefetch(const int frame_index, const int num_frames) const {
+    const int first = std::max(0, frame_index);
+    const int last  = std::min(frame_count, frame_index + num_frames);
+    if (mapped_data == nullptr || last <= first) {
+        return;
+    }
+#if defined(SYSTEM_WINDOWS)
+    SYSTEM_INFO system_info;
+    GetSystemInfo(&system_info);
+    const auto page_size = static_cast<uint64_t>(system_info.dwPageSize);
+#else
+    const auto page_size = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+#endif
+    uint64_t begin = header.data_offset + static_cast<uint64_t>(first) * header.frame_stride;
+    uint64_t end   = header.data_offset + static_cast<uint64_t>(last) * header.frame_stride;
+    begin          = begin / page_size * page_size;
+    end            = std::min(end, static_cast<uint64_t>(mapped_size));
+    if (end <= begin) {
+        return;
+    }
+#if defined(SYSTEM_WINDOWS)
+    WIN32_MEMORY_RANGE_ENTRY range;
+    range.VirtualAddress = mapped_data + begin;
+    range.NumberOfBytes  = static_cast<SIZE_T>(end - begin);
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#else
+    madvise(mapped_data + begin, end - begin, MADV_WILLNEED);
+#endif
+}
+
+bool ImageSequence::map_file(const std::string& filepath) {
+#if defined(SYSTEM_WINDOWS)
+    HANDLE file = CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        error_in_function("could not open file: ", filepath);
+        return false;
+    }
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart < static_cast<LONGLONG>(sizeof(ImageSequenceHeader))) {
+        error_in_function("file is too small: ", filepath);
+        CloseHandle(file);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+    if (mapping == nullptr) {
+        error_in_function("could not map file: ", filepath);
+        CloseHandle(file);
+        return false;
+    }
+    void* data = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+    if (data == nullptr) {
+        error_in_function("could not map file: ", filepath);
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    file_handle    = file;
+    mapping_handle = mapping;
+    mapped_data    = static_cast<uint8_t*>(data);
+    mapped_size    = static_cast<size_t>(file_size.QuadPart);
+    return true;
+#else
+    const int fd = open(filepath.c_str(), O_RDONLY);
+    if (fd < 0) {
+        error_in_function("could not open file: ", filepath);
+        return false;
+    }
+    struct stat file_stat{};
+    if (fstat(fd, &file_stat) != 0 || file_stat.st_size < static_cast<off_t>(sizeof(ImageSequenceHeader))) {
+        error_in_function("file is too small: ", filepath);
+        ::close(fd);
+        return false;
+    }
+    // NOTE private mapping, writes to `pixels` are copy-on-write and never reach the file
+    void* data = mmap(nullptr, static_cast<size_t>(file_stat.st_size), PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    ::close(fd); // NOTE mapping stays valid after closing the file descriptor
+    if (data == MAP_FAILED) {
+        error_in_function("could not map file: ", filepath);
+        return false;
+    }
+    mapped_data = static_cast<uint8_t*>(data);
+    mapped_size = static_cast<size_t>(file_stat.st_size);
+    return true;
+#endif
+}
+
+void ImageSequence::unmap_file() {
+    if (mapped_data == nullptr) {
+        return;
+    }
+#if defined(SYSTEM_WINDOWS)
+    UnmapViewOfFile(mapped_data);
+    CloseHandle(static_cast<HANDLE>(mapping_handle));
+    CloseHandle(static_cast<HANDLE>(file_handle));
+    mapping_handle = nullptr;
+    file_handle    = nullptr;
+#else
+    munmap(mapped_data, mapped_size);
+#endif
+    mapped_data = nullptr;
+    mapped_size = 0;
+    frame_count = 0;
+}
+
+/* --- ImageSequenceWriter --- */
+
+ImageSequenceWriter::ImageSequenceWriter(const std::string& filepath, const int width, const int height, const float frame_rate) {
+    if (width <= 0 || height <= 0) {
+        error_in_function("invalid frame size: ", width, "x", height);
+        return;
+    }
+
+    /* append to existing file if the frame size matches */
+    file = fopen(filepath.c_str(), "r+b");
+    if (file != nullptr) {
+        ImageSequenceHeader existing;
+        if (fread(&existing, sizeof(ImageSequenceHeader), 1, file) == 1 &&
+            existing.is_valid() &&
+            existing.width == static_cast<uint32_t>(width) &&
+            existing.height == static_cast<uint32_t>(height)) {
+            header = existing;
+        } else {
+            warning_in_function("existing file has a different format or frame size, overwriting: ", filepath);
+            fclose(file);
+            file = nullptr;
+        }
+    }
+
+    if (file == nullptr) {
+        file = fopen(filepath.c_str(), "w+b");
+        if (file == nullptr) {
+            error_in_function("could not open file for writing: ", filepath);
+            return;
+        }
+        header.width        = static_cast<uint32_t>(width);
+        header.height       = static_cast<uint32_t>(height);
+        header.frame_rate   = frame_rate;
+        header.frame_stride = ImageSequenceHeader::stride_for(header.width, header.height);
+        if (!write_header()) {
+            close();
+            return;
+        }
+    }
+
+    const uint64_t frame_size = static_cast<uint64_t>(header.width) * static_cast<uint64_t>(header.height) * sizeof(uint32_t);
+    padding.assign(static_cast<size_t>(header.frame_stride - frame_size), 0);
+}
+
+ImageSequenceWriter::~ImageSequenceWriter() {
+    close();
+}
+
+bool ImageSequenceWriter::write_header() {
+    if (!file_seek(file, 0) || fwrite(&header, sizeof(ImageSequenceHeader), 1, file) != 1) {
+        error_in_function("could not write header");
+        return false;
+    }
+    /* NOTE pad header to `data_offset` */
+    const std::vector<char> header_padding(static_cast<size_t>(header.data_offset - sizeof(ImageSequenceHeader)), 0);
+    if (fwrite(header_padding.data(), 1, header_padding.size(), file) != header_padding.size()) {
+        error_in_function("could not write header");
+        return false;
+    }
+    return true;
+}
+
+bool ImageSequenceWriter::add_frame(const uint32_t* pixel_data) {
+    if (file == nullptr || pixel_data == nullptr) {
+        return false;
+    }
+    const uint64_t offset     = header.data_offset + static_cast<uint64_t>(header.frame_count) * header.frame_stride;
+    const size_t   frame_size = static_cast<size_t>(header.width) * static_cast<size_t>(header.height) * sizeof(uint32_t);
+    if (!file_seek(file, offset) ||
+        fwrite(pixel_data, 1, frame_size, file) != frame_size ||
+        fwrite(padding.data(), 1, padding.size(), file) != padding.size()) {
+        error_in_function("could not write frame ", header.frame_count);
+        return false;
+    }
+    header.frame_count++;
+    header_dirty = true; // NOTE frame count is written on `close()`
+    return true;
+}
+
+bool ImageSequenceWriter::add_frame(const PImage* image) {
+    if (image == nullptr || image->pixels == nullptr) {
+        return false;
+    }
+    if (static_cast<uint32_t>(image->width) != header.width || static_cast<uint32_t>(image->height) != header.height) {
+        error_in_function("image size does not match sequence frame size: ", image->width, "x", image->height);
+        return false;
+    }
+    return add_frame(image->pixels);
+}
+
+bool ImageSequenceWriter::add_frame(PGraphics* graphics) {
+    if (graphics == nullptr) {
+        return false;
+    }
+    const int _width  = graphics->framebuffer.width;
+    const int _height = graphics->framebuffer.height;
+    if (static_cast<uint32_t>(_width) != header.width || static_cast<uint32_t>(_height) != header.height) {
+        error_in_function("framebuffer size does not match sequence frame size: ", _width, "x", _height);
+        return false;
+    }
+
+    std::vector<unsigned char> framebuffer_pixels;
+    if (!graphics->read_framebuffer(framebuffer_pixels)) {
+        warning_in_function("could not read pixel from color buffer");
+        return false;
+    }
+
+    /* NOTE flip vertically, OpenGL's origin is bottom-left */
+    const size_t          row_size = static_cast<size_t>(_width) * DEFAULT_BYTES_PER_PIXELS;
+    std::vector<uint32_t> frame(static_cast<size_t>(_width) * static_cast<size_t>(_height));
+    for (int y = 0; y < _height; ++y) {
+        std::memcpy(&frame[static_cast<size_t>(_height - 1 - y) * _width], &framebuffer_pixels[y * row_size], row_size);
+    }
+    return add_frame(frame.data());
+}
+
+void ImageSequenceWriter::close() {
+    if (file != nullptr) {
+        if (header_dirty) {
+            write_header();
+            header_dirty = false;
+        }
+        fclose(file);
+        file = nullptr;
+    }
+}
+
+/* NOTE writers of `append_frame()` stay open until `close_all()` */
+static std::map<std::string, std::unique_ptr<ImageSequenceWriter>> shared_writers;
+
+/**
+ * returns an open writer for `filepath` that is kept across frames. the writer is reopened if the frame
+ * size changed.
+ */
+static ImageSequenceWriter* get_shared_writer(const std::string& filepath, const int width, const int height) {
+    auto& writer = shared_writers[filepath];
+    if (writer != nullptr && (writer->get_width() != width || writer->get_height() != height)) {
+        writer.reset();
+    }
+    if (writer == nullptr) {
+        writer = std::make_unique<ImageSequenceWriter>(filepath, width, height, frameRate);
+    }
+    if (!writer->is_open()) {
+        shared_writers.erase(filepath);
+        return nullptr;
+    }
+    return writer.get();
+}
+
+/**
+ * appends the current framebuffer to an image sequence file. the file is created if it does not exist.
+ */
+bool ImageSequenceWriter::append_frame(const std::string& filepath, PGraphics* graphics) {
+    if (graphics == nullptr) {
+        return false;
+    }
+    ImageSequenceWriter* writer = get_shared_writer(filepath, graphics->framebuffer.width, graphics->framebuffer.height);
+    return writer != nullptr && writer->add_frame(graphics);
+}
+
+/**
+ * appends an image to an image sequence file. the file is created if it does not exist.
+ */
+bool ImageSequenceWriter::append_frame(const std::string& filepath, const PImage* image) {
+    if (image == nullptr) {
+        return false;
+    }
+    ImageSequenceWriter* writer = get_shared_writer(filepath, static_cast<int>(image->width), static_cast<int>(image->height));
+    return writer != nullptr && writer->add_frame(image);
+}
+
+/**
+ * closes all writers opened by `append_frame()` and writes their headers. called on shutdown.
+ */
+void ImageSequenceWriter::close_all() {
+    shared_writers.clear();
+}
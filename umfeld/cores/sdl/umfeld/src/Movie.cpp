@@ -17,11 +17,16 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+
 #include "Movie.h"
+#include "YUVFrameAV.h"
 
 #include <UmfeldFunctionsAdditional.h>
 
-// TODO look into audio processing
 // TODO look into camera access
 // TODO implement `MovieListener` including callback
 
@@ -41,12 +46,38 @@ extern "C" {
 #include <libavutil/samplefmt.h>
 }
 
+namespace {
+    struct KeyframeIndexHeader {
+        static constexpr char     MAGIC[4] = {'U', 'F', 'K', 'I'};
+        static constexpr uint32_t VERSION  = 1;
+
+        char     magic[4]{MAGIC[0], MAGIC[1], MAGIC[2], MAGIC[3]};
+        uint32_t version{VERSION};
+        uint64_t file_size{0}; // NOTE file size and duration identify the movie the index belongs to
+        int64_t  duration{0};
+        uint64_t keyframe_count{0};
+    };
+
+    std::string keyframe_index_path(const std::string& movie_path) {
+        return movie_path + ".ufidx";
+    }
+
+    uint64_t get_file_size(const std::string& path) {
+        std::error_code ec;
+        const auto      size = std::filesystem::file_size(path, ec);
+        return ec ? 0 : static_cast<uint64_t>(size);
+    }
+} // namespace
+
 Movie::Movie(const std::string& filename, const int channels) {
     if (init_from_file(filename, channels) >= 0) {
         calculateFrameDuration();
-        keepRunning    = true;
-        isPlaying      = false;
-        playbackThread = std::thread(&Movie::playbackLoop, this);
+        keepRunning = true;
+        isPlaying   = false;
+        start_pipeline();
+        if (audio_output_enabled) {
+            register_audio_source(this);
+        }
     } else {
         std::cerr << "+++ Movie: ERROR: could not initialize from file" << std::endl;
     }
@@ -55,6 +86,7 @@ Movie::Movie(const std::string& filename, const int channels) {
 int Movie::init_from_file(const std::string& filename, int _channels) {
     // Open the input file
     const std::string absolute_path = resolve_data_path(filename);
+    movie_path                      = absolute_path;
     formatContext                   = avformat_alloc_context();
     if (avformat_open_input(&formatContext, absolute_path.c_str(), nullptr, nullptr) != 0) {
         error("+++ Movie: ERROR: Could not open file: ", filename);
@@ -88,8 +120,7 @@ int Movie::init_from_file(const std::string& filename, int _channels) {
     }
 
     if (audioStreamIndex == -1) {
-        std::cerr << "+++ Movie: ERROR: Could not find a video stream" << std::endl;
-        return -1;
+        console("+++ Movie: no audio stream found");
     }
 
     // Get a pointer to the codec context for the video stream
@@ -97,16 +128,46 @@ int Movie::init_from_file(const std::string& filename, int _channels) {
     const AVCodec*           codec           = avcodec_find_decoder(codecParameters->codec_id);
     videoCodecContext                        = avcodec_alloc_context3(codec);
     avcodec_parameters_to_context(videoCodecContext, codecParameters);
+    videoCodecContext->thread_count = DECODER_THREADS;
+    videoCodecContext->thread_type  = FF_THREAD_FRAME | FF_THREAD_SLICE;
     if (avcodec_open2(videoCodecContext, codec, nullptr) < 0) {
         std::cerr << "+++ Movie: ERROR: Could not open codec" << std::endl;
         return -1;
     }
 
     // Initialize audio codec
-    const AVCodec* audioCodec = avcodec_find_decoder(formatContext->streams[audioStreamIndex]->codecpar->codec_id);
-    audioCodecContext         = avcodec_alloc_context3(audioCodec);
-    avcodec_parameters_to_context(audioCodecContext, formatContext->streams[audioStreamIndex]->codecpar);
-    avcodec_open2(audioCodecContext, audioCodec, nullptr);
+    if (audioStreamIndex >= 0) {
+        const AVCodec* audioCodec = avcodec_find_decoder(formatContext->streams[audioStreamIndex]->codecpar->codec_id);
+        audioCodecContext         = avcodec_alloc_context3(audioCodec);
+        avcodec_parameters_to_context(audioCodecContext, formatContext->streams[audioStreamIndex]->codecpar);
+        if (avcodec_open2(audioCodecContext, audioCodec, nullptr) < 0) {
+            warning("+++ Movie: could not open audio codec");
+            avcodec_free_context(&audioCodecContext);
+        }
+    }
+
+    // NOTE audio is resampled to the main audio device which mixes it into its output
+    if (audioCodecContext != nullptr) {
+        if (audio_device != nullptr &&
+            audio_device->output_channels > 0 &&
+            audio_device->sample_rate > 0 &&
+            audio_device->sample_rate != DEFAULT_SAMPLE_RATE) {
+            audio_output_rate     = static_cast<int>(audio_device->sample_rate);
+            audio_output_channels = audio_device->output_channels;
+            audio_buffer_duration = static_cast<double>(audio_device->buffer_size) / audio_output_rate;
+            audio_ring.resize(static_cast<size_t>(audio_output_rate) * audio_output_channels * AUDIO_RING_SECONDS);
+            audio_mix_buffer.resize(static_cast<size_t>(AUDIO_CONVERT_SIZE) * audio_output_channels);
+            audio_output_enabled = true;
+        } else {
+            audio_output_rate = audioCodecContext->sample_rate;
+#if LIBAVUTIL_VERSION_MAJOR >= 57
+            audio_output_channels = audioCodecContext->ch_layout.nb_channels;
+#else
+            audio_output_channels = audioCodecContext->channels;
+#endif
+        }
+        audio_convert_buffer.resize(static_cast<size_t>(AUDIO_CONVERT_SIZE) * audio_output_channels);
+    }
 
     // retrieve movie framerate
     const AVRational frame_rate     = formatContext->streams[videoStreamIndex]->avg_frame_rate;
@@ -150,31 +211,39 @@ int Movie::init_from_file(const std::string& filename, int _channels) {
         return -1;
     }
 
-    // Allocate an AVFrame structure for the converted frame
-    convertedFrame = av_frame_alloc();
-    if (!convertedFrame) {
-        std::cerr << "+++ Movie: ERROR: Failed to allocate converted frame" << std::endl;
-        return -1;
+    // Allocate the ring of converted frames
+    output_pixel_format = dst_pix_fmt;
+    frame_ring.resize(FRAME_RING_SIZE);
+    for (auto& video_frame: frame_ring) {
+        if (av_image_alloc(video_frame.data,
+                           video_frame.linesize,
+                           videoCodecContext->width,
+                           videoCodecContext->height,
+                           output_pixel_format,
+                           1) < 0) {
+            std::cerr << "+++ Movie: ERROR: Failed to allocate converted frame" << std::endl;
+            return -1;
+        }
+        video_frame.yuv_frame = av_frame_alloc();
     }
-
-    const int numBytes = av_image_get_buffer_size(dst_pix_fmt,
+    // NOTE the first frame is displayed until a decoded frame is due
+    const int numBytes = av_image_get_buffer_size(output_pixel_format,
                                                   videoCodecContext->width,
                                                   videoCodecContext->height,
                                                   1);
-    buffer             = static_cast<uint8_t*>(av_malloc(numBytes * sizeof(uint8_t)));
-    av_image_fill_arrays(convertedFrame->data,
-                         convertedFrame->linesize,
-                         buffer,
-                         dst_pix_fmt,
-                         videoCodecContext->width,
-                         videoCodecContext->height,
-                         1);
-    packet = av_packet_alloc();
-
-    PImage::init(reinterpret_cast<uint32_t*>(convertedFrame->data[0]),
+    std::fill_n(frame_ring[0].data[0], numBytes, 0);
+    frame_size_bytes = numBytes;
+    displayed_frame = 0;
+    for (int i = 1; i < FRAME_RING_SIZE; i++) {
+        free_frames.push_back(i);
+    }
+
+    PImage::init(reinterpret_cast<uint32_t*>(frame_ring[displayed_frame].data[0]),
                  videoCodecContext->width,
                  videoCodecContext->height);
 
+    load_keyframe_index();
+
 #ifndef OMIT_PRINT_MOVIE_INFO
     std::cout << "+++ Movie: dimensions    : " << videoCodecContext->width << ", " << videoCodecContext->height << std::endl;
     std::cout << "+++ Movie: channels      : " << _channels << std::endl;
@@ -186,19 +255,21 @@ int Movie::init_from_file(const std::string& filename, int _channels) {
 }
 
 Movie::~Movie() {
-    keepRunning = false;
-    if (playbackThread.joinable()) {
-        playbackThread.join();
+    unregister_audio_source(this);
+    stop_pipeline();
+    for (auto& video_frame: frame_ring) {
+        av_freep(&video_frame.data[0]);
+        av_frame_free(&video_frame.yuv_frame);
     }
-    av_freep(&buffer);
+    frame_ring.clear();
+    pixels = nullptr;
     av_frame_free(&frame);
-    av_frame_free(&convertedFrame);
     avcodec_free_context(&audioCodecContext);
     avcodec_free_context(&videoCodecContext);
     avformat_close_input(&formatContext);
     avformat_free_context(formatContext);
-    av_packet_free(&packet);
     sws_freeContext(swsContext);
+    swr_free(&swrCtx);
 }
 
 void Movie::calculateFrameDuration() {
@@ -206,204 +277,466 @@ void Movie::calculateFrameDuration() {
     frameDuration               = 1.0 / (frame_rate.num / static_cast<double>(frame_rate.den));
 }
 
-void Movie::playbackLoop() {
+/* --- pipeline --- */
+
+void Movie::start_pipeline() {
+    demux_thread   = std::thread(&Movie::demux_loop, this);
+    decode_thread  = std::thread(&Movie::decode_loop, this);
+    convert_thread = std::thread(&Movie::convert_loop, this);
+    if (!keyframe_index_ready) {
+        index_thread = std::thread(&Movie::build_keyframe_index, this);
+    }
+}
+
+void Movie::stop_pipeline() {
+    keepRunning = false;
+    packet_queue.close();
+    decoded_queue.close();
+    {
+        std::lock_guard lock(frame_ring_mutex);
+    }
+    frame_ring_condition.notify_all();
+    if (demux_thread.joinable()) {
+        demux_thread.join();
+    }
+    if (decode_thread.joinable()) {
+        decode_thread.join();
+    }
+    if (convert_thread.joinable()) {
+        convert_thread.join();
+    }
+    if (index_thread.joinable()) {
+        index_thread.join();
+    }
+    packet_queue.clear([](PacketItem& item) { av_packet_free(&item.packet); });
+    decoded_queue.clear([](DecodedFrame& decoded) { av_frame_free(&decoded.frame); });
+}
+
+double Movie::to_seconds(const int64_t timestamp) const {
+    const AVStream* stream     = formatContext->streams[videoStreamIndex];
+    const int64_t   start_time = stream->start_time != AV_NOPTS_VALUE ? stream->start_time : 0;
+    return static_cast<double>(timestamp - start_time) * av_q2d(stream->time_base);
+}
+
+/**
+ * reads packets from the container. video packets are passed on to the decode thread, audio packets
+ * are decoded and written to the audio ring right away. handles seek requests and looping.
+ */
+void Movie::demux_loop() {
+    AVPacket* demux_packet = av_packet_alloc();
+    int       demux_serial = serial;
+    double    pts_offset   = 0.0; // NOTE accumulated duration of previous loops
+    double    stream_end   = 0.0;
     while (keepRunning) {
-        if (isPlaying) {
-            auto frame_start = std::chrono::steady_clock::now();
-            if (available()) {
-                if (processFrame()) {
-                    // TODO flag that a texture reload is required
-                    // TODO callback with `MovieListener`
-                    //                } else {
-                    //                    // Check if the end of the video is reached
-                    //                    bool isEndOfVideo = false;
-                    //                    if (isEndOfVideo) {
-                    //                        std::cout << "+++ end of video reached" << std::endl;
-                    //                        if (isLooping) {
-                    //                            // Seek back to the start of the video
-                    //                            av_seek_frame(formatContext, videoStream, 0, AVSEEK_FLAG_BACKWARD);
-                    //                            mFrameCounter = 0; // Reset frame counter
-                    //                        } else {
-                    //                            // Stop playback if not looping
-                    //                            pause();
-                    //                        }
-                    //                    }
-                }
+        if (seek_requested.exchange(false)) {
+            demux_serial              = serial;
+            const AVStream* stream    = formatContext->streams[videoStreamIndex];
+            const int64_t   start     = stream->start_time != AV_NOPTS_VALUE ? stream->start_time : 0;
+            const int64_t   timestamp = find_keyframe(start + static_cast<int64_t>(seek_target / av_q2d(stream->time_base)));
+            // NOTE decoding starts at the keyframe, the decode thread skips frames up to the target
+            if (av_seek_frame(formatContext, videoStreamIndex, timestamp, AVSEEK_FLAG_BACKWARD) < 0) {
+                warning_in_function("could not seek to ", seek_target.load(), " seconds");
+            }
+            if (audioCodecContext != nullptr) {
+                avcodec_flush_buffers(audioCodecContext);
             }
+            // NOTE the audio thread discards everything written so far
+            audio_flush_position = audio_ring.write_position();
+            audio_write_serial   = demux_serial;
+            pts_offset           = 0.0;
+            end_of_stream        = false;
+        }
 
-            auto                          frame_end = std::chrono::steady_clock::now();
-            std::chrono::duration<double> elapsed   = frame_end - frame_start;
+        if (end_of_stream) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            continue;
+        }
 
-            if (elapsed.count() < frameDuration) {
-                std::this_thread::sleep_for(std::chrono::duration<double>(frameDuration - elapsed.count()));
+        const int ret = av_read_frame(formatContext, demux_packet);
+        if (ret >= 0) {
+            if (demux_packet->stream_index == videoStreamIndex) {
+                if (demux_packet->pts != AV_NOPTS_VALUE) {
+                    stream_end = std::max(stream_end, to_seconds(demux_packet->pts + std::max<int64_t>(demux_packet->duration, 0)));
+                }
+                PacketItem item;
+                item.packet     = av_packet_alloc();
+                item.serial     = demux_serial;
+                item.pts_offset = pts_offset;
+                av_packet_move_ref(item.packet, demux_packet);
+                if (!packet_queue.push(item)) {
+                    av_packet_free(&item.packet);
+                }
+            } else if (demux_packet->stream_index == audioStreamIndex) {
+                decode_audio_packet(demux_packet, demux_serial, pts_offset);
             }
+            av_packet_unref(demux_packet);
+        } else if (ret == AVERROR_EOF) {
+            PacketItem drain;
+            drain.serial     = demux_serial;
+            drain.pts_offset = pts_offset;
+            packet_queue.push(drain);
+            if (isLooping) {
+                // Seek back to the start of the video
+                const AVStream* stream = formatContext->streams[videoStreamIndex];
+                av_seek_frame(formatContext, videoStreamIndex, stream->start_time != AV_NOPTS_VALUE ? stream->start_time : 0, AVSEEK_FLAG_BACKWARD);
+                // NOTE timestamps continue across loops so that the playback clock never jumps back
+                pts_offset += stream_end > 0.0 ? stream_end : duration();
+            } else {
+                end_of_stream = true;
+            }
+        } else if (ret == AVERROR(EAGAIN)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
         } else {
-            // If not playing, sleep for a short duration to prevent busy waiting
+            char err_buf[AV_ERROR_MAX_STRING_SIZE];
+            av_strerror(ret, err_buf, AV_ERROR_MAX_STRING_SIZE);
+            warning_in_function("could not read frame: ", err_buf);
             std::this_thread::sleep_for(std::chrono::milliseconds(10));
         }
     }
+    av_packet_free(&demux_packet);
 }
 
-void Movie::play() {
-    isPlaying = true;
+/**
+ * decodes video packets into frames with timestamps in seconds. the codec may use multiple threads
+ * itself ( see `DECODER_THREADS` ).
+ */
+void Movie::decode_loop() {
+    int        decoder_serial = serial;
+    double     last_pts       = 0.0;
+    PacketItem item;
+    while (keepRunning && packet_queue.pop(item)) {
+        if (item.serial != serial) {
+            av_packet_free(&item.packet);
+            continue;
+        }
+        if (item.serial != decoder_serial) {
+            avcodec_flush_buffers(videoCodecContext);
+            decoder_serial = item.serial;
+        }
+
+        // NOTE a `nullptr` packet enters draining mode and flushes out the remaining frames
+        if (avcodec_send_packet(videoCodecContext, item.packet) < 0 && item.packet != nullptr) {
+            warning_in_function("could not decode video packet");
+        }
+        AVFrame* decoded = av_frame_alloc();
+        while (avcodec_receive_frame(videoCodecContext, decoded) == 0) {
+            DecodedFrame decoded_frame;
+            decoded_frame.frame  = decoded;
+            decoded_frame.serial = item.serial;
+            if (decoded->best_effort_timestamp != AV_NOPTS_VALUE) {
+                decoded_frame.pts = to_seconds(decoded->best_effort_timestamp) + item.pts_offset;
+            } else {
+                decoded_frame.pts = last_pts + frameDuration;
+            }
+            last_pts = decoded_frame.pts;
+            // NOTE after a seek frames between the keyframe and the target are decoded but not converted
+            if (decoded_frame.pts < seek_target - frameDuration * 0.5) {
+                av_frame_unref(decoded);
+                continue;
+            }
+            if (!decoded_queue.push(decoded_frame)) {
+                av_frame_free(&decoded);
+                break;
+            }
+            decoded = av_frame_alloc();
+        }
+        av_frame_free(&decoded);
+        if (item.packet == nullptr) {
+            avcodec_flush_buffers(videoCodecContext);
+        }
+        av_packet_free(&item.packet);
+    }
 }
 
-void Movie::pause() {
-    isPlaying = false;
+/**
+ * converts decoded frames into free slots of the frame ring and marks them as ready.
+ */
+void Movie::convert_loop() {
+    DecodedFrame decoded;
+    while (keepRunning && decoded_queue.pop(decoded)) {
+        if (decoded.serial != serial) {
+            av_frame_free(&decoded.frame);
+            continue;
+        }
+        const int index = acquire_free_frame(decoded.serial);
+        if (index < 0) {
+            av_frame_free(&decoded.frame);
+            continue;
+        }
+
+        VideoFrame& video_frame = frame_ring[index];
+        av_frame_unref(video_frame.yuv_frame);
+        YUVFrame yuv;
+        if (yuv_mode && output_pixel_format == AV_PIX_FMT_RGBA && get_yuv_frame(decoded.frame, yuv)) {
+            // NOTE keep a reference to the decoded planes, they are converted on upload
+            av_frame_move_ref(video_frame.yuv_frame, decoded.frame);
+        } else {
+            sws_scale(swsContext,
+                      decoded.frame->data,
+                      decoded.frame->linesize,
+                      0,
+                      decoded.frame->height,
+                      video_frame.data,
+                      video_frame.linesize);
+        }
+        video_frame.pts    = decoded.pts;
+        video_frame.serial = decoded.serial;
+        av_frame_free(&decoded.frame);
+
+        std::lock_guard lock(frame_ring_mutex);
+        if (video_frame.serial == serial) {
+            ready_frames.push_back(index);
+        } else {
+            free_frames.push_back(index);
+        }
+    }
 }
 
-bool Movie::available() {
-    const int ret = av_read_frame(formatContext, packet);
-    if (ret >= 0) {
-        if (packet->stream_index == videoStreamIndex) {
-            mVideoFrameAvailable = true;
-            avcodec_send_packet(videoCodecContext, packet);
-        } else if (packet->stream_index == audioStreamIndex) {
-            // Decode audio frame
-            avcodec_send_packet(audioCodecContext, packet);
-            while (avcodec_receive_frame(audioCodecContext, frame) == 0) {
-                if (!swrCtx) {
-#if LIBAVUTIL_VERSION_MAJOR >= 57
-                    AVChannelLayout in_ch_layout, out_ch_layout;
-
-                    if (av_channel_layout_copy(&in_ch_layout, &audioCodecContext->ch_layout) < 0) {
-                        fprintf(stderr, "Failed to copy input channel layout\n");
-                        break;
-                    }
-
-                    av_channel_layout_default(&out_ch_layout, audioCodecContext->ch_layout.nb_channels);
-
-                    if (swr_alloc_set_opts2(
-                            &swrCtx,
-                            &out_ch_layout, AV_SAMPLE_FMT_FLT, audioCodecContext->sample_rate,
-                            &in_ch_layout, static_cast<AVSampleFormat>(frame->format), frame->sample_rate,
-                            0, NULL) < 0) {
-                        fprintf(stderr, "Failed to allocate and configure SwrContext\n");
-                        av_channel_layout_uninit(&in_ch_layout);
-                        av_channel_layout_uninit(&out_ch_layout);
-                        break;
-                    }
-
-                    if (swr_init(swrCtx) < 0) {
-                        fprintf(stderr, "Failed to initialize SwrContext\n");
-                        av_channel_layout_uninit(&in_ch_layout);
-                        av_channel_layout_uninit(&out_ch_layout);
-                        break;
-                    }
-
-                    av_channel_layout_uninit(&in_ch_layout);
-                    av_channel_layout_uninit(&out_ch_layout);
-#else
-                    uint64_t in_ch_layout  = audioCodecContext->channel_layout;
-                    uint64_t out_ch_layout = av_get_default_channel_layout(audioCodecContext->channels);
-
-                    swrCtx = swr_alloc_set_opts(
-                        NULL,
-                        out_ch_layout, AV_SAMPLE_FMT_FLT, audioCodecContext->sample_rate,
-                        in_ch_layout, (AVSampleFormat) frame->channels, frame->sample_rate,
-                        0, NULL);
-
-                    if (!swrCtx || swr_init(swrCtx) < 0) {
-                        fprintf(stderr, "Failed to initialize SwrContext\n");
-                        break;
-                    }
-#endif
-                }
+int Movie::acquire_free_frame(const int frame_serial) {
+    std::unique_lock lock(frame_ring_mutex);
+    frame_ring_condition.wait(lock, [&] { return !keepRunning || frame_serial != serial || !free_frames.empty(); });
+    if (!keepRunning || frame_serial != serial) {
+        return -1;
+    }
+    const int index = free_frames.front();
+    free_frames.pop_front();
+    return index;
+}
 
+bool Movie::init_audio_resampler(const AVFrame* audio_frame) {
 #if LIBAVUTIL_VERSION_MAJOR >= 57
-                int channels = audioCodecContext->ch_layout.nb_channels;
+    AVChannelLayout out_ch_layout;
+    av_channel_layout_default(&out_ch_layout, audio_output_channels);
+    const int result = swr_alloc_set_opts2(&swrCtx,
+                                           &out_ch_layout, AV_SAMPLE_FMT_FLT, audio_output_rate,
+                                           &audio_frame->ch_layout, static_cast<AVSampleFormat>(audio_frame->format), audio_frame->sample_rate,
+                                           0, nullptr);
+    av_channel_layout_uninit(&out_ch_layout);
+    if (result < 0) {
+        warning_in_function("could not allocate audio resampler");
+        return false;
+    }
 #else
-                int channels = audioCodecContext->channels;
+    const uint64_t in_ch_layout = audio_frame->channel_layout != 0 ? audio_frame->channel_layout : av_get_default_channel_layout(audio_frame->channels);
+    swrCtx                      = swr_alloc_set_opts(nullptr,
+                                                     av_get_default_channel_layout(audio_output_channels), AV_SAMPLE_FMT_FLT, audio_output_rate,
+                                                     in_ch_layout, static_cast<AVSampleFormat>(audio_frame->format), audio_frame->sample_rate,
+                                                     0, nullptr);
+    if (swrCtx == nullptr) {
+        warning_in_function("could not allocate audio resampler");
+        return false;
+    }
 #endif
-                int out_samples = av_rescale_rnd(
-                    swr_get_delay(swrCtx, frame->sample_rate) + frame->nb_samples,
-                    frame->sample_rate, frame->sample_rate, AV_ROUND_UP);
+    if (swr_init(swrCtx) < 0) {
+        warning_in_function("could not initialize audio resampler");
+        swr_free(&swrCtx);
+        return false;
+    }
+    return true;
+}
 
-                auto     output_buffer = static_cast<float*>(av_malloc(out_samples * channels * sizeof(float)));
-                uint8_t* out[]         = {reinterpret_cast<uint8_t*>(output_buffer)};
+/**
+ * decodes an audio packet and resamples it to the output format. the converted samples are passed on
+ * to the listener and written to the audio ring. runs in the demux thread.
+ */
+void Movie::decode_audio_packet(const AVPacket* audio_packet, const int packet_serial, const double pts_offset) {
+    if (audioCodecContext == nullptr) {
+        return;
+    }
+    avcodec_send_packet(audioCodecContext, audio_packet);
+    while (avcodec_receive_frame(audioCodecContext, frame) == 0) {
+        if (swrCtx == nullptr && !init_audio_resampler(frame)) {
+            av_frame_unref(frame);
+            break;
+        }
 
-                int samples_converted = swr_convert(
-                    swrCtx, out, out_samples,
-                    (const uint8_t**) frame->extended_data, frame->nb_samples);
+        double pts = -1.0;
+        if (frame->best_effort_timestamp != AV_NOPTS_VALUE) {
+            // NOTE audio timestamps are relative to the start of the video stream like video frames
+            const AVStream* audio_stream = formatContext->streams[audioStreamIndex];
+            const AVStream* video_stream = formatContext->streams[videoStreamIndex];
+            const int64_t   video_start  = video_stream->start_time != AV_NOPTS_VALUE ? video_stream->start_time : 0;
+            const double    audio_time   = static_cast<double>(frame->best_effort_timestamp) * av_q2d(audio_stream->time_base);
+            const double    video_time   = static_cast<double>(video_start) * av_q2d(video_stream->time_base);
+            pts                          = audio_time - video_time + pts_offset;
+        }
 
-                if (samples_converted < 0) {
-                    fprintf(stderr, "Error while converting audio\n");
-                    av_free(output_buffer);
-                    break;
-                }
+        // NOTE convert in chunks of `AUDIO_CONVERT_SIZE` frames, the resampler keeps what does not fit
+        const uint8_t** input        = const_cast<const uint8_t**>(frame->extended_data);
+        int             input_frames = frame->nb_samples;
+        while (true) {
+            uint8_t*  output[]  = {reinterpret_cast<uint8_t*>(audio_convert_buffer.data())};
+            const int converted = swr_convert(swrCtx, output, AUDIO_CONVERT_SIZE, input, input_frames);
+            if (converted < 0) {
+                warning_in_function("could not convert audio");
+                break;
+            }
+            if (converted == 0) {
+                break;
+            }
+            if (fListener) {
+                fListener->movieAudioEvent(this, audio_convert_buffer.data(), converted, audio_output_channels);
+            }
+            if (audio_output_enabled) {
+                write_audio(audio_convert_buffer.data(), converted, pts, packet_serial);
+            }
+            if (pts >= 0.0) {
+                pts += static_cast<double>(converted) / audio_output_rate;
+            }
+            if (converted < AUDIO_CONVERT_SIZE) {
+                break;
+            }
+            input        = nullptr;
+            input_frames = 0;
+        }
+        av_frame_unref(frame);
+    }
+}
 
-                // Process the float audio samples
-                // process_audio_samples(output_buffer, samples_converted, frame->ch_layout.nb_channels);
-                // std::cout << "+++ audio samples : " << samples_converted << std::endl;
-                // std::cout << "+++       channels: " << frame->channels << std::endl;
+/**
+ * writes interleaved frames to the audio ring. blocks while the ring is full i.e while the audio
+ * device has not caught up, which also throttles demuxing.
+ */
+void Movie::write_audio(const float* samples, int frames, double pts, const int packet_serial) {
+    if (packet_serial != serial || audio_muted) {
+        return;
+    }
 
-                if (fListener) {
-#if LIBAVUTIL_VERSION_MAJOR >= 57
-                    fListener->movieAudioEvent(this, output_buffer, samples_converted, frame->ch_layout.nb_channels);
-#else
-                    fListener->movieAudioEvent(this, output_buffer, samples_converted, frame->channels);
-#endif
-                }
+    // NOTE after a seek audio before the target is skipped like video frames
+    const double target = seek_target;
+    if (pts >= 0.0 && pts < target) {
+        const int skip = std::min(frames, static_cast<int>((target - pts) * audio_output_rate));
+        samples += static_cast<size_t>(skip) * audio_output_channels;
+        frames -= skip;
+        pts += static_cast<double>(skip) / audio_output_rate;
+    }
+    if (frames <= 0) {
+        return;
+    }
 
-                // Free the output buffer
-                av_free(output_buffer);
+    if (audio_base_serial != packet_serial) {
+        audio_base_pts      = pts >= 0.0 ? pts : target;
+        audio_base_position = audio_ring.write_position();
+        audio_base_serial   = packet_serial;
+    }
 
-                av_frame_unref(frame);
-            }
-        }
-        av_packet_unref(packet);
-    } else if (ret == AVERROR_EOF) {
-        //        std::cout << "AVERROR_EOF" << std::endl;
-        if (isLooping) {
-            // Seek back to the start of the video
-            av_seek_frame(formatContext, videoStreamIndex, 0, AVSEEK_FLAG_BACKWARD);
-            mFrameCounter = 0; // Reset frame counter
-        } else {
-            // Stop playback if not looping
-            pause();
+    size_t remaining = static_cast<size_t>(frames) * audio_output_channels;
+    while (remaining > 0 && keepRunning && !seek_requested && !audio_muted) {
+        const size_t written = audio_ring.write(samples, remaining);
+        samples += written;
+        remaining -= written;
+        if (remaining > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
         }
-    } else {
-        char err_buf[AV_ERROR_MAX_STRING_SIZE];
-        av_strerror(ret, err_buf, AV_ERROR_MAX_STRING_SIZE);
-        printf("Error occurred: %s\n", err_buf);
     }
-    return mVideoFrameAvailable;
 }
 
-bool Movie::processFrame() {
-    if (mVideoFrameAvailable) {
-        const int ret = avcodec_receive_frame(videoCodecContext, frame);
-        if (ret == 0) {
-            // Successfully received a frame
-            mFrameCounter++;
+/**
+ * called by the audio subsystem from the audio thread. adds the next samples from the audio ring to
+ * `output` and updates the audio clock. does not block or allocate.
+ */
+void Movie::mix_audio(float* output, const int frames, const int channels) {
+    if (!audio_output_enabled || channels != audio_output_channels) {
+        return;
+    }
 
-            // Convert data to RGBA or RGB
-            sws_scale(swsContext,
-                      frame->data,
-                      frame->linesize,
-                      0,
-                      frame->height,
-                      convertedFrame->data,
-                      convertedFrame->linesize);
+    const int write_serial = audio_write_serial;
+    if (write_serial != audio_read_serial) {
+        audio_ring.skip_to(audio_flush_position);
+        audio_read_serial = write_serial;
+    }
+    // NOTE while a seek is pending the ring still holds samples from before the seek
+    if (!isPlaying || audio_muted || write_serial != serial) {
+        return;
+    }
 
-            av_frame_unref(frame);
-            mVideoFrameAvailable = false;
-            return true;
-        } else {
-            if (ret == AVERROR_EOF) {
-                // Handle end of stream
-                std::cout << "+++ AVERROR_EOF" << std::endl;
-            } else if (ret == AVERROR(EAGAIN)) {
-                // No frame available right now, try again later
-                //                std::cout << "+++ AVERROR(EAGAIN)" << std::endl;
-            } else {
-                // std::cerr << "+++ Movie: ERROR: Error receiving frame: " << av_err2str(ret));
-            }
-            av_frame_unref(frame);
-            return false;
+    const bool     clock_running = audio_clock_serial == write_serial;
+    const uint64_t position      = audio_ring.read_position();
+    const uint64_t base_position = audio_base_position;
+    if (audio_base_serial == write_serial && position >= base_position) {
+        const int64_t now  = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        audio_clock        = audio_base_pts + static_cast<double>((position - base_position) / channels) / audio_output_rate;
+        audio_clock_time   = now;
+        audio_clock_serial = write_serial;
+    }
+
+    const float  gain      = audio_volume;
+    const size_t requested = static_cast<size_t>(frames) * channels;
+    size_t       mixed     = 0;
+    while (mixed < requested) {
+        // NOTE only read whole frames so that channels stay aligned after an underrun
+        const size_t available = audio_ring.available_read() / channels * channels;
+        const size_t count     = std::min({requested - mixed, audio_mix_buffer.size(), available});
+        if (count == 0) {
+            break;
+        }
+        audio_ring.read(audio_mix_buffer.data(), count);
+        for (size_t i = 0; i < count; i++) {
+            output[mixed + i] += audio_mix_buffer[i] * gain;
         }
+        mixed += count;
     }
-    return false;
+    if (mixed < requested && clock_running && !end_of_stream) {
+        audio_underruns++;
+    }
+}
+
+/**
+ * returns the time of the sample currently played by the audio device. the clock is extrapolated
+ * between audio callbacks by at most one buffer.
+ */
+bool Movie::read_audio_clock(double& clock) const {
+    if (!audio_output_enabled || audio_muted || audio_clock_serial != serial) {
+        return false;
+    }
+    if (end_of_stream && audio_ring.available_read() == 0) {
+        return false;
+    }
+    const int64_t now     = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    const double  elapsed = static_cast<double>(now - audio_clock_time) * 1e-9;
+    clock                 = audio_clock + std::clamp(elapsed, 0.0, audio_buffer_duration);
+    return true;
+}
+
+/* --- playback --- */
+
+/**
+ * returns the current playback time. while audio is playing the clock follows the audio device,
+ * otherwise it follows the system clock.
+ */
+double Movie::playback_clock() const {
+    if (!isPlaying) {
+        return clock_base_pts;
+    }
+    double clock;
+    if (read_audio_clock(clock)) {
+        return clock;
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - clock_base_time;
+    return clock_base_pts + elapsed.count() * playback_speed;
+}
+
+void Movie::play() {
+    if (!isPlaying) {
+        clock_base_time = std::chrono::steady_clock::now();
+        isPlaying       = true;
+    }
+}
+
+void Movie::pause() {
+    clock_base_pts = playback_clock();
+    isPlaying      = false;
+}
+
+/**
+ * returns true if a frame is due at the current playback time.
+ */
+bool Movie::available() {
+    std::lock_guard lock(frame_ring_mutex);
+    if (ready_frames.empty()) {
+        return false;
+    }
+    return frame_ring[ready_frames.front()].pts <= playback_clock();
 }
 
 void Movie::reload(PGraphics* graphics) {
@@ -411,34 +744,109 @@ void Movie::reload(PGraphics* graphics) {
         return;
     }
 
-    if (convertedFrame == nullptr) {
+    if (pixels == nullptr) {
         return;
     }
 
-    pixels = reinterpret_cast<uint32_t*>(convertedFrame->data[0]);
+    // NOTE `pixels` points either into the frame ring or into the frame cache
+    if (!frame_ring.empty() && pixels == reinterpret_cast<uint32_t*>(frame_ring[displayed_frame].data[0])) {
+        upload_video_frame(graphics, frame_ring[displayed_frame]);
+        return;
+    }
     update_full_internal(graphics);
 }
 
 void Movie::set_listener(MovieListener* listener) { fListener = listener; }
 
+/**
+ * uploads the most recent frame that is due at the current playback time. frames that were due but
+ * superseded by a newer frame are dropped. returns false without blocking if no new frame is due.
+ */
 bool Movie::read(PGraphics* graphics) {
     if (graphics == nullptr) {
         return false;
     }
 
-    if (convertedFrame == nullptr) {
+    if (frame_ring.empty()) {
         return false;
     }
 
-    if (!processFrame()) {
-        return false; // No frame available or error processing frame
+    double clock = playback_clock();
+    if (playback_speed < 0.0f) {
+        if (clock < 0.0) {
+            const float movie_duration = duration();
+            if (isLooping && movie_duration > 0.0f) {
+                clock_base_pts += movie_duration;
+            } else {
+                clock_base_pts  = 0.0;
+                clock_base_time = std::chrono::steady_clock::now();
+            }
+            clock = playback_clock();
+        }
+        return read_reverse(graphics, clock);
     }
 
-    pixels = reinterpret_cast<uint32_t*>(convertedFrame->data[0]);
-    update_full_internal(graphics);
+    int next_frame = -1;
+    {
+        std::lock_guard lock(frame_ring_mutex);
+        while (!ready_frames.empty() && frame_ring[ready_frames.front()].pts <= clock) {
+            if (next_frame >= 0) {
+                free_frames.push_back(next_frame);
+                dropped_frames++;
+            }
+            next_frame = ready_frames.front();
+            ready_frames.pop_front();
+        }
+        if (next_frame >= 0) {
+            free_frames.push_back(displayed_frame);
+            displayed_frame = next_frame;
+        }
+    }
+
+    if (next_frame < 0) {
+        // NOTE e.g right after a jump the frame might still be in the cache
+        const int cache_index = find_cached_frame(clock);
+        if (cache_index >= 0 && std::abs(frame_cache[cache_index].pts - current_pts) >= frameDuration * 0.5) {
+            show_cached_frame(graphics, cache_index);
+            return true;
+        }
+        return false; // No frame due yet
+    }
+    frame_ring_condition.notify_all();
+
+    const VideoFrame& video_frame = frame_ring[displayed_frame];
+    cache_frame(video_frame);
+    if (clock - video_frame.pts > frameDuration) {
+        late_frames++;
+    }
+    current_pts = video_frame.pts;
+    mFrameCounter++;
+
+    upload_video_frame(graphics, video_frame);
     return true;
 }
 
+void Movie::upload_video_frame(PGraphics* graphics, const VideoFrame& video_frame) {
+    pixels = reinterpret_cast<uint32_t*>(video_frame.data[0]);
+    YUVFrame yuv;
+    if (get_yuv_frame(video_frame.yuv_frame, yuv)) {
+        if (graphics->upload_texture_yuv(this, yuv)) {
+            return;
+        }
+        // NOTE renderer can not convert YUV planes, convert on the CPU instead
+        yuv_to_rgba(yuv, pixels);
+    }
+    update_full_internal(graphics);
+}
+
+void Movie::set_yuv_mode(const bool enable) {
+    if (enable && output_pixel_format != AV_PIX_FMT_RGBA) {
+        warning_in_function("YUV mode requires RGBA output");
+        return;
+    }
+    yuv_mode = enable;
+}
+
 // Example of frameRate() method
 float Movie::frameRate() const {
     if (formatContext == nullptr) {
@@ -449,10 +857,36 @@ float Movie::frameRate() const {
     return static_cast<float>(frame_rate.num) / static_cast<float>(frame_rate.den);
 }
 
-// Example of setting playback speed
+/**
+ * sets the playback speed. negative values play the movie in reverse.
+ */
 void Movie::speed(const float factor) {
-    //    std::lock_guard<std::mutex> lock(mutex);
-    frameDuration /= factor; // Adjust frame duration based on speed factor
+    if (factor == 0.0f) {
+        warning_in_function("speed must not be 0, use `pause()` instead");
+        return;
+    }
+    const bool was_reverse   = playback_speed < 0.0f;
+    const bool reverse       = factor < 0.0f;
+    const bool was_muted     = audio_muted;
+    clock_base_pts           = playback_clock();
+    clock_base_time          = std::chrono::steady_clock::now();
+    playback_speed           = factor;
+    audio_muted              = factor != 1.0f;
+    const bool audio_changed = audio_output_enabled && was_muted != audio_muted;
+    if (reverse && !was_reverse) {
+        // NOTE the clock keeps running across loops in forward playback
+        const float movie_duration = duration();
+        if (movie_duration > 0.0f) {
+            clock_base_pts = std::fmod(clock_base_pts, static_cast<double>(movie_duration));
+        }
+        frame_cache_capacity = std::max(frame_cache_capacity, REVERSE_CACHE_SIZE);
+        reverse_fill_start   = -1.0;
+        reverse_fill_end     = -1.0;
+        reverse_fill_done    = true;
+    } else if (!reverse && (was_reverse || audio_changed)) {
+        // NOTE also restarts audio at the current time when it is muted or unmuted
+        request_seek(clock_base_pts);
+    }
 }
 
 float Movie::duration() const {
@@ -463,19 +897,307 @@ float Movie::duration() const {
     return static_cast<float>(formatContext->duration) / AV_TIME_BASE;
 }
 
-void Movie::jump(const float seconds) const {
+/**
+ * seeks to the given time. the pipeline is flushed and frames before the target time are decoded but
+ * skipped, so the next frame returned by `read()` is the one at ( or right after ) `seconds`.
+ */
+void Movie::jump(const float seconds) {
     if (formatContext == nullptr) {
         return;
     }
 
-    const int64_t timestamp = static_cast<int64_t>(seconds) * AV_TIME_BASE;
-    av_seek_frame(formatContext, videoStreamIndex, timestamp, AVSEEK_FLAG_ANY);
-    // Reset any buffers or states as needed
+    const double target = std::max(0.0, static_cast<double>(seconds));
+    if (playback_speed < 0.0f) {
+        // NOTE in reverse playback `read()` requests the range of frames around the new time
+        reverse_fill_start = -1.0;
+        reverse_fill_end   = -1.0;
+        reverse_fill_done  = true;
+    } else {
+        request_seek(target);
+    }
+    clock_base_pts  = target;
+    clock_base_time = std::chrono::steady_clock::now();
+}
+
+/**
+ * flushes the pipeline and lets the demux thread seek to `seconds`.
+ */
+void Movie::request_seek(const double seconds) {
+    {
+        std::lock_guard lock(frame_ring_mutex);
+        ++serial;
+        seek_target = seconds;
+        for (const int index: ready_frames) {
+            free_frames.push_back(index);
+        }
+        ready_frames.clear();
+    }
+    packet_queue.clear([](PacketItem& item) { av_packet_free(&item.packet); });
+    decoded_queue.clear([](DecodedFrame& decoded) { av_frame_free(&decoded.frame); });
+    seek_requested = true;
+    frame_ring_condition.notify_all();
+}
+
+/* --- reverse playback + frame cache --- */
+
+/**
+ * moves the frames of the current fill range from the ring into the frame cache and shows the cached
+ * frame at `clock`. if the frame is not cached a new range ending at `clock` is requested.
+ */
+bool Movie::read_reverse(PGraphics* graphics, const double clock) {
+    while (true) {
+        int index;
+        {
+            std::lock_guard lock(frame_ring_mutex);
+            if (ready_frames.empty()) {
+                break;
+            }
+            index = ready_frames.front();
+            if (frame_ring[index].pts > reverse_fill_end + frameDuration * 0.5) {
+                // NOTE leaving the frame in the ring stalls the pipeline until the next request
+                reverse_fill_done = true;
+                break;
+            }
+            ready_frames.pop_front();
+        }
+        cache_frame(frame_ring[index]);
+        if (frame_ring[index].pts >= reverse_fill_end - frameDuration * 0.5) {
+            reverse_fill_done = true;
+        }
+        {
+            std::lock_guard lock(frame_ring_mutex);
+            free_frames.push_back(index);
+        }
+        frame_ring_condition.notify_all();
+    }
+    if (end_of_stream) {
+        reverse_fill_done = true;
+    }
+
+    const int cache_index = find_cached_frame(clock);
+    if (cache_index >= 0) {
+        const CachedFrame& cached_frame = frame_cache[cache_index];
+        if (pixels == reinterpret_cast<const uint32_t*>(cached_frame.pixel_data.data())) {
+            return false; // NOTE frame is already shown
+        }
+        show_cached_frame(graphics, cache_index);
+        return true;
+    }
+
+    const bool in_fill_range = clock >= reverse_fill_start - frameDuration &&
+                               clock <= reverse_fill_end + frameDuration;
+    if (!in_fill_range || reverse_fill_done) {
+        request_reverse_fill(clock);
+    }
+    return false;
+}
+
+void Movie::request_reverse_fill(const double clock) {
+    reverse_fill_end   = clock;
+    reverse_fill_start = std::max(0.0, clock - (frame_cache_capacity - 1) * frameDuration);
+    reverse_fill_done  = false;
+    request_seek(reverse_fill_start);
+}
+
+void Movie::set_frame_cache_size(const int frames) {
+    frame_cache_capacity = std::max(0, frames);
+    while (static_cast<int>(frame_cache.size()) > frame_cache_capacity) {
+        auto oldest = frame_cache.end();
+        for (auto it = frame_cache.begin(); it != frame_cache.end(); ++it) {
+            const bool is_shown = pixels == reinterpret_cast<const uint32_t*>(it->pixel_data.data());
+            if (!is_shown && (oldest == frame_cache.end() || it->last_used < oldest->last_used)) {
+                oldest = it;
+            }
+        }
+        if (oldest == frame_cache.end()) {
+            break;
+        }
+        frame_cache.erase(oldest);
+    }
+}
+
+/**
+ * copies a converted frame into the cache. the least recently used frame is replaced if the cache is
+ * full, the frame that is currently shown is never replaced.
+ */
+void Movie::cache_frame(const VideoFrame& video_frame) {
+    if (frame_cache_capacity <= 0 || frame_size_bytes <= 0) {
+        return;
+    }
+    for (auto& cached_frame: frame_cache) {
+        if (std::abs(cached_frame.pts - video_frame.pts) < frameDuration * 0.5) {
+            cached_frame.last_used = ++frame_cache_tick;
+            return;
+        }
+    }
+
+    CachedFrame* slot = nullptr;
+    if (static_cast<int>(frame_cache.size()) < frame_cache_capacity) {
+        frame_cache.emplace_back();
+        slot = &frame_cache.back();
+        slot->pixel_data.resize(frame_size_bytes);
+    } else {
+        for (auto& cached_frame: frame_cache) {
+            const bool is_shown = pixels == reinterpret_cast<const uint32_t*>(cached_frame.pixel_data.data());
+            if (!is_shown && (slot == nullptr || cached_frame.last_used < slot->last_used)) {
+                slot = &cached_frame;
+            }
+        }
+    }
+    if (slot == nullptr) {
+        return;
+    }
+    slot->pts       = video_frame.pts;
+    slot->last_used = ++frame_cache_tick;
+    YUVFrame yuv;
+    if (get_yuv_frame(video_frame.yuv_frame, yuv)) {
+        yuv_to_rgba(yuv, reinterpret_cast<uint32_t*>(slot->pixel_data.data()));
+    } else {
+        std::copy_n(video_frame.data[0], frame_size_bytes, slot->pixel_data.data());
+    }
+}
+
+/**
+ * returns the index of the cached frame that is shown at `clock` or -1.
+ */
+int Movie::find_cached_frame(const double clock) const {
+    int    found     = -1;
+    double found_pts = 0.0;
+    for (int i = 0; i < static_cast<int>(frame_cache.size()); i++) {
+        const double pts = frame_cache[i].pts;
+        if (pts <= clock + frameDuration * 0.5 &&
+            clock - pts < frameDuration * 1.5 &&
+            (found < 0 || pts > found_pts)) {
+            found     = i;
+            found_pts = pts;
+        }
+    }
+    return found;
+}
+
+void Movie::show_cached_frame(PGraphics* graphics, const int cache_index) {
+    CachedFrame& cached_frame = frame_cache[cache_index];
+    cached_frame.last_used    = ++frame_cache_tick;
+    current_pts               = cached_frame.pts;
+    mFrameCounter++;
+    pixels = reinterpret_cast<uint32_t*>(cached_frame.pixel_data.data());
+    update_full_internal(graphics);
+}
+
+/* --- keyframe index --- */
+
+/**
+ * scans the packets of the video stream with a separate demuxer and collects the timestamps of all
+ * keyframes. runs in the background on first open, the result is cached next to the movie file.
+ */
+void Movie::build_keyframe_index() {
+    AVFormatContext* index_context = nullptr;
+    if (avformat_open_input(&index_context, movie_path.c_str(), nullptr, nullptr) != 0) {
+        warning_in_function("could not open file for keyframe index: ", movie_path);
+        return;
+    }
+    if (avformat_find_stream_info(index_context, nullptr) < 0) {
+        avformat_close_input(&index_context);
+        return;
+    }
+    // NOTE packets are read but never decoded
+    for (unsigned int i = 0; i < index_context->nb_streams; i++) {
+        if (static_cast<int>(i) != videoStreamIndex) {
+            index_context->streams[i]->discard = AVDISCARD_ALL;
+        }
+    }
+
+    std::vector<int64_t> keyframes;
+    AVPacket*            index_packet = av_packet_alloc();
+    while (keepRunning && av_read_frame(index_context, index_packet) >= 0) {
+        if (index_packet->stream_index == videoStreamIndex && (index_packet->flags & AV_PKT_FLAG_KEY)) {
+            const int64_t timestamp = index_packet->pts != AV_NOPTS_VALUE ? index_packet->pts : index_packet->dts;
+            if (timestamp != AV_NOPTS_VALUE) {
+                keyframes.push_back(timestamp);
+            }
+        }
+        av_packet_unref(index_packet);
+    }
+    av_packet_free(&index_packet);
+    avformat_close_input(&index_context);
+    if (!keepRunning || keyframes.empty()) {
+        return;
+    }
+
+    std::sort(keyframes.begin(), keyframes.end());
+    keyframes.erase(std::unique(keyframes.begin(), keyframes.end()), keyframes.end());
+    save_keyframe_index(keyframes);
+    {
+        std::lock_guard lock(keyframe_index_mutex);
+        keyframe_index.swap(keyframes);
+    }
+    keyframe_index_ready = true;
+}
+
+bool Movie::load_keyframe_index() {
+    FILE* file = fopen(keyframe_index_path(movie_path).c_str(), "rb");
+    if (file == nullptr) {
+        return false;
+    }
+    KeyframeIndexHeader header;
+    const bool          header_valid = fread(&header, sizeof(header), 1, file) == 1 &&
+                                       std::equal(header.magic, header.magic + 4, KeyframeIndexHeader::MAGIC) &&
+                                       header.version == KeyframeIndexHeader::VERSION &&
+                                       header.file_size == get_file_size(movie_path) &&
+                                       header.duration == formatContext->duration &&
+                                       header.keyframe_count > 0;
+    if (!header_valid) {
+        fclose(file);
+        return false;
+    }
+    std::vector<int64_t> keyframes(header.keyframe_count);
+    const bool           data_valid = fread(keyframes.data(), sizeof(int64_t), keyframes.size(), file) == keyframes.size();
+    fclose(file);
+    if (!data_valid) {
+        return false;
+    }
+    {
+        std::lock_guard lock(keyframe_index_mutex);
+        keyframe_index.swap(keyframes);
+    }
+    keyframe_index_ready = true;
+    return true;
+}
+
+void Movie::save_keyframe_index(const std::vector<int64_t>& keyframes) const {
+    const std::string path = keyframe_index_path(movie_path);
+    FILE*             file = fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        warning_in_function("could not write keyframe index: ", path);
+        return;
+    }
+    KeyframeIndexHeader header;
+    header.file_size      = get_file_size(movie_path);
+    header.duration       = formatContext->duration;
+    header.keyframe_count = keyframes.size();
+    fwrite(&header, sizeof(header), 1, file);
+    fwrite(keyframes.data(), sizeof(int64_t), keyframes.size(), file);
+    fclose(file);
+}
+
+/**
+ * returns the timestamp of the last keyframe at or before `timestamp`. without an index `timestamp`
+ * is returned unchanged.
+ */
+int64_t Movie::find_keyframe(const int64_t timestamp) {
+    std::lock_guard lock(keyframe_index_mutex);
+    if (keyframe_index.empty()) {
+        return timestamp;
+    }
+    const auto it = std::upper_bound(keyframe_index.begin(), keyframe_index.end(), timestamp);
+    if (it == keyframe_index.begin()) {
+        return keyframe_index.front();
+    }
+    return *std::prev(it);
 }
 
 float Movie::time() const {
-    //    std::lock_guard<std::mutex> lock(mutex);
-    return static_cast<float>(mFrameCounter) / frameRate();
+    return static_cast<float>(current_pts);
 }
 
 void Movie::loop() {
@@ -494,18 +1216,28 @@ Movie::~Movie() {}
 
 bool Movie::available() { return false; }
 
-bool read(PGraphics* graphics = g) { return false; }
+bool Movie::read(PGraphics* graphics) { return false; }
 
 int Movie::init_from_file(const std::string& filename, int _channels) { return -1; }
 
-void Movie::playbackLoop() {}
-
 void Movie::calculateFrameDuration() {}
 
+double Movie::playback_clock() const { return 0.0; }
+
+void Movie::start_pipeline() {}
+
+void Movie::stop_pipeline() {}
+
 void Movie::play() {}
 
 void Movie::pause() {}
 
-bool Movie::processFrame() { return false; }
+void Movie::jump(float seconds) {}
+
+void Movie::set_frame_cache_size(int frames) {}
+
+void Movie::set_yuv_mode(bool enable) {}
+
+void Movie::mix_audio(float* output, int frames, int channels) {}
 
-#endif // DISABLE_GRAPHICS && DISABLE_VIDEO
\ No newline at end of file
+#endif // DISABLE_GRAPHICS && DISABLE_VIDEO
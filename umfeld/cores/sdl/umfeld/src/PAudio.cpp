@@ -17,11 +17,21 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <atomic>
+#include <chrono>
+#include <thread>
+
 #include "Umfeld.h"
 #include "PAudio.h"
 
 using namespace umfeld;
 
+namespace {
+    std::atomic<AudioSource*> audio_sources[MAX_AUDIO_SOURCES]{};
+    // NOTE odd while the audio thread is mixing, used by `unregister_audio_source()` to wait for it
+    std::atomic<uint32_t> audio_sources_mix_count{0};
+} // namespace
+
 PAudio::PAudio(const AudioUnitInfo* device_info) : AudioUnitInfo(*device_info) {}
 
 void umfeld::merge_interleaved_stereo(const float* left, const float* right, float* interleaved, const size_t frames) {
@@ -75,4 +85,61 @@ void PAudio::acquire_audio_buffer_per_sample(const PAudio* audio_device) {
     } else {
         warning_in_function("currently only stereo output (2 channels) is supported");
     }
-}
\ No newline at end of file
+}
+
+/* --- audio sources --- */
+
+bool umfeld::register_audio_source(AudioSource* source) {
+    if (source == nullptr) {
+        return false;
+    }
+    for (auto& slot: audio_sources) {
+        AudioSource* expected = nullptr;
+        if (slot.compare_exchange_strong(expected, source)) {
+            return true;
+        }
+    }
+    warning_in_function("too many audio sources ( max ", MAX_AUDIO_SOURCES, " )");
+    return false;
+}
+
+void umfeld::unregister_audio_source(AudioSource* source) {
+    if (source == nullptr) {
+        return;
+    }
+    bool removed = false;
+    for (auto& slot: audio_sources) {
+        AudioSource* expected = source;
+        if (slot.compare_exchange_strong(expected, nullptr)) {
+            removed = true;
+        }
+    }
+    if (!removed) {
+        return;
+    }
+    // NOTE if a mix is in progress it might still use the source, wait until it is done
+    const uint32_t count = audio_sources_mix_count.load();
+    if (count & 1) {
+        while (audio_sources_mix_count.load() == count) {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    }
+}
+
+/**
+ * mixes all registered audio sources into the output buffer. called by the audio subsystem from the
+ * audio thread.
+ */
+void umfeld::mix_audio_sources(const PAudio* audio) {
+    if (audio == nullptr || audio->output_buffer == nullptr || audio->output_channels <= 0) {
+        return;
+    }
+    audio_sources_mix_count.fetch_add(1);
+    for (auto& slot: audio_sources) {
+        AudioSource* source = slot.load();
+        if (source != nullptr) {
+            source->mix_audio(audio->output_buffer, static_cast<int>(audio->buffer_size), audio->output_channels);
+        }
+    }
+    audio_sources_mix_count.fetch_add(1);
+}
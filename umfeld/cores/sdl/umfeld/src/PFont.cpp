@@ -17,8 +17,12 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <glm/gtc/matrix_transform.hpp>
+
 #include "Umfeld.h"
 #include "PFont.h"
+#include "PGraphics.h"
+#include "VertexBuffer.h"
 
 using namespace umfeld;
 
@@ -41,7 +45,6 @@ PFont::PFont(const uint8_t* data,
         return;
     }
 
-    const std::string character_atlas = character_atlas_default;
     (void) pixelDensity; // TODO implement pixel density
 
     // init freetype + structs exactly like the file ctor
@@ -49,7 +52,8 @@ PFont::PFont(const uint8_t* data,
 
     font = new FontData();
     font->bytes.assign(data, data + size); // keep alive for FT_New_Memory_Face
-    font->buffer = hb_buffer_create();
+    font->buffer   = hb_buffer_create();
+    font->language = hb_language_from_string("en", 2);
 
     if(FT_New_Memory_Face(freetype,
                           font->bytes.data(),
@@ -63,24 +67,18 @@ PFont::PFont(const uint8_t* data,
     FT_Set_Pixel_Sizes(font->face, 0, (FT_UInt)font_size);
     font->hb_font = hb_ft_font_create(font->face, nullptr);
 
-    // build atlas exactly like the file ctor
-    create_font_atlas(*font, character_atlas);
-
-    // NOTE: tex creation stays in PGraphics, just like the file ctor
-    width  = static_cast<float>(font->atlas_width);
-    height = static_cast<float>(font->atlas_height);
-    pixels = new uint32_t[static_cast<int>(width * height)];
-    set_auto_generate_mipmap(true);
-    copy_atlas_to_rgba(*font, reinterpret_cast<unsigned char*>(pixels));
+    // init metrics and atlas exactly like the file ctor
+    init_font_metrics(*font);
+    init_atlas();
 
-    console(format_label("PFont"), "atlas created (memory)");
-    console(format_label("PFont atlas size"), width, "×", height, " px");
+    console(format_label("PFont"), "font loaded (memory)");
+    console(format_label("PFont atlas page size"), width, "×", height, " px");
     textSize(font_size);
     textLeading(font_size * 1.2f);
 
 #ifdef PFONT_DEBUG_FONT
-    DEBUG_save_font_atlas(*font, std::string("<memory>") + "--font_atlas.png");
-    DEBUG_save_text(*font, "AVTAWaToVAWeYoyo Hamburgefonts", std::string("<memory>") + "--text.png");
+    DEBUG_save_text("AVTAWaToVAWeYoyo Hamburgefonts", std::string("<memory>") + "--text.png");
+    DEBUG_save_font_atlas(std::string("<memory>") + "--font_atlas");
 #endif
 }
 
@@ -92,40 +90,41 @@ PFont::PFont(const std::string& filepath,
         return;
     }
 
-    const std::string character_atlas = character_atlas_default;
     (void) pixelDensity; // TODO implement pixel density
 
     /* init freetype and font struct */
     const char* filepath_c = filepath.c_str();
     FT_Init_FreeType(&freetype);
-    font         = new FontData();
-    font->buffer = hb_buffer_create();
+    font           = new FontData();
+    font->buffer   = hb_buffer_create();
+    font->language = hb_language_from_string("en", 2);
     FT_New_Face(freetype, filepath_c, 0, &font->face);
     FT_Set_Pixel_Sizes(font->face, 0, font_size);
     font->hb_font = hb_ft_font_create(font->face, nullptr);
 
-    create_font_atlas(*font, character_atlas);
+    init_font_metrics(*font);
 
     // TODO see if pixel density needs to or should be respected in the atlas
 
     // tex_id = create_font_texture(*font); // NOTE this is done in PGraphics
-    width  = static_cast<float>(font->atlas_width);
-    height = static_cast<float>(font->atlas_height);
-    pixels = new uint32_t[static_cast<int>(width * height)];
-    set_auto_generate_mipmap(true); // NOTE set mipmap generation to true by default
-    copy_atlas_to_rgba(*font, reinterpret_cast<unsigned char*>(pixels));
+    init_atlas();
 
-    console(format_label("PFont"), "atlas created");
-    console(format_label("PFont atlas size"), width, "×", height, " px");
+    console(format_label("PFont"), "font loaded");
+    console(format_label("PFont atlas page size"), width, "×", height, " px");
     textSize(font_size);
     textLeading(font_size * 1.2f);
 #ifdef PFONT_DEBUG_FONT
-    DEBUG_save_font_atlas(*font, font_filepath + "--font_atlas.png");
-    DEBUG_save_text(*font, "AVTAWaToVAWeYoyo Hamburgefonts", font_filepath + "--text.png");
+    DEBUG_save_text("AVTAWaToVAWeYoyo Hamburgefonts", filepath + "--text.png");
+    DEBUG_save_font_atlas(filepath + "--font_atlas");
 #endif //PFONT_DEBUG_FONT
 }
 
 PFont::~PFont() {
+    clear_outline_cache();
+    // NOTE the first page is the font image itself, its pixels are freed by `PImage`
+    for (size_t i = 1; i < atlas_pages.size(); ++i) {
+        delete atlas_pages[i].image;
+    }
     if (font) {
         if (font->hb_font) {
             hb_font_destroy(font->hb_font);
@@ -137,69 +136,201 @@ PFont::~PFont() {
             FT_Done_Face(font->face);
         }
         delete font;
-
-        hb_buffer_destroy(font->buffer);
-        // hb_font_destroy(font->hb_font);
-        // FT_Done_Face(font->face);
-        // delete font;
+    }
+    if (freetype) {
         FT_Done_FreeType(freetype);
-        delete pixels;
     }
 }
 
+/**
+ * appends the outlines of all glyphs in `text` scaled to the current text size. curves are flattened
+ * adaptively to `outline_tolerance` and cached per glyph.
+ */
 void PFont::outline(const std::string& text, std::vector<std::vector<glm::vec2>>& outlines) const {
-    if (font == nullptr) {
+    if (font == nullptr || font_size == 0) {
         return;
     }
 
-    hb_buffer_clear_contents(font->buffer);
-    hb_buffer_add_utf8(font->buffer, text.c_str(), -1, 0, -1);
-    hb_buffer_guess_segment_properties(font->buffer);
-    hb_shape(font->hb_font, font->buffer, nullptr, 0);
+    const float                 text_scale = text_size / font_size;
+    std::vector<GlyphPlacement> placements;
+    layout_glyphs(text, placements);
+    for (const auto& placement: placements) {
+        const GlyphMesh* mesh = get_glyph_mesh(placement.glyph_id);
+        if (mesh == nullptr) {
+            continue;
+        }
+        for (const auto& contour: mesh->contours) {
+            auto& transformed = outlines.emplace_back();
+            transformed.reserve(contour.size());
+            for (const auto& p: contour) {
+                transformed.push_back((p + placement.position) * text_scale);
+            }
+        }
+    }
+}
+
+/**
+ * appends the filled glyphs of `text` as triangles scaled to the current text size. each glyph is
+ * tessellated only once.
+ */
+void PFont::triangulate(const std::string& text, std::vector<glm::vec2>& triangles) const {
+    if (font == nullptr || font_size == 0) {
+        return;
+    }
 
-    unsigned int           glyph_count;
-    const hb_glyph_info_t* glyph_info = hb_buffer_get_glyph_infos(font->buffer, &glyph_count);
+    const float                 text_scale = text_size / font_size;
+    std::vector<GlyphPlacement> placements;
+    layout_glyphs(text, placements);
+    for (const auto& placement: placements) {
+        const GlyphMesh* mesh = get_glyph_mesh(placement.glyph_id);
+        if (mesh == nullptr) {
+            continue;
+        }
+        for (const auto& p: mesh->triangles) {
+            triangles.push_back((p + placement.position) * text_scale);
+        }
+    }
+}
 
-    constexpr FT_Outline_Funcs funcs{
-        move_to_callback,
-        line_to_callback,
-        conic_to_callback,
-        cubic_to_callback,
-        0, 0};
+/**
+ * pen positions of the shaped glyphs of a single line of `text` in font pixels. together with
+ * `get_glyph_mesh()` this allows to draw text as instanced meshes per glyph id.
+ */
+void PFont::layout_glyphs(const std::string& text, std::vector<GlyphPlacement>& placements) const {
+    placements.clear();
+    if (font == nullptr) {
+        return;
+    }
 
-    float pen_x = 0;
-    float pen_y = 0;
+    const ShapedText& shaped = get_shaped_text(text);
+    placements.reserve(shaped.glyphs.size());
+    int pen_x = 0;
+    int pen_y = 0;
+    for (const auto& glyph: shaped.glyphs) {
+        placements.push_back({glyph.glyph_id,
+                              glm::vec2(static_cast<float>(pen_x + glyph.x_offset) / 64.0f,
+                                        -static_cast<float>(pen_y + glyph.y_offset) / 64.0f)});
+        pen_x += glyph.x_advance;
+        pen_y += glyph.y_advance;
+    }
+}
 
-    const auto* pos = hb_buffer_get_glyph_positions(font->buffer, nullptr);
+/**
+ * returns the cached outline and triangles of a glyph. on first request the outline is decomposed,
+ * flattened and tessellated. returns `nullptr` if the font is not loaded.
+ */
+const PFont::GlyphMesh* PFont::get_glyph_mesh(const uint32_t glyph_id) const {
+    if (font == nullptr || font->face == nullptr) {
+        return nullptr;
+    }
 
-    for (unsigned int i = 0; i < glyph_count; ++i) {
-        const FT_UInt glyph_index = glyph_info[i].codepoint;
-        FT_Load_Glyph(font->face, glyph_index, FT_LOAD_NO_BITMAP | FT_LOAD_NO_HINTING);
-        if (font->face->glyph->format == FT_GLYPH_FORMAT_OUTLINE) {
-            const float    text_scale = text_size / font_size;
-            OutlineContext ctx(outlines, text_scale);
+    const auto it = outline_cache.find(glyph_id);
+    if (it != outline_cache.end()) {
+        return &it->second;
+    }
 
-            // offset pen position before decomposition
-            FT_Outline* outline = &font->face->glyph->outline;
+    GlyphMesh mesh;
+    if (FT_Load_Glyph(font->face, glyph_id, FT_LOAD_NO_BITMAP | FT_LOAD_NO_HINTING) == 0 &&
+        font->face->glyph->format == FT_GLYPH_FORMAT_OUTLINE) {
+        constexpr FT_Outline_Funcs funcs{
+            move_to_callback,
+            line_to_callback,
+            conic_to_callback,
+            cubic_to_callback,
+            0, 0};
+        OutlineContext ctx(mesh.contours, outline_tolerance);
+        FT_Outline_Decompose(&font->face->glyph->outline, &funcs, &ctx);
+
+        // NOTE glyphs use non-zero winding, overlapping contours of variable fonts are filled
+        if (outline_triangulator == nullptr) {
+            outline_triangulator = std::make_unique<Triangulator>();
+        }
+        mesh.triangles = outline_triangulator->triangulate(mesh.contours, Triangulator::WINDING_NONZERO);
+    }
+    return &outline_cache.emplace(glyph_id, std::move(mesh)).first->second;
+}
 
-            // move all outline points manually before decomposing
-            for (int j = 0; j < outline->n_points; ++j) {
-                outline->points[j].x += pen_x;
-                outline->points[j].y += pen_y;
-            }
+/**
+ * maximum distance in font pixels between a curve and its flattened outline. smaller values produce
+ * smoother curves with more vertices.
+ */
+void PFont::set_outline_tolerance(const float tolerance) {
+    outline_tolerance = std::max(tolerance, 0.01f);
+    clear_outline_cache();
+}
 
-            FT_Outline_Decompose(outline, &funcs, &ctx);
+void PFont::clear_outline_cache() {
+    outline_cache.clear();
+    for (const auto& [glyph_id, buffer]: glyph_buffers) {
+        delete buffer;
+    }
+    glyph_buffers.clear();
+}
 
-            // restore original outline (optional, in case reused)
-            for (int j = 0; j < outline->n_points; ++j) {
-                outline->points[j].x -= pen_x;
-                outline->points[j].y -= pen_y;
+/**
+ * returns the vertex buffer with the triangles of a glyph. the buffer is created and uploaded on first
+ * request, vertices are only updated if the color changes. returns `nullptr` for empty glyphs.
+ */
+VertexBuffer* PFont::get_glyph_buffer(const uint32_t glyph_id, const glm::vec4& color) {
+    const auto it = glyph_buffers.find(glyph_id);
+    if (it != glyph_buffers.end()) {
+        VertexBuffer* buffer = it->second;
+        if (buffer != nullptr && !buffer->vertices_data().empty() && glm::vec4(buffer->vertices_data().front().color) != color) {
+            for (auto& v: buffer->vertices_data()) {
+                v.color = color;
             }
+            buffer->set_transparent(color.a < 1.0f);
+            buffer->update();
         }
+        return buffer;
+    }
 
-        pen_x += pos[i].x_advance;
-        pen_y += pos[i].y_advance;
+    const GlyphMesh* mesh   = get_glyph_mesh(glyph_id);
+    VertexBuffer*    buffer = nullptr;
+    if (mesh != nullptr && !mesh->triangles.empty()) {
+        buffer = new VertexBuffer();
+        buffer->set_shape(TRIANGLES);
+        buffer->set_transparent(color.a < 1.0f);
+        for (const auto& p: mesh->triangles) {
+            buffer->add_vertex(Vertex(glm::vec3(p, 0.0f), color));
+        }
+        buffer->update();
     }
+    glyph_buffers.emplace(glyph_id, buffer);
+    return buffer;
+}
+
+/**
+ * draws `text` as geometry with the current fill color. each glyph id is tessellated and uploaded once
+ * and then drawn as a mesh at its pen position i.e repeated glyphs share one vertex buffer. the
+ * baseline of the first line starts at `x, y, z`.
+ *
+ * NOTE text alignment, leading and line breaks are not applied ( see `triangulate()` ).
+ */
+void PFont::draw_meshes(PGraphics* g, const std::string& text, const float x, const float y, const float z) {
+    if (g == nullptr || font == nullptr || font_size == 0) {
+        return;
+    }
+
+    const float                 text_scale = text_size / font_size;
+    const glm::vec4             color      = g->get_fill_color();
+    std::vector<GlyphPlacement> placements;
+    layout_glyphs(text, placements);
+
+    g->pushMatrix();
+    g->translate(x, y, z);
+    g->scale(text_scale, text_scale, 1.0f);
+    for (const auto& placement: placements) {
+        VertexBuffer* buffer = get_glyph_buffer(placement.glyph_id, color);
+        if (buffer == nullptr) {
+            continue;
+        }
+        g->pushMatrix();
+        g->translate(placement.position.x, placement.position.y);
+        g->mesh(buffer);
+        g->popMatrix();
+    }
+    g->popMatrix();
 }
 
 void PFont::draw(PGraphics* g, const std::string& text, const float x, const float y, const float z) {
@@ -210,6 +341,8 @@ void PFont::draw(PGraphics* g, const std::string& text, const float x, const flo
         return;
     }
 
+    draw_serial++;
+
     const float text_scale = text_size / font_size;
     const float ascent     = font->ascent;
     const float descent    = font->descent;
@@ -229,20 +362,34 @@ void PFont::draw(PGraphics* g, const std::string& text, const float x, const flo
             break;
     }
 
-    g->pushMatrix();
-    g->translate(x, y, z);
-    g->scale(text_scale, text_scale, 1);
-    g->translate(0, y_offset, 0);
-
-    g->push_texture_id();
-    g->push_force_transparent();
-    g->set_shape_force_transparent(true);
-
-    g->texture(this);
+    // NOTE glyphs are transformed here and added to the text batches of `g` i.e each glyph keeps the
+    //      transform and fill color of this call even if all text is submitted as one shape
+    const glm::mat4 text_transform = g->model_matrix *
+                                     glm::translate(glm::mat4(1.0f), glm::vec3(x, y, z)) *
+                                     glm::scale(glm::mat4(1.0f), glm::vec3(text_scale, text_scale, 1.0f)) *
+                                     glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, y_offset, 0.0f));
+    const glm::vec4 color = g->get_fill_color();
+
+    PShader* shader = g->get_shader();
+    if (sdf_mode) {
+        shader = g->get_text_sdf_shader();
+        if (shader == nullptr) {
+            warning_in_function_once("renderer does not support SDF text, drawing distance fields as they are");
+        }
+    }
 
     for (std::size_t i = 0; i < lines.size(); ++i) {
-        const std::string& line       = lines[i];
-        const float        line_width = get_text_width(*font, line);
+        // NOTE the reference is only valid until the next line is shaped
+        ShapedText& shaped = get_shaped_text(lines[i]);
+        if (shaped.quads_generation != atlas_generation) {
+            generate_quads(shaped, g);
+        } else {
+            for (const int page: shaped.quad_pages) {
+                atlas_pages[page].last_used = draw_serial;
+            }
+        }
+        update_atlas_pages(g);
+        const float line_width = shaped.width;
 
         float x_offset = 0;
         switch (text_align_x) {
@@ -253,39 +400,46 @@ void PFont::draw(PGraphics* g, const std::string& text, const float x, const flo
                 break;
         }
 
-        generate_text_quads(*font, line, text_quads);
-        // TODO maybe deactive stroke shape here to avoid outline artifacts
-        g->pushMatrix();
-        g->translate(x_offset, i * text_leading, 0); // baseline offset for current line
-        g->beginShape(TRIANGLES);
-        for (const auto& q: text_quads) {
-            g->vertex(q.x0, q.y0, 0, q.u0, q.v0);
-            g->vertex(q.x1, q.y1, 0, q.u1, q.v1);
-            g->vertex(q.x2, q.y2, 0, q.u2, q.v2);
-
-            g->vertex(q.x3, q.y3, 0, q.u3, q.v3);
-            g->vertex(q.x0, q.y0, 0, q.u0, q.v0);
-            g->vertex(q.x2, q.y2, 0, q.u2, q.v2);
+        // baseline offset for current line
+        const glm::mat4 line_transform = text_transform * glm::translate(glm::mat4(1.0f), glm::vec3(x_offset, i * text_leading, 0.0f));
+
+        // NOTE the batch reference is only valid until the next call to `text_batch()` or `flush()`
+        std::vector<Vertex>* batch      = nullptr;
+        int                  batch_page = -1;
+        for (size_t j = 0; j < shaped.quads.size(); ++j) {
+            if (shaped.quad_pages[j] != batch_page) {
+                batch_page = shaped.quad_pages[j];
+                batch      = &g->text_batch(atlas_pages[batch_page].image, shader);
+            }
+            const TexturedQuad& q = shaped.quads[j];
+            add_vertex(*batch, line_transform, color, q.x0, q.y0, q.u0, q.v0);
+            add_vertex(*batch, line_transform, color, q.x1, q.y1, q.u1, q.v1);
+            add_vertex(*batch, line_transform, color, q.x2, q.y2, q.u2, q.v2);
+
+            add_vertex(*batch, line_transform, color, q.x3, q.y3, q.u3, q.v3);
+            add_vertex(*batch, line_transform, color, q.x0, q.y0, q.u0, q.v0);
+            add_vertex(*batch, line_transform, color, q.x2, q.y2, q.u2, q.v2);
         }
-        g->endShape(CLOSE);
-        g->popMatrix();
     }
-
-    g->pop_texture_id();
-    g->pop_force_transparent();
-    g->popMatrix();
 }
 
-void PFont::generate_text_quads(const FontData&            font,
-                                const std::string&         text,
-                                std::vector<TexturedQuad>& quads) {
-    quads.clear();
+/**
+ * shapes a line of text. the quads are generated when the text is drawn, since glyphs are only
+ * rasterized into the atlas when they are needed.
+ */
+void PFont::shape_text(const FontData&    font,
+                       const std::string& text,
+                       ShapedText&        shaped) {
+    shaped.glyphs.clear();
+    shaped.quads.clear();
+    shaped.quad_pages.clear();
+    shaped.quads_generation = 0;
+    shaped.width            = 0.0f;
     hb_buffer_clear_contents(font.buffer);
 
     hb_buffer_add_utf8(font.buffer, text.c_str(), -1, 0, -1);
-    hb_buffer_set_direction(font.buffer, HB_DIRECTION_LTR);
-    hb_buffer_set_script(font.buffer, HB_SCRIPT_LATIN);
-    hb_buffer_set_language(font.buffer, hb_language_from_string("en", 2));
+    hb_buffer_set_language(font.buffer, font.language);
+    hb_buffer_guess_segment_properties(font.buffer); // NOTE direction and script from the text e.g for CJK or arabic
 
     hb_shape(font.hb_font, font.buffer, nullptr, 0);
 
@@ -293,59 +447,150 @@ void PFont::generate_text_quads(const FontData&            font,
     const hb_glyph_info_t*     glyph_info = hb_buffer_get_glyph_infos(font.buffer, &glyph_count);
     const hb_glyph_position_t* glyph_pos  = hb_buffer_get_glyph_positions(font.buffer, &glyph_count);
 
-    // Dynamically decide whether to preallocate
-    if (text.length() > 100) { // Only preallocate if the text is long
-        size_t estimated_quads = 0;
-        for (unsigned int i = 0; i < glyph_count; i++) {
-            uint32_t glyph_id = glyph_info[i].codepoint;
-            if (glyph_id != ' ' && font.glyphs.find(glyph_id) != font.glyphs.end()) {
-                estimated_quads++; // Only count valid glyphs (not spaces)
-            }
+    shaped.glyphs.reserve(glyph_count);
+    for (unsigned int i = 0; i < glyph_count; i++) {
+        ShapedGlyph shaped_glyph;
+        shaped_glyph.glyph_id  = glyph_info[i].codepoint;
+        shaped_glyph.x_advance = glyph_pos[i].x_advance;
+        shaped_glyph.y_advance = glyph_pos[i].y_advance;
+        shaped_glyph.x_offset  = glyph_pos[i].x_offset;
+        shaped_glyph.y_offset  = glyph_pos[i].y_offset;
+        shaped.glyphs.push_back(shaped_glyph);
+        shaped.width += static_cast<float>(glyph_pos[i].x_advance) / 64.0f; // divide by 64 to convert from subpixels
+    }
+}
+
+/**
+ * generates one textured quad per visible glyph and rasterizes glyphs that are not yet in the atlas.
+ * quads are in font pixel units with the baseline at `ascent`.
+ */
+void PFont::generate_quads(ShapedText& shaped, PGraphics* g) {
+    shaped.quads.clear();
+    shaped.quad_pages.clear();
+
+    float      x         = 0.0f;
+    const auto y         = static_cast<float>(font->ascent); // Baseline position
+    const auto page_size = static_cast<float>(atlas_page_size);
+
+    for (const auto& shaped_glyph: shaped.glyphs) {
+        const Glyph* glyph = get_glyph(shaped_glyph.glyph_id, g);
+        if (glyph != nullptr && glyph->page >= 0) {
+            atlas_pages[glyph->page].last_used = draw_serial;
+
+            const float x_pos = x + static_cast<float>(glyph->left + (shaped_glyph.x_offset >> 6));
+            const float y_pos = y - static_cast<float>(glyph->top + (shaped_glyph.y_offset >> 6));
+            const auto  w     = static_cast<float>(glyph->width);
+            const auto  h     = static_cast<float>(glyph->height);
+
+            // Compute texture coordinates
+            const float u0 = static_cast<float>(glyph->atlas_x) / page_size;
+            const float v0 = static_cast<float>(glyph->atlas_y) / page_size;
+            const float u1 = static_cast<float>(glyph->atlas_x + glyph->width) / page_size;
+            const float v1 = static_cast<float>(glyph->atlas_y + glyph->height) / page_size;
+
+            // Add textured quad
+            shaped.quads.emplace_back(
+                x_pos, y_pos, u0, v0,         // Top-left
+                x_pos + w, y_pos, u1, v0,     // Top-right
+                x_pos + w, y_pos + h, u1, v1, // Bottom-right
+                x_pos, y_pos + h, u0, v1      // Bottom-left
+            );
+            shaped.quad_pages.push_back(glyph->page);
         }
-        quads.reserve(estimated_quads);
+        x += static_cast<float>(shaped_glyph.x_advance >> 6); // Move forward ( also for glyphs without bitmap )
     }
+    shaped.quads_generation = atlas_generation;
+}
 
-    float      x = 0.0f;
-    const auto y = static_cast<float>(font.ascent); // Baseline position
+/* --- shaped text cache --- */
 
-    for (unsigned int i = 0; i < glyph_count; i++) {
-        uint32_t glyph_id = glyph_info[i].codepoint;
+/**
+ * returns the shaped text from the cache or shapes it and adds it to the cache. the least recently
+ * used entries are evicted when the cache exceeds its budget.
+ */
+PFont::ShapedText& PFont::get_shaped_text(const std::string& text) const {
+    if (text_cache_budget == 0) {
+        text_cache_stats.misses++;
+        shape_text(*font, text, text_cache_scratch);
+        return text_cache_scratch;
+    }
 
-        auto it = font.glyphs.find(glyph_id);
-        if (it == font.glyphs.end()) {
-            // Handle spaces explicitly
-            if (glyph_id == ' ') {
-                x += static_cast<float>(glyph_pos[i].x_advance >> 6); // Move forward for spaces
-            }
-            continue; // Skip unsupported glyphs
-        }
+    const auto it = text_cache.find(text);
+    if (it != text_cache.end()) {
+        text_cache_stats.hits++;
+        text_cache_lru.splice(text_cache_lru.begin(), text_cache_lru, it->second.lru_position);
+        return it->second.shaped;
+    }
 
-        const Glyph& g = it->second;
+    text_cache_stats.misses++;
+    const auto      inserted = text_cache.emplace(text, TextCacheEntry{}).first;
+    TextCacheEntry& entry    = inserted->second;
+    shape_text(*font, text, entry.shaped);
+    entry.shaped.glyphs.shrink_to_fit();
+    // NOTE quads are generated when drawn, reserve them now to account for their memory
+    entry.shaped.quads.reserve(entry.shaped.glyphs.size());
+    entry.shaped.quad_pages.reserve(entry.shaped.glyphs.size());
+    entry.bytes = sizeof(TextCacheEntry) +
+                  inserted->first.capacity() +
+                  entry.shaped.glyphs.capacity() * sizeof(ShapedGlyph) +
+                  entry.shaped.quads.capacity() * sizeof(TexturedQuad) +
+                  entry.shaped.quad_pages.capacity() * sizeof(int);
+    text_cache_lru.push_front(&inserted->first);
+    entry.lru_position = text_cache_lru.begin();
+    text_cache_stats.bytes += entry.bytes;
+
+    evict_text_cache(text_cache_budget);
+    return entry.shaped;
+}
 
-        float      x_pos = x + static_cast<float>(g.left + (glyph_pos[i].x_offset >> 6));
-        float      y_pos = y - static_cast<float>(g.top + (glyph_pos[i].y_offset >> 6));
-        const auto w     = static_cast<float>(g.width);
-        const auto h     = static_cast<float>(g.height);
+/**
+ * evicts least recently used entries until the cache fits into `budget`. the most recently used entry
+ * is always kept.
+ */
+void PFont::evict_text_cache(const size_t budget) const {
+    while (text_cache_stats.bytes > budget && text_cache_lru.size() > 1) {
+        const auto it = text_cache.find(*text_cache_lru.back());
+        text_cache_lru.pop_back();
+        text_cache_stats.bytes -= it->second.bytes;
+        text_cache_stats.evictions++;
+        text_cache.erase(it);
+    }
+}
+
+void PFont::set_text_cache_budget(const size_t bytes) {
+    text_cache_budget = bytes;
+    if (bytes == 0) {
+        clear_text_cache();
+        return;
+    }
+    evict_text_cache(bytes);
+}
 
-        // Compute texture coordinates
-        float u0 = static_cast<float>(g.atlas_x) / static_cast<float>(font.atlas_width);
-        float v0 = static_cast<float>(g.atlas_y) / static_cast<float>(font.atlas_height);
-        float u1 = static_cast<float>(g.atlas_x + g.width) / static_cast<float>(font.atlas_width);
-        float v1 = static_cast<float>(g.atlas_y + g.height) / static_cast<float>(font.atlas_height);
+void PFont::clear_text_cache() {
+    text_cache.clear();
+    text_cache_lru.clear();
+    text_cache_stats.bytes = 0;
+}
 
-        // Add textured quad
-        quads.emplace_back(
-            x_pos, y_pos, u0, v0,         // Top-left
-            x_pos + w, y_pos, u1, v0,     // Top-right
-            x_pos + w, y_pos + h, u1, v1, // Bottom-right
-            x_pos, y_pos + h, u0, v1      // Bottom-left
-        );
+PFont::TextCacheStats PFont::get_text_cache_stats() const {
+    TextCacheStats stats = text_cache_stats;
+    stats.entries        = text_cache.size();
+    stats.budget         = text_cache_budget;
+    return stats;
+}
 
-        x += static_cast<float>(glyph_pos[i].x_advance >> 6); // Move forward
-    }
+void PFont::print_text_cache_stats() const {
+    const TextCacheStats stats = get_text_cache_stats();
+    console(format_label("text cache entries"), stats.entries);
+    console(format_label("text cache memory"), stats.bytes / 1024, " KB ( budget ", stats.budget / 1024, " KB )");
+    console(format_label("text cache hits"), stats.hits, " ( ", static_cast<int>(stats.hit_rate() * 100.0f), "% )");
+    console(format_label("text cache misses"), stats.misses);
+    console(format_label("text cache evictions"), stats.evictions);
 }
 
-void PFont::create_font_atlas(FontData& font, const std::string& characters_in_atlas) {
+/* --- glyph atlas --- */
+
+void PFont::init_font_metrics(FontData& font) {
     if (font.face == nullptr || font.hb_font == nullptr) {
         error("font data not intizialized");
         return;
@@ -354,190 +599,355 @@ void PFont::create_font_atlas(FontData& font, const std::string& characters_in_a
     font.ascent   = static_cast<int>(font.face->size->metrics.ascender >> 6);
     font.descent  = static_cast<int>(-font.face->size->metrics.descender >> 6);
     font.line_gap = static_cast<int>(font.face->size->metrics.height >> 6);
+}
 
-    hb_buffer_clear_contents(font.buffer);
-    // std::u16string s16 = utf8_to_utf16(characters_in_atlas);
-    // std::vector<uint16_t> utf16_vec(s16.begin(), s16.end());
-    // utf16_vec.push_back(0);  // Add null terminator
-    // const uint16_t* raw_utf16 = utf16_vec.data();
-    // hb_buffer_add_utf16(font.buffer, raw_utf16, -1, 0, -1);
-    hb_buffer_add_utf8(font.buffer, characters_in_atlas.c_str(), -1, 0, -1);
-    hb_buffer_set_direction(font.buffer, HB_DIRECTION_LTR);
-    hb_buffer_set_script(font.buffer, HB_SCRIPT_LATIN);
-    hb_buffer_set_language(font.buffer, hb_language_from_string("en", 2));
+/**
+ * sets up the font image as the first atlas page. pages must hold at least one glyph, their size is
+ * therefore doubled for large font sizes.
+ */
+void PFont::init_atlas() {
+    atlas_page_size = DEFAULT_ATLAS_PAGE_SIZE;
+    while (static_cast<float>(atlas_page_size) < font_size * 2) {
+        atlas_page_size *= 2;
+    }
+    const size_t page_pixels = static_cast<size_t>(atlas_page_size) * static_cast<size_t>(atlas_page_size);
+    pixels                   = new uint32_t[page_pixels]{0x00000000};
+    clean_up_pixel_buffer    = true;
+    width                    = static_cast<float>(atlas_page_size);
+    height                   = static_cast<float>(atlas_page_size);
+    set_auto_generate_mipmap(true); // NOTE set mipmap generation to true by default
 
-    hb_shape(font.hb_font, font.buffer, nullptr, 0);
+    AtlasPage page;
+    page.image = this;
+    page.packer.reset(atlas_page_size, atlas_page_size);
+    atlas_pages.push_back(page);
+}
 
-    unsigned int           glyph_count;
-    const hb_glyph_info_t* glyph_info = hb_buffer_get_glyph_infos(font.buffer, &glyph_count);
+/**
+ * returns the glyph and rasterizes it into the atlas if it is drawn for the first time. returns
+ * nullptr if the glyph could not be loaded.
+ */
+const PFont::Glyph* PFont::get_glyph(const uint32_t glyph_id, PGraphics* g) {
+    const auto it = font->glyphs.find(glyph_id);
+    if (it != font->glyphs.end()) {
+        return &it->second;
+    }
+    if (font->face == nullptr) {
+        return nullptr;
+    }
 
-    int           current_x      = 0;
-    int           current_y      = 0;
-    int           max_row_height = 0;
-    constexpr int atlas_width    = atlas_pixel_width;
-    int           atlas_height   = 0;
+    // NOTE `FT_LOAD_COLOR` loads color bitmaps e.g of emoji fonts as BGRA
+    const bool loaded = sdf_mode ? load_glyph_sdf(glyph_id) : FT_Load_Glyph(font->face, glyph_id, FT_LOAD_RENDER | FT_LOAD_COLOR) == 0;
+    if (!loaded) {
+        warning_in_function_once("could not load glyph: ", glyph_id);
+        return nullptr;
+    }
+    const FT_GlyphSlot slot = font->face->glyph;
+
+    Glyph glyph;
+    glyph.width   = static_cast<int>(slot->bitmap.width);
+    glyph.height  = static_cast<int>(slot->bitmap.rows);
+    glyph.left    = slot->bitmap_left;
+    glyph.top     = slot->bitmap_top;
+    glyph.advance = static_cast<int>(slot->advance.x) >> 6;
+
+    if (glyph.width > 0 && glyph.height > 0 && slot->bitmap.buffer != nullptr) {
+        int page_index;
+        int x;
+        int y;
+        if (!allocate_glyph(glyph.width + atlas_character_padding,
+                            glyph.height + atlas_character_padding,
+                            page_index, x, y, g)) {
+            warning_in_function_once("glyph does not fit into atlas page: ", glyph.width, "×", glyph.height, " px");
+        } else {
+            AtlasPage& page = atlas_pages[page_index];
+            glyph.page      = page_index;
+            glyph.atlas_x   = x;
+            glyph.atlas_y   = y;
+            copy_bitmap_to_page(slot->bitmap, page.image, x, y);
+            page.image->mark_dirty(x, y, glyph.width, glyph.height);
+            page.glyphs.push_back(glyph_id);
+            page.last_used = draw_serial;
+        }
+    }
+    atlas_rasterized++;
+    return &font->glyphs.emplace(glyph_id, glyph).first->second;
+}
 
-    for (unsigned int i = 0; i < glyph_count; i++) {
-        FT_Load_Glyph(font.face, glyph_info[i].codepoint, FT_LOAD_RENDER);
-        const FT_GlyphSlot glyph = font.face->glyph;
-
-        if (font.glyphs.find(glyph_info[i].codepoint) == font.glyphs.end()) {
-            Glyph g;
-            g.width   = static_cast<int>(glyph->bitmap.width);
-            g.height  = static_cast<int>(glyph->bitmap.rows);
-            g.left    = glyph->bitmap_left;
-            g.top     = glyph->bitmap_top;
-            g.advance = static_cast<int>(glyph->advance.x) >> 6;
-
-            // Ensure correct copying of bitmap buffer
-            if (glyph->bitmap.buffer) {
-                g.bitmap.assign(glyph->bitmap.buffer, glyph->bitmap.buffer + g.width * g.height);
-            } else {
-                g.bitmap.assign(g.width * g.height, 0);
-            }
+/**
+ * finds space for a glyph in one of the pages. if all pages are full a new page is added as long as
+ * the atlas budget allows it, otherwise the least recently used page is evicted. pages used by the
+ * current `draw()` call are never evicted.
+ */
+bool PFont::allocate_glyph(const int block_width, const int block_height, int& page_index, int& x, int& y, PGraphics* g) {
+    if (block_width > atlas_page_size || block_height > atlas_page_size) {
+        return false;
+    }
+    for (size_t i = 0; i < atlas_pages.size(); ++i) {
+        if (atlas_pages[i].packer.pack(block_width, block_height, x, y)) {
+            page_index = static_cast<int>(i);
+            return true;
+        }
+    }
 
-            if (current_x + g.width + atlas_character_padding > atlas_width) {
-                current_x = 0;
-                current_y += max_row_height + atlas_character_padding;
-                max_row_height = 0;
-            }
+    const size_t page_bytes = static_cast<size_t>(atlas_page_size) * static_cast<size_t>(atlas_page_size) * sizeof(uint32_t);
+    if ((atlas_pages.size() + 1) * page_bytes <= atlas_budget) {
+        page_index = add_atlas_page();
+        return atlas_pages[page_index].packer.pack(block_width, block_height, x, y);
+    }
 
-            g.atlas_x = current_x;
-            g.atlas_y = current_y;
+    int oldest_page = -1;
+    for (size_t i = 0; i < atlas_pages.size(); ++i) {
+        if (atlas_pages[i].last_used < draw_serial &&
+            (oldest_page < 0 || atlas_pages[i].last_used < atlas_pages[oldest_page].last_used)) {
+            oldest_page = static_cast<int>(i);
+        }
+    }
+    if (oldest_page < 0) {
+        warning_in_function_once("atlas budget exceeded by a single draw call, adding page anyway");
+        page_index = add_atlas_page();
+    } else {
+        evict_atlas_page(oldest_page, g);
+        page_index = oldest_page;
+    }
+    return atlas_pages[page_index].packer.pack(block_width, block_height, x, y);
+}
 
-            current_x += g.width + atlas_character_padding;
-            max_row_height = std::max(max_row_height, g.height);
+/**
+ * loads a glyph and renders it as a signed distance field. the field extends `sdf_spread` pixels
+ * beyond the outline, `bitmap_left` and `bitmap_top` include this border.
+ */
+bool PFont::load_glyph_sdf(const uint32_t glyph_id) const {
+#ifdef PFONT_SDF_AVAILABLE
+    // NOTE no hinting since glyphs are scaled when drawn
+    if (FT_Load_Glyph(font->face, glyph_id, FT_LOAD_NO_HINTING) != 0) {
+        return false;
+    }
+    const FT_GlyphSlot slot = font->face->glyph;
+    if (slot->format == FT_GLYPH_FORMAT_OUTLINE && slot->outline.n_points == 0) {
+        return true; // NOTE e.g space, nothing to render
+    }
+    return FT_Render_Glyph(slot, FT_RENDER_MODE_SDF) == 0;
+#else
+    (void) glyph_id;
+    return false;
+#endif // PFONT_SDF_AVAILABLE
+}
 
-            font.glyphs[glyph_info[i].codepoint] = g;
-        }
+int PFont::add_atlas_page() {
+    AtlasPage page;
+    page.image = new PImage(atlas_page_size, atlas_page_size);
+    page.image->set_auto_generate_mipmap(true);
+    page.packer.reset(atlas_page_size, atlas_page_size);
+    atlas_pages.push_back(page);
+    return static_cast<int>(atlas_pages.size()) - 1;
+}
+
+/**
+ * clears a page and removes its glyphs. cached quads that still reference the page are regenerated
+ * since the atlas generation changes.
+ */
+void PFont::evict_atlas_page(const int page_index, PGraphics* g) {
+    if (g != nullptr) {
+        g->flush(); // NOTE shapes that are already submitted may still reference the page
+    }
+    clear_atlas_page(atlas_pages[page_index]);
+    atlas_generation++;
+    atlas_evicted_pages++;
+}
+
+void PFont::clear_atlas_page(AtlasPage& page) {
+    for (const uint32_t glyph_id: page.glyphs) {
+        font->glyphs.erase(glyph_id);
     }
+    page.glyphs.clear();
+    page.packer.reset(atlas_page_size, atlas_page_size);
+    std::fill_n(page.image->pixels, static_cast<size_t>(atlas_page_size) * static_cast<size_t>(atlas_page_size), 0x00000000);
+    page.image->mark_dirty(0, 0, atlas_page_size, atlas_page_size);
+}
 
-    atlas_height      = current_y + max_row_height; // Fix last row height
-    font.atlas_width  = atlas_width;
-    font.atlas_height = atlas_height;
-    font.atlas.resize(atlas_width * atlas_height, 0);
+/**
+ * removes all glyphs e.g after switching between bitmap and SDF glyphs. pages are kept.
+ */
+void PFont::clear_atlas() {
+    for (auto& page: atlas_pages) {
+        clear_atlas_page(page);
+    }
+    if (font != nullptr) {
+        font->glyphs.clear(); // NOTE also glyphs without bitmap
+    }
+    atlas_generation++;
+}
 
-    for (const auto& pair: font.glyphs) {
-        const Glyph& g = pair.second;
-        for (int y = 0; y < g.height; y++) {
-            for (int x = 0; x < g.width; x++) {
-                const int atlas_x                           = g.atlas_x + x;
-                const int atlas_y                           = g.atlas_y + y;
-                font.atlas[atlas_y * atlas_width + atlas_x] = g.bitmap[y * g.width + x];
+/**
+ * uploads the regions of newly rasterized glyphs.
+ */
+void PFont::update_atlas_pages(PGraphics* g) const {
+    for (const auto& page: atlas_pages) {
+        if (page.image->has_dirty_regions() || page.image->texture_id < TEXTURE_VALID_ID) {
+            page.image->updatePixels(g);
+        }
+    }
+}
+
+/**
+ * copies a glyph bitmap as white pixels with alpha coverage into a page. color bitmaps are copied with
+ * their color. pixels are written in the byte order R, G, B, A.
+ */
+void PFont::copy_bitmap_to_page(const FT_Bitmap& bitmap, PImage* page, const int x, const int y) {
+    const int page_width = static_cast<int>(page->width);
+    auto*     page_bytes = reinterpret_cast<uint8_t*>(page->pixels);
+    for (unsigned int row = 0; row < bitmap.rows; row++) {
+        const uint8_t* src = bitmap.buffer + static_cast<ptrdiff_t>(row) * bitmap.pitch;
+        uint8_t*       dst = page_bytes + (static_cast<size_t>(y + row) * page_width + x) * 4;
+        for (unsigned int col = 0; col < bitmap.width; col++) {
+            uint8_t red   = 255;
+            uint8_t green = 255;
+            uint8_t blue  = 255;
+            uint8_t alpha;
+            switch (bitmap.pixel_mode) {
+                case FT_PIXEL_MODE_MONO:
+                    alpha = (src[col >> 3] & (0x80 >> (col & 7))) ? 255 : 0;
+                    break;
+                case FT_PIXEL_MODE_BGRA: {
+                    // NOTE color bitmaps are premultiplied
+                    const uint8_t* bgra = src + col * 4;
+                    alpha               = bgra[3];
+                    if (alpha > 0) {
+                        red   = static_cast<uint8_t>(std::min(255, bgra[2] * 255 / alpha));
+                        green = static_cast<uint8_t>(std::min(255, bgra[1] * 255 / alpha));
+                        blue  = static_cast<uint8_t>(std::min(255, bgra[0] * 255 / alpha));
+                    }
+                } break;
+                case FT_PIXEL_MODE_GRAY:
+                default:
+                    alpha = src[col];
+                    break;
             }
+            dst[col * 4 + 0] = red;
+            dst[col * 4 + 1] = green;
+            dst[col * 4 + 2] = blue;
+            dst[col * 4 + 3] = alpha;
         }
     }
 }
 
+void PFont::set_atlas_budget(const size_t bytes) {
+    atlas_budget = bytes;
+}
+
+/**
+ * switches between bitmap glyphs and signed distance field glyphs. `spread` is the distance in font
+ * pixels that the field extends beyond the outline ( 2–32 ), larger values allow effects like
+ * outlines or glow but need more atlas space.
+ */
+void PFont::set_sdf_mode(const bool enable, const int spread) {
+#ifndef PFONT_SDF_AVAILABLE
+    if (enable) {
+        error_in_function("SDF mode requires FreeType 2.11 or newer");
+        return;
+    }
+#endif // PFONT_SDF_AVAILABLE
+    const int clamped_spread = std::clamp(spread, 2, 32); // NOTE range supported by FreeType
+    if (enable == sdf_mode && clamped_spread == sdf_spread) {
+        return;
+    }
+    sdf_mode   = enable;
+    sdf_spread = clamped_spread;
+#ifdef PFONT_SDF_AVAILABLE
+    if (freetype != nullptr) {
+        const FT_Int value = sdf_spread;
+        FT_Property_Set(freetype, "sdf", "spread", &value);
+        FT_Property_Set(freetype, "bsdf", "spread", &value);
+    }
+#endif // PFONT_SDF_AVAILABLE
+    clear_atlas();
+}
+
+PFont::AtlasStats PFont::get_atlas_stats() const {
+    AtlasStats stats;
+    stats.pages         = static_cast<int>(atlas_pages.size());
+    stats.page_size     = atlas_page_size;
+    stats.rasterized    = atlas_rasterized;
+    stats.evicted_pages = atlas_evicted_pages;
+    stats.bytes         = atlas_pages.size() * static_cast<size_t>(atlas_page_size) * static_cast<size_t>(atlas_page_size) * sizeof(uint32_t);
+    stats.budget        = atlas_budget;
+    for (const auto& page: atlas_pages) {
+        stats.glyphs += page.glyphs.size();
+    }
+    return stats;
+}
+
+void PFont::print_atlas_stats() const {
+    const AtlasStats stats = get_atlas_stats();
+    console(format_label("font atlas pages"), stats.pages, " ( ", stats.page_size, "×", stats.page_size, " px )");
+    console(format_label("font atlas memory"), stats.bytes / 1024, " KB ( budget ", stats.budget / 1024, " KB )");
+    console(format_label("font atlas glyphs"), stats.glyphs);
+    console(format_label("font atlas rasterized"), stats.rasterized);
+    console(format_label("font atlas evicted pages"), stats.evicted_pages);
+}
+
 #ifdef PFONT_DEBUG_FONT
 #define STB_IMAGE_WRITE_IMPLEMENTATION // TODO why does this cause a duplicate symbol error?
 #include "stb_image_write.h"
 #endif //PFONT_DEBUG_FONT
 
 #ifdef PFONT_DEBUG_FONT
-void PFont::DEBUG_save_font_atlas(const FontData& font, const std::string& output_path) const {
-    // Convert the grayscale atlas to an RGBA image for better visibility
-    std::vector<unsigned char> atlas_rgba(font.atlas_width * font.atlas_height * 4, 255);
-    for (int y = 0; y < font.atlas_height; y++) {
-        for (int x = 0; x < font.atlas_width; x++) {
-            const unsigned char val = font.atlas[y * font.atlas_width + x];
-            const int           idx = (y * font.atlas_width + x) * 4;
-
-            // Store grayscale value into RGBA channels (transparent text on white fond)
-            atlas_rgba[idx + 0] = 255; // R
-            atlas_rgba[idx + 1] = 255; // G
-            atlas_rgba[idx + 2] = 255; // B
-            atlas_rgba[idx + 3] = val; // A (fully opaque)
-
-            // // Store grayscale value into RGBA channels (white text on black background)
-            // atlas_rgba[idx + 0] = val; // R
-            // atlas_rgba[idx + 1] = val; // G
-            // atlas_rgba[idx + 2] = val; // B
-            // atlas_rgba[idx + 3] = 255; // A (fully opaque)
-        }
+void PFont::DEBUG_save_font_atlas(const std::string& output_path) const {
+    // NOTE pages are stored as RGBA with white pixels and alpha coverage
+    for (size_t i = 0; i < atlas_pages.size(); ++i) {
+        const std::string page_path = output_path + "-" + std::to_string(i) + ".png";
+        stbi_write_png(page_path.c_str(), atlas_page_size, atlas_page_size, 4, atlas_pages[i].image->pixels, atlas_page_size * 4);
+        console("Font atlas saved to: ", page_path);
     }
-
-    // Save as PNG
-    stbi_write_png(output_path.c_str(), font.atlas_width, font.atlas_height, 4, atlas_rgba.data(), font.atlas_width * 4);
-    console("Font atlas saved to: ", output_path);
 }
 
-void PFont::DEBUG_save_text(const FontData&    font,
-                            const char*        text,
-                            const std::string& outputfile) const {
+void PFont::DEBUG_save_text(const char*        text,
+                            const std::string& outputfile) {
+    ShapedText shaped;
+    shape_text(*font, text, shaped);
 
-    hb_buffer_clear_contents(font.buffer);
-    hb_buffer_add_utf8(font.buffer, text, -1, 0, -1);
-    hb_buffer_set_direction(font.buffer, HB_DIRECTION_LTR);
-    hb_buffer_set_script(font.buffer, HB_SCRIPT_LATIN);
-    hb_buffer_set_language(font.buffer, hb_language_from_string("en", 2));
-
-    // Use the pre-existing HarfBuzz font
-    hb_shape(font.hb_font, font.buffer, nullptr, 0);
-
-    unsigned int               glyph_count;
-    const hb_glyph_info_t*     glyph_info = hb_buffer_get_glyph_infos(font.buffer, &glyph_count);
-    const hb_glyph_position_t* glyph_pos  = hb_buffer_get_glyph_positions(font.buffer, &glyph_count);
-
-    const int max_height      = font.ascent + font.descent;
-    int       total_advance   = 0;
-    int       trimmed_advance = 0; // Tracks actual needed width
-
-    // Compute max width while ignoring missing glyphs
-    for (unsigned int i = 0; i < glyph_count; i++) {
-        uint32_t glyph_id = glyph_info[i].codepoint;
-        if (glyph_id == ' ' || font.glyphs.find(glyph_id) != font.glyphs.end()) {
-            trimmed_advance += glyph_pos[i].x_advance >> 6; // Count only valid glyphs and spaces
-        }
-        total_advance += glyph_pos[i].x_advance >> 6; // Original width
+    const int max_height    = font->ascent + font->descent;
+    int       total_advance = 0;
+    for (const auto& shaped_glyph: shaped.glyphs) {
+        total_advance += shaped_glyph.x_advance >> 6;
+    }
+    if (total_advance <= 0 || max_height <= 0) {
+        return;
     }
-
-    total_advance = trimmed_advance; // Trim unused space
 
     std::vector<unsigned char> image;
     image.assign(total_advance * max_height, 0);
 
     int       x = 0;
-    const int y = font.ascent; // Baseline position
-
-    for (unsigned int i = 0; i < glyph_count; i++) {
-        uint32_t glyph_id = glyph_info[i].codepoint;
-
-        auto it = font.glyphs.find(glyph_id);
-        if (it == font.glyphs.end()) {
-            if (glyph_id == ' ') {
-                x += glyph_pos[i].x_advance >> 6; // Move forward for spaces
-            }
-            continue;
-        }
-
-        const Glyph& g = it->second;
-
-        const int x_pos = x + g.left + (glyph_pos[i].x_offset >> 6);
-        const int y_pos = y - g.top + (glyph_pos[i].y_offset >> 6);
-
-        for (int row = 0; row < g.height; row++) {
-            for (int col = 0; col < g.width; col++) {
-                const int atlas_x = g.atlas_x + col;
-                const int atlas_y = g.atlas_y + row;
-                const int img_x   = x_pos + col;
-                const int img_y   = y_pos + row;
-
-                if (img_x >= 0 && img_x < total_advance && img_y >= 0 && img_y < max_height) {
-                    if (atlas_x >= 0 && atlas_x < font.atlas_width &&
-                        atlas_y >= 0 && atlas_y < font.atlas_height) {
-                        unsigned char val                    = font.atlas[atlas_y * font.atlas_width + atlas_x];
+    const int y = font->ascent; // Baseline position
+
+    for (const auto& shaped_glyph: shaped.glyphs) {
+        const Glyph* g = get_glyph(shaped_glyph.glyph_id, nullptr);
+        if (g != nullptr && g->page >= 0) {
+            const auto* page_bytes = reinterpret_cast<const uint8_t*>(atlas_pages[g->page].image->pixels);
+            const int   x_pos      = x + g->left + (shaped_glyph.x_offset >> 6);
+            const int   y_pos      = y - g->top + (shaped_glyph.y_offset >> 6);
+
+            for (int row = 0; row < g->height; row++) {
+                for (int col = 0; col < g->width; col++) {
+                    const int atlas_x = g->atlas_x + col;
+                    const int atlas_y = g->atlas_y + row;
+                    const int img_x   = x_pos + col;
+                    const int img_y   = y_pos + row;
+
+                    if (img_x >= 0 && img_x < total_advance && img_y >= 0 && img_y < max_height) {
+                        unsigned char val                    = page_bytes[(atlas_y * atlas_page_size + atlas_x) * 4 + 3];
                         image[img_y * total_advance + img_x] = std::max(image[img_y * total_advance + img_x], val);
                     }
                 }
             }
         }
 
-        x += glyph_pos[i].x_advance >> 6; // Move forward
+        x += shaped_glyph.x_advance >> 6; // Move forward
     }
 
     // Save image
-    //     stbi_write_png(output_path, total_advance, max_height, 1, image.data(), total_advance);
     std::vector<unsigned char> image_rgba(image.size() * 4, 255);
     for (int i = 0; i < image.size(); ++i) {
         image_rgba[i * 4 + 0] = 255;
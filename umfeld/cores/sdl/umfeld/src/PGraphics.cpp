@@ -20,6 +20,7 @@
 #include <iostream>
 #include <vector>
 #include <array>
+#include <algorithm>
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -37,6 +38,7 @@
 #include "Geometry.h"
 #include "UShapeRenderer.h"
 #include "VertexBuffer.h"
+#include "TextureAtlas.h"
 
 using namespace umfeld;
 
@@ -57,10 +59,11 @@ void PGraphics::beginDraw() {
 void PGraphics::endDraw() {
     flush();
     restore_mvp_matrices();
-    lights_enabled     = false;
-    current_shape.mode = POLYGON;
-    texture_stack_top  = nullptr;
-    texture_stack_used = false;
+    lights_enabled       = false;
+    current_shape.mode   = POLYGON;
+    texture_stack_top    = nullptr;
+    texture_stack_packed = nullptr;
+    texture_stack_used   = false;
     resetShader();
 }
 
@@ -76,6 +79,7 @@ void PGraphics::resetShader() {
 }
 
 void PGraphics::flush() {
+    submit_text_batches();
     if (shape_renderer) {
         shape_renderer->flush(view_matrix, projection_matrix);
     }
@@ -92,19 +96,56 @@ void PGraphics::mesh(VertexBuffer* mesh_shape) {
     s.model_matrix = model_matrix;
     s.transparent  = mesh_shape->get_transparent();
     // NOTE ignore 'closed'
-    s.texture_id    = get_current_texture_id();
+    // NOTE texture coordinates of a mesh are not mapped to atlas regions, packed images are bound with their own texture
+    s.texture_id    = current_texture_packed != nullptr ? static_cast<uint16_t>(texture_update_and_bind(current_texture_packed)) : get_current_texture_id();
     s.light_enabled = lights_enabled; // TODO not properly supported WIP
     if (lights_enabled) {
         s.lighting = lightingState;
     }
     s.shader        = current_custom_shader;
     s.vertex_buffer = mesh_shape;
+    submit_text_batches();
     shape_renderer->submit_shape(s);
     if (render_mode == RENDER_MODE_IMMEDIATELY) {
         flush();
     }
 }
 
+/**
+ * uploads a region of the pixels of an image to its texture. the default implementation copies the
+ * region into a contiguous buffer ( unless the region spans full rows ) and calls `upload_texture()`.
+ */
+void PGraphics::upload_texture_region(PImage* img, const int x, const int y, const int width, const int height) {
+    if (img == nullptr || img->pixels == nullptr) {
+        error_in_function("image or pixel data is nullptr");
+        return;
+    }
+    const int image_width = static_cast<int>(img->width);
+    if (x == 0 && width == image_width) {
+        upload_texture(img, img->pixels + y * image_width, width, height, x, y);
+        return;
+    }
+    std::vector<uint32_t> region(static_cast<size_t>(width) * static_cast<size_t>(height));
+    for (int row = 0; row < height; ++row) {
+        std::copy_n(img->pixels + (y + row) * image_width + x, width, region.data() + row * width);
+    }
+    upload_texture(img, region.data(), width, height, x, y);
+}
+
+/**
+ * copies the result of the last `request_colorbuffer_readback()` into `pixels`. returns true if new
+ * pixels are available. renderers may read back asynchronously with a latency of a few frames, the
+ * default implementation downloads the color buffer synchronously.
+ */
+bool PGraphics::poll_colorbuffer_readback(uint32_t* pixels) {
+    if (!colorbuffer_readback_requested || pixels == nullptr) {
+        return false;
+    }
+    colorbuffer_readback_requested = false;
+    download_colorbuffer(pixels);
+    return true;
+}
+
 void PGraphics::hint(const uint16_t property) {
     // ReSharper disable once CppDefaultCaseNotHandledInSwitchStatement
     switch (property) {
@@ -910,10 +951,27 @@ void PGraphics::text_str(const std::string& text, const float x, const float y,
         return;
     }
 
+    begin_text_batch(x, y, z);
     current_font->draw(this, text, x, y, z);
+    if (render_mode == RENDER_MODE_IMMEDIATELY) {
+        flush();
+    } else if (!text_batching) {
+        submit_text_batches();
+    }
 }
 
 void PGraphics::texture(PImage* img) {
+    current_texture_region = TEXTURE_REGION_FULL;
+    current_texture_packed = nullptr;
+    if (img != nullptr && texture_atlas != nullptr) {
+        const TextureAtlas::Region* region = texture_atlas->get_region(this, img);
+        if (region != nullptr) {
+            current_texture        = region->page;
+            current_texture_region = region->uv;
+            current_texture_packed = img;
+            return;
+        }
+    }
     current_texture = img;
 }
 
@@ -1024,7 +1082,10 @@ void PGraphics::box(const float width, const float height, const float depth) {
         current_shape.mode             = TRIANGLES;
         shape_fill_vertex_buffer       = box_fill_vertices_LUT; // bulk copy
         const glm::vec4 fill_color_vec = as_vec4(color_fill);
-        for (auto& v: shape_fill_vertex_buffer) { v.color = fill_color_vec; }
+        for (auto& v: shape_fill_vertex_buffer) {
+            v.color     = fill_color_vec;
+            v.tex_coord = map_to_texture_region(v.tex_coord);
+        }
         submit_fill_shape(true, shape_force_transparent);
         shape_fill_vertex_buffer.clear();
         current_shape.started = false;
@@ -1415,7 +1476,7 @@ void PGraphics::vertex(const float x, const float y, const float z, const float
     }
 
     const glm::vec3 position{x, y, z};
-    const glm::vec3 tex_coord{u, v, 0.0f};
+    const glm::vec3 tex_coord = map_to_texture_region({u, v, 0.0f});
 
     if (color_stroke.active) {
         shape_stroke_vertex_buffer.emplace_back(position, as_vec4(color_stroke), tex_coord, current_normal);
@@ -1431,19 +1492,21 @@ void PGraphics::vertex(const Vertex& v) {
         return;
     }
     // TODO maybe use v.color instead of color_fill? 'shape_fill_vertex_buffer.emplace_back(v);'
+    const glm::vec3 tex_coord = map_to_texture_region(v.tex_coord);
     if (color_stroke.active) {
-        shape_stroke_vertex_buffer.emplace_back(v.position, as_vec4(color_stroke), v.tex_coord, v.normal);
+        shape_stroke_vertex_buffer.emplace_back(v.position, as_vec4(color_stroke), tex_coord, v.normal);
     }
     if (color_fill.active && shape_can_have_fill(current_shape.mode)) {
-        shape_fill_vertex_buffer.emplace_back(v.position, as_vec4(color_fill), v.tex_coord, v.normal);
+        shape_fill_vertex_buffer.emplace_back(v.position, as_vec4(color_fill), tex_coord, v.normal);
     }
 }
 
 int PGraphics::get_current_texture_id() const { return current_texture == nullptr ? TEXTURE_NONE : current_texture->texture_id; }
 
-void PGraphics::submit_stroke_shape(const bool closed, const bool force_transparent) const {
+void PGraphics::submit_stroke_shape(const bool closed, const bool force_transparent) {
     const bool _force_transparent = stroke_render_mode == STROKE_RENDER_MODE_TRIANGULATE_2D ? true : force_transparent;
     if (!shape_stroke_vertex_buffer.empty()) {
+        submit_text_batches();
         UShape s;
         s.mode         = current_shape.mode;
         s.stroke       = current_stroke_state;
@@ -1458,8 +1521,9 @@ void PGraphics::submit_stroke_shape(const bool closed, const bool force_transpar
     }
 }
 
-void PGraphics::submit_fill_shape(const bool closed, const bool force_transparent) const {
+void PGraphics::submit_fill_shape(const bool closed, const bool force_transparent) {
     if (shape_renderer != nullptr && !shape_fill_vertex_buffer.empty()) {
+        submit_text_batches();
         UShape s;
         // NOTE no need to copy stroke info for filled shape
         s.mode          = current_shape.mode;
@@ -1496,24 +1560,69 @@ void PGraphics::debug_text(const std::string& text, const float x, const float y
     if (shape_renderer == nullptr || debug_font == nullptr) {
         return;
     }
-    UShape s;
-    s.mode = TRIANGLES;
-    // NOTE ignore 'stroke'
-    s.filled = true;
-    s.vertices.reserve(text.size() * 6);
-    debug_font->generate(s.vertices, text, x, y, glm::vec4(color_fill));
-    s.model_matrix  = model_matrix;
-    s.transparent   = true;
-    s.closed        = false;
-    s.texture_id    = texture_update_and_bind(debug_font->atlas());
-    s.light_enabled = false;
-    // NOTE ignore 'lighting'
     // NOTE ignore 'shader'
-    // NOTE ignore 'vertex_buffer'
-    shape_renderer->submit_shape(s);
+    begin_text_batch(x, y, 0.0f);
+    UFont::generate(text_batch(debug_font->atlas(), nullptr), text, x, y, as_vec4(color_fill), model_matrix);
     if (render_mode == RENDER_MODE_IMMEDIATELY) {
         flush();
+    } else if (!text_batching) {
+        submit_text_batches();
+    }
+}
+
+/**
+ * submits the current text batches if the text at `x, y, z` is at a different depth than the text in
+ * the batches. since a batch is depth sorted as one transparent shape, only text at the same depth
+ * ( e.g all text in 2D ) is merged.
+ */
+void PGraphics::begin_text_batch(const float x, const float y, const float z) {
+    const float depth = (view_matrix * model_matrix * glm::vec4(x, y, z, 1.0f)).z;
+    if (std::abs(depth - text_batch_depth) > 1e-4f) {
+        submit_text_batches();
+    }
+    text_batch_depth = depth;
+}
+
+/**
+ * returns the vertex stream of the text batch for a texture and shader. vertices are added in world
+ * space with their color, so that consecutive text calls with different transforms and colors can be
+ * merged into one shape per texture.
+ *
+ * NOTE batches are submitted before the next non-text shape, on `flush()` or when the depth of the
+ *      text changes, so that the order of submission is kept.
+ */
+std::vector<Vertex>& PGraphics::text_batch(PImage* texture, PShader* shader) {
+    const auto texture_id = static_cast<uint16_t>(texture_update_and_bind(texture));
+    for (auto& batch: text_batches) {
+        if (batch.texture_id == texture_id && batch.shader == shader) {
+            return batch.vertices;
+        }
+    }
+    text_batches.push_back(TextBatch{texture_id, shader, {}});
+    return text_batches.back().vertices;
+}
+
+void PGraphics::submit_text_batches() {
+    if (shape_renderer != nullptr) {
+        for (auto& batch: text_batches) {
+            if (batch.vertices.empty()) {
+                continue;
+            }
+            UShape s;
+            s.mode = TRIANGLES;
+            // NOTE ignore 'stroke'
+            s.filled        = true;
+            s.vertices      = std::move(batch.vertices);
+            s.model_matrix  = glm::mat4(1.0f); // NOTE vertices are already transformed
+            s.transparent   = true;
+            s.closed        = false;
+            s.texture_id    = batch.texture_id;
+            s.light_enabled = false;
+            s.shader        = batch.shader;
+            shape_renderer->submit_shape(s);
+        }
     }
+    text_batches.clear();
 }
 
 void PGraphics::emit_shape_fill_triangles(std::vector<Vertex>& triangle_vertices) {
@@ -20,6 +20,7 @@
 #if defined(OPENGL_3_3_CORE) || defined(OPENGL_ES_3_0)
 
 #include <vector>
+#include <algorithm>
 
 #include "UmfeldSDLOpenGL.h"
 #include <glm/gtc/matrix_transform.hpp>
@@ -38,8 +39,10 @@
 #include "ShaderSourceFullscreen.h"
 #include "ShaderSourceLine.h"
 #include "ShaderSourcePoint.h"
+#include "ShaderSourceTextSDF.h"
 #include "ShaderSourceTexture.h"
 #include "ShaderSourceTextureLights.h"
+#include "ShaderSourceYUV.h"
 #include "UShapeRendererOpenGL_3.h"
 
 #if UMFELD_DEBUG_PGRAPHICS_OPENGL_3_ERRORS
@@ -217,12 +220,8 @@ void PGraphicsOpenGL_3::endDraw() {
 
 void PGraphicsOpenGL_3::texture(PImage* img) {
     PGraphics::texture(img);
-    // enable and
-    if (img != nullptr) {
-        texture_update_and_bind(img);
-    } else {
-        texture_update_and_bind(nullptr);
-    }
+    // NOTE `current_texture` may differ from `img` if the image is packed into a texture atlas
+    texture_update_and_bind(current_texture);
 }
 
 void PGraphicsOpenGL_3::render_framebuffer_to_screen(const bool use_blit) {
@@ -269,6 +268,12 @@ void PGraphicsOpenGL_3::hint(const uint16_t property) {
             glHint(GL_LINE_SMOOTH_HINT, GL_FASTEST);
 #endif
             break;
+        case ENABLE_ASYNC_TEXTURE_UPLOAD:
+            async_texture_upload = true;
+            break;
+        case DISABLE_ASYNC_TEXTURE_UPLOAD:
+            async_texture_upload = false;
+            break;
         default:
             break;
     }
@@ -318,13 +323,7 @@ void PGraphicsOpenGL_3::upload_texture(PImage*         img,
     const int tmp_bound_texture = get_current_texture_id();
     OGL_bind_texture(img->texture_id);
 
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
-    glTexSubImage2D(GL_TEXTURE_2D,
-                    0, offset_x, offset_y,
-                    width, height,
-                    UMFELD_DEFAULT_EXTERNAL_PIXEL_FORMAT,
-                    UMFELD_DEFAULT_TEXTURE_PIXEL_TYPE,
-                    pixel_data);
+    OGL3_upload_sub_image(pixel_data, width, offset_x, offset_y, width, height);
 
     if (img->get_auto_generate_mipmap()) {
         glGenerateMipmap(GL_TEXTURE_2D); // NOTE this works on macOS … but might not work on all platforms
@@ -333,6 +332,290 @@ void PGraphicsOpenGL_3::upload_texture(PImage*         img,
     OGL_bind_texture(tmp_bound_texture);
 }
 
+void PGraphicsOpenGL_3::upload_texture_region(PImage*   img,
+                                              const int x,
+                                              const int y,
+                                              const int width,
+                                              const int height) {
+    if (img == nullptr) {
+        error_in_function("image is nullptr.");
+        return;
+    }
+
+    if (img->pixels == nullptr) {
+        error_in_function("pixel data is nullptr");
+        return;
+    }
+
+    if (width <= 0 || height <= 0) {
+        error_in_function("invalid width or height");
+        return;
+    }
+
+    if (x < 0 || y < 0 || x + width > img->width || y + height > img->height) {
+        error_in_function("parameters exceed image dimensions");
+        return;
+    }
+
+    if (img->texture_id < TEXTURE_VALID_ID) {
+        OGL_generate_and_upload_image_as_texture(img); // NOTE uploads the full image
+        if (img->texture_id < TEXTURE_VALID_ID) {
+            error_in_function("failed to create texture");
+        }
+        return;
+    }
+
+    const int tmp_bound_texture = get_current_texture_id();
+    OGL_bind_texture(img->texture_id);
+
+    // NOTE region is read directly from the image pixels with a row stride
+    const int image_width = static_cast<int>(img->width);
+    OGL3_upload_sub_image(img->pixels + y * image_width + x, image_width, x, y, width, height);
+
+    if (img->get_auto_generate_mipmap()) {
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
+
+    OGL_bind_texture(tmp_bound_texture);
+}
+
+/**
+ * uploads the planes of a YUV frame into three small textures and converts them into the RGBA texture
+ * of the image with a fullscreen pass. this uploads 1.5 ( 4:2:0 ) or 2 ( 4:2:2 ) instead of 4 bytes
+ * per pixel and does not touch `img->pixels`.
+ */
+bool PGraphicsOpenGL_3::upload_texture_yuv(PImage* img, const YUVFrame& frame) {
+    if (img == nullptr) {
+        error_in_function("image is nullptr.");
+        return false;
+    }
+
+    if (shader_yuv_to_rgba == nullptr) {
+        return false;
+    }
+
+    if (frame.planes[0] == nullptr || frame.planes[1] == nullptr ||
+        (frame.format != YUV_FORMAT_NV12 && frame.planes[2] == nullptr)) {
+        error_in_function("missing YUV planes");
+        return false;
+    }
+
+    if (frame.width != static_cast<int>(img->width) || frame.height != static_cast<int>(img->height)) {
+        error_in_function("frame size does not match image size");
+        return false;
+    }
+
+    const int tmp_bound_texture = get_current_texture_id();
+
+    /* create image texture without pixel data */
+    if (img->texture_id < TEXTURE_VALID_ID) {
+        GLuint new_texture_id;
+        glGenTextures(1, &new_texture_id);
+        if (new_texture_id == 0) {
+            error_in_function("texture ID generation failed");
+            return false;
+        }
+        img->texture_id = static_cast<int>(new_texture_id);
+        OGL_bind_texture(img->texture_id);
+        OGL_texture_wrap(CLAMP_TO_EDGE, glm::vec4(0, 0, 0, 0));
+        OGL_texture_filter(img->get_auto_generate_mipmap() ? MIPMAP : LINEAR);
+        glTexImage2D(GL_TEXTURE_2D,
+                     0,
+                     UMFELD_DEFAULT_INTERNAL_PIXEL_FORMAT,
+                     frame.width,
+                     frame.height,
+                     0,
+                     UMFELD_DEFAULT_EXTERNAL_PIXEL_FORMAT,
+                     UMFELD_DEFAULT_TEXTURE_PIXEL_TYPE,
+                     nullptr);
+    }
+
+    /* upload planes */
+    const bool interleaved_uv = frame.format == YUV_FORMAT_NV12;
+    OGL3_upload_yuv_plane(0, frame.planes[0], frame.strides[0], frame.width, frame.height, false);
+    OGL3_upload_yuv_plane(1, frame.planes[1], frame.strides[1], frame.chroma_width(), frame.chroma_height(), interleaved_uv);
+    if (!interleaved_uv) {
+        OGL3_upload_yuv_plane(2, frame.planes[2], frame.strides[2], frame.chroma_width(), frame.chroma_height(), false);
+    }
+
+    /* store state */
+    GLint previous_draw_fbo;
+    GLint previous_read_fbo;
+    GLint previous_program;
+    GLint previous_vao;
+    GLint previous_viewport_yuv[4];
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previous_draw_fbo);
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &previous_read_fbo);
+    glGetIntegerv(GL_CURRENT_PROGRAM, &previous_program);
+    glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &previous_vao);
+    glGetIntegerv(GL_VIEWPORT, previous_viewport_yuv);
+    const GLboolean blend_enabled   = glIsEnabled(GL_BLEND);
+    const GLboolean depth_enabled   = glIsEnabled(GL_DEPTH_TEST);
+    const GLboolean scissor_enabled = glIsEnabled(GL_SCISSOR_TEST);
+    const GLboolean cull_enabled    = glIsEnabled(GL_CULL_FACE);
+
+    /* convert into image texture */
+    if (yuv_fbo == 0) {
+        glGenFramebuffers(1, &yuv_fbo);
+    }
+    if (yuv_vao == 0) {
+        glGenVertexArrays(1, &yuv_vao);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, yuv_fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, img->texture_id, 0);
+    glViewport(0, 0, frame.width, frame.height);
+    glDisable(GL_BLEND);
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_SCISSOR_TEST);
+    glDisable(GL_CULL_FACE);
+
+    const YUVCoefficients c = get_yuv_coefficients(frame.color_space, frame.full_range);
+    shader_yuv_to_rgba->use();
+    shader_yuv_to_rgba->set_uniform("u_texture_y", 0);
+    shader_yuv_to_rgba->set_uniform("u_texture_u", 1);
+    shader_yuv_to_rgba->set_uniform("u_texture_v", 2);
+    shader_yuv_to_rgba->set_uniform("u_interleaved_uv", interleaved_uv ? 1 : 0);
+    shader_yuv_to_rgba->set_uniform("u_luma", glm::vec2(c.y_offset, c.y_scale));
+    shader_yuv_to_rgba->set_uniform("u_chroma", glm::vec4(c.v_to_r, c.u_to_g, c.v_to_g, c.u_to_b));
+    for (int i = 0; i < 3; i++) {
+        glActiveTexture(GL_TEXTURE0 + i);
+        glBindTexture(GL_TEXTURE_2D, yuv_plane_textures[i]);
+    }
+    glBindVertexArray(yuv_vao);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
+
+    /* restore state */
+    glBindVertexArray(previous_vao);
+    glUseProgram(previous_program);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, previous_draw_fbo);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, previous_read_fbo);
+    glViewport(previous_viewport_yuv[0], previous_viewport_yuv[1], previous_viewport_yuv[2], previous_viewport_yuv[3]);
+    if (blend_enabled) {
+        glEnable(GL_BLEND);
+    }
+    if (depth_enabled) {
+        glEnable(GL_DEPTH_TEST);
+    }
+    if (scissor_enabled) {
+        glEnable(GL_SCISSOR_TEST);
+    }
+    if (cull_enabled) {
+        glEnable(GL_CULL_FACE);
+    }
+    if (img->get_auto_generate_mipmap()) {
+        OGL_bind_texture(img->texture_id);
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
+    OGL_bind_texture(tmp_bound_texture); // NOTE also resets the active texture unit
+    UMFELD_PGRAPHICS_OPENGL_3_CHECK_ERRORS("upload_texture_yuv");
+    return true;
+}
+
+/**
+ * uploads one YUV plane into a single ( R8 ) or two channel ( RG8 ) texture. the texture is only
+ * reallocated if the plane size changes.
+ */
+void PGraphicsOpenGL_3::OGL3_upload_yuv_plane(const int      plane,
+                                              const uint8_t* data,
+                                              const int      stride,
+                                              const int      width,
+                                              const int      height,
+                                              const bool     two_channels) {
+    const GLenum internal_format = two_channels ? GL_RG8 : GL_R8;
+    const GLenum external_format = two_channels ? GL_RG : GL_RED;
+    const int    bytes_per_pixel = two_channels ? 2 : 1;
+
+    glActiveTexture(GL_TEXTURE0 + DEFAULT_ACTIVE_TEXTURE_UNIT);
+    bool allocate = false;
+    if (yuv_plane_textures[plane] == 0) {
+        glGenTextures(1, &yuv_plane_textures[plane]);
+        glBindTexture(GL_TEXTURE_2D, yuv_plane_textures[plane]);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        // NOTE luma is sampled exactly at texel centers, chroma is interpolated
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, plane == 0 ? GL_NEAREST : GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, plane == 0 ? GL_NEAREST : GL_LINEAR);
+        allocate = true;
+    } else {
+        glBindTexture(GL_TEXTURE_2D, yuv_plane_textures[plane]);
+        allocate = yuv_plane_width[plane] != width ||
+                   yuv_plane_height[plane] != height ||
+                   yuv_plane_two_channels[plane] != two_channels;
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, stride / bytes_per_pixel == width ? 0 : stride / bytes_per_pixel);
+    if (allocate) {
+        glTexImage2D(GL_TEXTURE_2D, 0, static_cast<GLint>(internal_format), width, height, 0, external_format, GL_UNSIGNED_BYTE, data);
+        yuv_plane_width[plane]        = width;
+        yuv_plane_height[plane]       = height;
+        yuv_plane_two_channels[plane] = two_channels;
+    } else {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, external_format, GL_UNSIGNED_BYTE, data);
+    }
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+/**
+ * uploads pixel data to the currently bound texture. `pixel_data` points to the first pixel of the
+ * region and `row_length` is the number of pixels per row in the source buffer. if async texture
+ * upload is enabled ( see `hint(ENABLE_ASYNC_TEXTURE_UPLOAD)` ) the pixels are copied into one of two
+ * alternating pixel unpack buffers so that the transfer to the texture does not stall the CPU.
+ */
+void PGraphicsOpenGL_3::OGL3_upload_sub_image(const uint32_t* pixel_data,
+                                              const int       row_length,
+                                              const int       x,
+                                              const int       y,
+                                              const int       width,
+                                              const int       height) {
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    if (async_texture_upload) {
+        if (unpack_pbo[0] == 0) {
+            glGenBuffers(NUM_UNPACK_PBOS, unpack_pbo);
+        }
+        unpack_pbo_index = (unpack_pbo_index + 1) % NUM_UNPACK_PBOS;
+
+        const size_t row_size    = static_cast<size_t>(width) * sizeof(uint32_t);
+        const size_t buffer_size = row_size * static_cast<size_t>(height);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, unpack_pbo[unpack_pbo_index]);
+        // NOTE orphan previous storage so that mapping does not wait for a pending transfer
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(buffer_size), nullptr, GL_STREAM_DRAW);
+        auto* mapped = static_cast<uint8_t*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER,
+                                                              0,
+                                                              static_cast<GLsizeiptr>(buffer_size),
+                                                              GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+        if (mapped != nullptr) {
+            for (int row = 0; row < height; ++row) {
+                std::memcpy(mapped + row * row_size, pixel_data + row * row_length, row_size);
+            }
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+            glTexSubImage2D(GL_TEXTURE_2D,
+                            0, x, y,
+                            width, height,
+                            UMFELD_DEFAULT_EXTERNAL_PIXEL_FORMAT,
+                            UMFELD_DEFAULT_TEXTURE_PIXEL_TYPE,
+                            nullptr); // NOTE offset into bound pixel unpack buffer
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            UMFELD_PGRAPHICS_OPENGL_3_CHECK_ERRORS("OGL3_upload_sub_image");
+            return;
+        }
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        warning_in_function_once("could not map pixel unpack buffer, falling back to synchronous upload");
+    }
+
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, row_length == width ? 0 : row_length);
+    glTexSubImage2D(GL_TEXTURE_2D,
+                    0, x, y,
+                    width, height,
+                    UMFELD_DEFAULT_EXTERNAL_PIXEL_FORMAT,
+                    UMFELD_DEFAULT_TEXTURE_PIXEL_TYPE,
+                    pixel_data);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+}
+
 void PGraphicsOpenGL_3::download_texture(PImage* img) {
     if (img == nullptr) {
         error_in_function("image is nullptr");
@@ -394,6 +677,7 @@ void PGraphicsOpenGL_3::init(uint32_t* pixels, const int width, const int height
             GLuint    msaaDepthBuffer;
             const int samples = std::min(msaa_samples, maxSamples); // Number of MSAA samples
             console(format_label("number of used MSAA samples"), samples);
+            framebuffer.samples = samples;
             glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, framebuffer.texture_id); // NOTE no need to use `OGL_bind_texture()`
             UMFELD_PGRAPHICS_OPENGL_3_CHECK_ERRORS("glBindTexture");
 #ifndef OPENGL_ES_3_0
@@ -422,6 +706,7 @@ void PGraphicsOpenGL_3::init(uint32_t* pixels, const int width, const int height
                                       GL_DEPTH_ATTACHMENT,
                                       GL_RENDERBUFFER,
                                       msaaDepthBuffer);
+            framebuffer.depth_buffer_id = msaaDepthBuffer;
         } else {
             glBindTexture(GL_TEXTURE_2D, framebuffer.texture_id); // NOTE no need to use `OGL_bind_texture()`
             glTexImage2D(GL_TEXTURE_2D,
@@ -445,6 +730,7 @@ void PGraphicsOpenGL_3::init(uint32_t* pixels, const int width, const int height
             glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
             glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, framebuffer.width, framebuffer.height);
             glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+            framebuffer.depth_buffer_id = depthBuffer;
         }
 
         if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
@@ -493,6 +779,8 @@ void PGraphicsOpenGL_3::init(uint32_t* pixels, const int width, const int height
     shape_renderer = shape_renderer_ogl3;
 
     shader_fullscreen_texture = loadShader(shader_source_fullscreen.get_vertex_source(), shader_source_fullscreen.get_fragment_source());
+    shader_yuv_to_rgba        = loadShader(shader_source_yuv_to_rgba.get_vertex_source(), shader_source_yuv_to_rgba.get_fragment_source());
+    shader_text_sdf           = loadShader(shader_source_text_sdf.get_vertex_source(), shader_source_text_sdf.get_fragment_source());
 
     if constexpr (sizeof(Vertex) != 64) {
         // ReSharper disable once CppDFAUnreachableCode
@@ -537,6 +825,12 @@ void PGraphicsOpenGL_3::resize(const int new_width, const int new_height) {
         }
 #endif
 
+        // NOTE depth/stencil renderbuffer is recreated below
+        if (framebuffer.depth_buffer_id != 0) {
+            glDeleteRenderbuffers(1, &framebuffer.depth_buffer_id);
+            framebuffer.depth_buffer_id = 0;
+        }
+
         if (framebuffer.msaa) {
 #ifndef OPENGL_ES_3_0
             glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, framebuffer.texture_id);
@@ -566,6 +860,8 @@ void PGraphicsOpenGL_3::resize(const int new_width, const int new_height) {
                                       GL_DEPTH_ATTACHMENT,
                                       GL_RENDERBUFFER,
                                       msaaDepthBuffer);
+            framebuffer.depth_buffer_id = msaaDepthBuffer;
+            framebuffer.samples         = samples;
             glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, 0);
 #endif
         } else {
@@ -593,6 +889,7 @@ void PGraphicsOpenGL_3::resize(const int new_width, const int new_height) {
             glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
             glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, framebuffer.width, framebuffer.height);
             glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+            framebuffer.depth_buffer_id = depthBuffer;
             glBindTexture(GL_TEXTURE_2D, 0);
         }
 
@@ -688,6 +985,64 @@ bool PGraphicsOpenGL_3::read_framebuffer(std::vector<unsigned char>& pixels) {
     }
 }
 
+/**
+ * deletes the framebuffer, its attachments and the buffers used for texture transfers. the graphics
+ * object can not be used for drawing afterwards.
+ */
+void PGraphicsOpenGL_3::release_framebuffer() {
+    if (framebuffer.depth_buffer_id != 0) {
+        glDeleteRenderbuffers(1, &framebuffer.depth_buffer_id);
+    }
+    if (framebuffer.texture_id != 0) {
+        glDeleteTextures(1, &framebuffer.texture_id);
+    }
+    if (framebuffer.id != 0) {
+        glDeleteFramebuffers(1, &framebuffer.id);
+    }
+    framebuffer.depth_buffer_id = 0;
+    framebuffer.texture_id      = 0;
+    framebuffer.id              = 0;
+    texture_id                  = TEXTURE_NOT_GENERATED;
+
+    for (auto& slot: readback_slots) {
+        if (slot.pending) {
+            glDeleteSync(static_cast<GLsync>(slot.fence));
+        }
+        if (slot.pbo != 0) {
+            glDeleteBuffers(1, &slot.pbo);
+        }
+        slot = ReadbackSlot{};
+    }
+    readback_write_index = 0;
+    readback_read_index  = 0;
+    if (readback_resolve_fbo != 0) {
+        glDeleteFramebuffers(1, &readback_resolve_fbo);
+        glDeleteTextures(1, &readback_resolve_texture);
+        readback_resolve_fbo     = 0;
+        readback_resolve_texture = 0;
+    }
+    if (unpack_pbo[0] != 0) {
+        glDeleteBuffers(NUM_UNPACK_PBOS, unpack_pbo);
+        std::fill_n(unpack_pbo, NUM_UNPACK_PBOS, 0);
+    }
+    if (yuv_fbo != 0) {
+        glDeleteFramebuffers(1, &yuv_fbo);
+        yuv_fbo = 0;
+    }
+    if (yuv_vao != 0) {
+        glDeleteVertexArrays(1, &yuv_vao);
+        yuv_vao = 0;
+    }
+    for (auto& plane_texture: yuv_plane_textures) {
+        if (plane_texture != 0) {
+            glDeleteTextures(1, &plane_texture);
+            plane_texture = 0;
+        }
+    }
+    std::fill_n(yuv_plane_width, 3, 0);
+    std::fill_n(yuv_plane_height, 3, 0);
+}
+
 void PGraphicsOpenGL_3::store_fbo_state() {
     if (render_to_offscreen) {
         glGetIntegerv(GL_CURRENT_PROGRAM, &previous_shader);
@@ -1078,6 +1433,156 @@ void PGraphicsOpenGL_3::download_colorbuffer(uint32_t* pixels) {
     OGL3_flip_pixel_buffer(pixels);
 }
 
+/**
+ * reads the color buffer into the next pixel pack buffer of a ring of `NUM_READBACK_SLOTS` buffers
+ * and inserts a fence. the transfer happens asynchronously, the result is collected with
+ * `poll_colorbuffer_readback()` a few frames later.
+ */
+void PGraphicsOpenGL_3::request_colorbuffer_readback() {
+    ReadbackSlot& slot = readback_slots[readback_write_index];
+    if (slot.pending) {
+        // NOTE ring is full, the oldest readback is dropped
+        glDeleteSync(static_cast<GLsync>(slot.fence));
+        slot.fence          = nullptr;
+        slot.pending        = false;
+        readback_read_index = (readback_read_index + 1) % NUM_READBACK_SLOTS;
+        warning_in_function_once("readback ring is full, dropping oldest readback. `pixelsReady()` should be called every frame.");
+    }
+
+    const int w = framebuffer.width;
+    const int h = framebuffer.height;
+    if (slot.pbo == 0) {
+        glGenBuffers(1, &slot.pbo);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+    if (slot.width != w || slot.height != h) {
+        glBufferData(GL_PIXEL_PACK_BUFFER,
+                     static_cast<GLsizeiptr>(w) * h * static_cast<GLsizeiptr>(sizeof(uint32_t)),
+                     nullptr,
+                     GL_STREAM_READ);
+        slot.width  = w;
+        slot.height = h;
+    }
+
+    if (render_to_offscreen) {
+        store_fbo_state();
+    }
+    OGL3_bind_readback_framebuffer();
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(0, 0, w, h,
+                 UMFELD_DEFAULT_EXTERNAL_PIXEL_FORMAT,
+                 UMFELD_DEFAULT_TEXTURE_PIXEL_TYPE,
+                 nullptr); // NOTE offset into bound pixel pack buffer
+    if (render_to_offscreen) {
+        restore_fbo_state();
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    slot.fence           = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot.pending         = true;
+    readback_write_index = (readback_write_index + 1) % NUM_READBACK_SLOTS;
+    UMFELD_PGRAPHICS_OPENGL_3_CHECK_ERRORS("request_colorbuffer_readback");
+}
+
+/**
+ * retires all completed readbacks without blocking and copies the most recent one ( flipped ) into
+ * `pixels`. returns false if no readback has completed since the last call.
+ */
+bool PGraphicsOpenGL_3::poll_colorbuffer_readback(uint32_t* pixels) {
+    int latest_slot = -1;
+    while (readback_slots[readback_read_index].pending) {
+        ReadbackSlot& slot   = readback_slots[readback_read_index];
+        const GLenum  status = glClientWaitSync(static_cast<GLsync>(slot.fence), GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+        if (status == GL_TIMEOUT_EXPIRED) {
+            break;
+        }
+        glDeleteSync(static_cast<GLsync>(slot.fence));
+        slot.fence   = nullptr;
+        slot.pending = false;
+        if (status == GL_WAIT_FAILED) {
+            warning_in_function_once("waiting for readback fence failed");
+        } else {
+            latest_slot = readback_read_index;
+        }
+        readback_read_index = (readback_read_index + 1) % NUM_READBACK_SLOTS;
+    }
+
+    if (latest_slot < 0 || pixels == nullptr) {
+        return false;
+    }
+
+    const ReadbackSlot& slot = readback_slots[latest_slot];
+    if (slot.width != framebuffer.width || slot.height != framebuffer.height) {
+        return false; // NOTE framebuffer was resized after the readback was requested
+    }
+
+    bool success = false;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+    const auto* mapped = static_cast<const uint32_t*>(glMapBufferRange(GL_PIXEL_PACK_BUFFER,
+                                                                       0,
+                                                                       static_cast<GLsizeiptr>(slot.width) * slot.height * static_cast<GLsizeiptr>(sizeof(uint32_t)),
+                                                                       GL_MAP_READ_BIT));
+    if (mapped != nullptr) {
+        const size_t row_size = static_cast<size_t>(slot.width) * sizeof(uint32_t);
+        for (int y = 0; y < slot.height; ++y) {
+            std::memcpy(pixels + y * slot.width, mapped + (slot.height - 1 - y) * slot.width, row_size);
+        }
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        success = true;
+    } else {
+        error_in_function("could not map pixel pack buffer");
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    return success;
+}
+
+void PGraphicsOpenGL_3::OGL3_bind_readback_framebuffer() {
+    if (!render_to_offscreen) {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+        return;
+    }
+    if (!framebuffer.msaa) {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer.id);
+        return;
+    }
+
+    // NOTE multisample FBOs are resolved into a non-MSAA FBO that is kept for subsequent readbacks
+    if (readback_resolve_fbo == 0 ||
+        readback_resolve_width != framebuffer.width ||
+        readback_resolve_height != framebuffer.height) {
+        if (readback_resolve_fbo == 0) {
+            glGenFramebuffers(1, &readback_resolve_fbo);
+            glGenTextures(1, &readback_resolve_texture);
+        }
+        push_texture_id();
+        OGL_bind_texture(readback_resolve_texture);
+        glTexImage2D(GL_TEXTURE_2D, 0,
+                     UMFELD_DEFAULT_INTERNAL_PIXEL_FORMAT,
+                     framebuffer.width,
+                     framebuffer.height,
+                     0, UMFELD_DEFAULT_EXTERNAL_PIXEL_FORMAT,
+                     UMFELD_DEFAULT_TEXTURE_PIXEL_TYPE,
+                     nullptr);
+        pop_texture_id();
+        glBindFramebuffer(GL_FRAMEBUFFER, readback_resolve_fbo);
+        glFramebufferTexture2D(GL_FRAMEBUFFER,
+                               GL_COLOR_ATTACHMENT0,
+                               GL_TEXTURE_2D,
+                               readback_resolve_texture,
+                               0);
+        readback_resolve_width  = framebuffer.width;
+        readback_resolve_height = framebuffer.height;
+    }
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer.id);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, readback_resolve_fbo);
+    glBlitFramebuffer(0, 0, framebuffer.width, framebuffer.height,
+                      0, 0, framebuffer.width, framebuffer.height,
+                      GL_COLOR_BUFFER_BIT,
+                      GL_NEAREST);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, readback_resolve_fbo);
+}
+
 void PGraphicsOpenGL_3::OGL3_flip_pixel_buffer(uint32_t* pixels) {
     const int d      = displayDensity();
     const int phys_w = width * d;
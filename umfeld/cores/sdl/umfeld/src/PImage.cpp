@@ -20,6 +20,8 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 
+#include <algorithm>
+
 #include "Umfeld.h"
 #include "PImage.h"
 #include "PGraphics.h"
@@ -284,8 +286,85 @@ void PImage::update(PGraphics* graphics, const uint32_t* pixel_data) {
     update(graphics, pixel_data, static_cast<int>(this->width), static_cast<int>(this->height), 0, 0);
 }
 
+/**
+ * uploads `pixels` to the texture. if regions are marked with `mark_dirty()` only these regions are
+ * uploaded, otherwise the full image is uploaded.
+ */
 void PImage::updatePixels(PGraphics* graphics) {
-    update(graphics, pixels, static_cast<int>(this->width), static_cast<int>(this->height), 0, 0);
+    if (!pixels) {
+        error("pixel array not initialized");
+        return;
+    }
+
+    if (dirty_regions.empty() || texture_id < TEXTURE_VALID_ID) {
+        update_full_internal(graphics);
+        dirty_regions.clear();
+        return;
+    }
+
+    uint64_t dirty_area = 0;
+    for (const auto& region: dirty_regions) {
+        dirty_area += static_cast<uint64_t>(region.width) * static_cast<uint64_t>(region.height);
+    }
+    const auto image_area = static_cast<double>(width) * static_cast<double>(height);
+    if (static_cast<double>(dirty_area) > image_area * DIRTY_REGIONS_FULL_UPLOAD_RATIO) {
+        update_full_internal(graphics);
+    } else {
+        for (const auto& region: dirty_regions) {
+            graphics->upload_texture_region(this, region.x, region.y, region.width, region.height);
+        }
+    }
+    dirty_regions.clear();
+}
+
+/**
+ * marks a region of `pixels` as changed. overlapping or adjacent regions are merged. if there are
+ * more than `MAX_DIRTY_REGIONS` regions they are collapsed into their bounding box.
+ */
+void PImage::mark_dirty(const int x, const int y, const int w, const int h) {
+    const int x0 = std::max(0, x);
+    const int y0 = std::max(0, y);
+    const int x1 = std::min(static_cast<int>(width), x + w);
+    const int y1 = std::min(static_cast<int>(height), y + h);
+    if (x1 <= x0 || y1 <= y0) {
+        return;
+    }
+
+    DirtyRegion region{x0, y0, x1 - x0, y1 - y0};
+    bool        merged = true;
+    while (merged) {
+        merged = false;
+        for (auto it = dirty_regions.begin(); it != dirty_regions.end(); ++it) {
+            if (region.x > it->x + it->width || it->x > region.x + region.width ||
+                region.y > it->y + it->height || it->y > region.y + region.height) {
+                continue;
+            }
+            const int mx0 = std::min(region.x, it->x);
+            const int my0 = std::min(region.y, it->y);
+            const int mx1 = std::max(region.x + region.width, it->x + it->width);
+            const int my1 = std::max(region.y + region.height, it->y + it->height);
+            region        = DirtyRegion{mx0, my0, mx1 - mx0, my1 - my0};
+            dirty_regions.erase(it);
+            merged = true;
+            break;
+        }
+    }
+    dirty_regions.push_back(region);
+
+    if (static_cast<int>(dirty_regions.size()) > MAX_DIRTY_REGIONS) {
+        int bx0 = region.x;
+        int by0 = region.y;
+        int bx1 = region.x + region.width;
+        int by1 = region.y + region.height;
+        for (const auto& r: dirty_regions) {
+            bx0 = std::min(bx0, r.x);
+            by0 = std::min(by0, r.y);
+            bx1 = std::max(bx1, r.x + r.width);
+            by1 = std::max(by1, r.y + r.height);
+        }
+        dirty_regions.clear();
+        dirty_regions.push_back(DirtyRegion{bx0, by0, bx1 - bx0, by1 - by0});
+    }
 }
 
 void PImage::updatePixels(PGraphics* graphics, const int x, const int y, const int w, const int h) {
@@ -298,14 +377,8 @@ void PImage::updatePixels(PGraphics* graphics, const int x, const int y, const i
         return;
     }
 
-    const int length  = w * h;
-    auto*     mPixels = new uint32_t[length];
-    for (int i = 0; i < length; ++i) {
-        const int src_index = (y + i / w) * static_cast<int>(this->width) + (x + i % w);
-        mPixels[i]          = pixels[src_index];
-    }
-    update(graphics, mPixels, w, h, x, y);
-    delete[] mPixels;
+    // NOTE region is uploaded directly from `pixels` without an intermediate copy
+    graphics->upload_texture_region(this, x, y, w, h);
 }
 
 void PImage::loadPixels(PGraphics* graphics) {
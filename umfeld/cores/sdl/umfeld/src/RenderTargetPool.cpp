@@ -0,0 +1,186 @@
+/*
+ * Umfeld
+ *
+ * This file is part of the *Umfeld* library (https://github.com/dennisppaul/umfeld).
+ * Copyright (c) 2025 Dennis P Paul.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+
+#include "Umfeld.h"
+#include "RenderTargetPool.h"
+#include "PGraphics.h"
+
+using namespace umfeld;
+
+RenderTargetPool::RenderTargetPool(const int max_idle_frames) : max_idle_frames(max_idle_frames) {}
+
+RenderTargetPool::~RenderTargetPool() {
+    for (const auto& target: targets) {
+        if (target.in_use) {
+            warning_in_function("destroying render target that is still in use");
+        }
+        destroy(target);
+    }
+    targets.clear();
+}
+
+/**
+ * returns an idle render target with the requested configuration or creates a new one.
+ */
+PGraphics* RenderTargetPool::acquire(const int width, const int height, const int msaa_samples) {
+    if (width <= 0 || height <= 0) {
+        error_in_function("invalid render target size: ", width, "x", height);
+        return nullptr;
+    }
+    const int samples = std::max(0, msaa_samples);
+    for (auto& target: targets) {
+        if (!target.in_use &&
+            target.width == width &&
+            target.height == height &&
+            target.msaa_samples == samples) {
+            target.in_use      = true;
+            target.idle_frames = 0;
+            reused_count++;
+            return target.graphics;
+        }
+    }
+
+    // NOTE `PGraphics::init()` takes the number of MSAA samples from `antialiasing`
+    const int previous_antialiasing = antialiasing;
+    antialiasing                    = samples;
+    PGraphics* graphics             = createGraphics(width, height);
+    antialiasing                    = previous_antialiasing;
+    if (graphics == nullptr) {
+        error_in_function("could not create render target");
+        return nullptr;
+    }
+
+    Target target;
+    target.graphics     = graphics;
+    target.width        = width;
+    target.height       = height;
+    target.msaa_samples = samples;
+    target.in_use       = true;
+    targets.push_back(target);
+    created_count++;
+    return graphics;
+}
+
+void RenderTargetPool::release(PGraphics* target) {
+    if (target == nullptr) {
+        return;
+    }
+    for (auto& t: targets) {
+        if (t.graphics == target) {
+            if (!t.in_use) {
+                warning_in_function("render target was already released");
+            }
+            t.in_use      = false;
+            t.idle_frames = 0;
+            return;
+        }
+    }
+    warning_in_function("render target does not belong to this pool");
+}
+
+/**
+ * should be called once per frame. destroys targets that have been idle for more than
+ * `max_idle_frames` calls.
+ */
+void RenderTargetPool::update() {
+    for (auto it = targets.begin(); it != targets.end();) {
+        if (!it->in_use && ++it->idle_frames > max_idle_frames) {
+            destroy(*it);
+            it = targets.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+/**
+ * destroys all idle targets.
+ */
+void RenderTargetPool::clear() {
+    for (auto it = targets.begin(); it != targets.end();) {
+        if (!it->in_use) {
+            destroy(*it);
+            it = targets.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+RenderTargetPool::Stats RenderTargetPool::get_stats() const {
+    Stats stats;
+    for (const auto& target: targets) {
+        if (target.in_use) {
+            stats.live_targets++;
+            stats.live_bytes += estimate_bytes(target);
+        } else {
+            stats.idle_targets++;
+            stats.idle_bytes += estimate_bytes(target);
+        }
+    }
+    stats.created   = created_count;
+    stats.reused    = reused_count;
+    stats.destroyed = destroyed_count;
+    return stats;
+}
+
+void RenderTargetPool::print_stats() const {
+    const Stats stats = get_stats();
+    console(format_label("render targets live"), stats.live_targets, " ( ", stats.live_bytes / (1024 * 1024), " MB )");
+    console(format_label("render targets idle"), stats.idle_targets, " ( ", stats.idle_bytes / (1024 * 1024), " MB )");
+    console(format_label("render targets created"), stats.created);
+    console(format_label("render targets reused"), stats.reused);
+    console(format_label("render targets destroyed"), stats.destroyed);
+    for (const auto& target: targets) {
+        console(format_label("render target"),
+                target.width, "x", target.height,
+                target.msaa_samples > 0 ? " MSAA x" + std::to_string(target.msaa_samples) : "",
+                target.in_use ? " ( live )" : " ( idle )");
+    }
+}
+
+uint64_t RenderTargetPool::estimate_bytes(const Target& target) {
+    const uint64_t pixels  = static_cast<uint64_t>(target.width) * static_cast<uint64_t>(target.height);
+    const uint64_t samples = static_cast<uint64_t>(std::max(1, target.msaa_samples));
+    // NOTE RGBA8 color attachment + DEPTH24_STENCIL8 renderbuffer
+    return pixels * samples * (4 + 4);
+}
+
+void RenderTargetPool::destroy(const Target& target) {
+    if (target.graphics == nullptr) {
+        return;
+    }
+    target.graphics->release_framebuffer();
+    delete target.graphics;
+    destroyed_count++;
+}
+
+/* --- PingPongTarget --- */
+
+PingPongTarget::PingPongTarget(RenderTargetPool& pool, const int width, const int height, const int msaa_samples) : pool(pool) {
+    targets[0] = pool.acquire(width, height, msaa_samples);
+    targets[1] = pool.acquire(width, height, msaa_samples);
+}
+
+PingPongTarget::~PingPongTarget() {
+    pool.release(targets[0]);
+    pool.release(targets[1]);
+}
@@ -0,0 +1,119 @@
+/*
+ * Umfeld
+ *
+ * This file is part of the *Umfeld* library (https://github.com/dennisppaul/umfeld).
+ * Copyright (c) 2025 Dennis P Paul.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+
+#include "SkylinePacker.h"
+
+using namespace umfeld;
+
+SkylinePacker::SkylinePacker(const int width, const int height) {
+    reset(width, height);
+}
+
+void SkylinePacker::reset(const int width, const int height) {
+    this->width  = width;
+    this->height = height;
+    skyline.clear();
+    skyline.push_back(SkylineNode{0, 0, width});
+}
+
+/**
+ * finds the lowest position in the skyline that can hold a block and adds the block to the skyline.
+ * returns false if the block does not fit.
+ */
+bool SkylinePacker::pack(const int block_width, const int block_height, int& x, int& y) {
+    int    best_bottom = INT_MAX;
+    int    best_width  = INT_MAX;
+    size_t best_index  = SIZE_MAX;
+    for (size_t i = 0; i < skyline.size(); ++i) {
+        const int fit_y = fit(i, block_width, block_height);
+        if (fit_y < 0) {
+            continue;
+        }
+        const int bottom = fit_y + block_height;
+        if (bottom < best_bottom || (bottom == best_bottom && skyline[i].width < best_width)) {
+            best_bottom = bottom;
+            best_width  = skyline[i].width;
+            best_index  = i;
+        }
+    }
+    if (best_index == SIZE_MAX) {
+        return false;
+    }
+    x = skyline[best_index].x;
+    y = best_bottom - block_height;
+    add(best_index, x, y, block_width, block_height);
+    return true;
+}
+
+int SkylinePacker::fit(size_t node_index, const int block_width, const int block_height) const {
+    const int x = skyline[node_index].x;
+    if (x + block_width > width) {
+        return -1;
+    }
+    int width_left = block_width;
+    int y          = skyline[node_index].y;
+    while (width_left > 0) {
+        if (node_index >= skyline.size()) {
+            return -1;
+        }
+        y = std::max(y, skyline[node_index].y);
+        if (y + block_height > height) {
+            return -1;
+        }
+        width_left -= skyline[node_index].width;
+        node_index++;
+    }
+    return y;
+}
+
+void SkylinePacker::add(const size_t node_index, const int x, const int y, const int block_width, const int block_height) {
+    skyline.insert(skyline.begin() + static_cast<long>(node_index), SkylineNode{x, y + block_height, block_width});
+
+    /* shrink or remove nodes that are covered by the new node */
+    for (size_t i = node_index + 1; i < skyline.size(); ++i) {
+        const SkylineNode& previous   = skyline[i - 1];
+        const int          previous_x = previous.x + previous.width;
+        if (skyline[i].x >= previous_x) {
+            break;
+        }
+        const int shrink = previous_x - skyline[i].x;
+        skyline[i].x += shrink;
+        skyline[i].width -= shrink;
+        if (skyline[i].width > 0) {
+            break;
+        }
+        skyline.erase(skyline.begin() + static_cast<long>(i));
+        --i;
+    }
+
+    /* merge neighboring nodes at the same height */
+    for (size_t i = 0; i + 1 < skyline.size();) {
+        if (skyline[i].y == skyline[i + 1].y) {
+            skyline[i].width += skyline[i + 1].width;
+            skyline.erase(skyline.begin() + static_cast<long>(i + 1));
+        } else {
+            ++i;
+        }
+    }
+}
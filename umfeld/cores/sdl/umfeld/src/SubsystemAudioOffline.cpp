@@ -0,0 +1,421 @@
+/*
+ * Umfeld
+ *
+ * This file is part of the *Umfeld* library (https://github.com/dennisppaul/umfeld).
+ * Copyright (c) 2025 Dennis P Paul.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+#include "Umfeld.h"
+#include "Subsystems.h"
+#include "PAudio.h"
+#include "BoundedQueue.h"
+#include "audio/AudioFileReader.h"
+#include "audio/AudioFileWriter.h"
+
+/**
+ * offline audio subsystem. renders the audio callbacks without an audio device as fast as the CPU allows
+ * ( e.g to render stems or to test patches on machines without a sound card ). the rendered output of
+ * each audio device is streamed to a WAV file by a writer thread.
+ *
+ * <code>
+ * void settings() {
+ *     create_subsystem_audio = umfeld_create_subsystem_audio_offline;
+ *     subsystem::audio_offline::set_output_file("render.wav");
+ *     subsystem::audio_offline::set_duration(60);
+ *     audio(0, 2);
+ * }
+ * </code>
+ */
+
+namespace umfeld::subsystem::audio_offline {
+    enum class Input {
+        SILENCE,
+        FILE,
+        GENERATOR
+    };
+
+    static std::string                                       _output_file;
+    static float                                             _duration_seconds = 0.0f;
+    static Input                                             _input            = Input::SILENCE;
+    static std::string                                       _input_file;
+    static std::function<float(uint64_t frame, int channel)> _input_generator;
+    static std::atomic_bool                                  _is_finished{false};
+    static std::atomic<float>                                _realtime_factor{0.0f};
+
+    void set_output_file(const std::string& file_path) {
+        _output_file = file_path;
+    }
+
+    void set_duration(const float seconds) {
+        _duration_seconds = std::max(0.0f, seconds);
+    }
+
+    void set_input_silence() {
+        _input = Input::SILENCE;
+    }
+
+    void set_input_file(const std::string& file_path) {
+        _input      = Input::FILE;
+        _input_file = file_path;
+    }
+
+    void set_input_generator(const std::function<float(uint64_t frame, int channel)>& generator) {
+        _input           = Input::GENERATOR;
+        _input_generator = generator;
+    }
+
+    bool is_finished() {
+        return _is_finished;
+    }
+
+    float get_realtime_factor() {
+        return _realtime_factor;
+    }
+} // namespace umfeld::subsystem::audio_offline
+
+namespace umfeld::subsystem {
+    static constexpr uint32_t OFFLINE_SAMPLE_RATE     = 48000;
+    static constexpr uint32_t OFFLINE_BUFFER_SIZE     = 512;
+    static constexpr int8_t   OFFLINE_INPUT_CHANNELS  = 1;
+    static constexpr int8_t   OFFLINE_OUTPUT_CHANNELS = 2;
+    static constexpr int      OFFLINE_WRITER_BLOCKS   = 32; // NOTE blocks in flight between render and writer thread
+
+    struct PAudioOffline {
+        PAudio*                               audio_device{nullptr};
+        bool                                  is_primary{false}; // NOTE first device, reports to `audio_offline` and writes to the output file
+        std::thread                           render_thread;
+        std::thread                           writer_thread;
+        std::atomic_bool                      is_running{false};
+        std::atomic_bool                      is_paused{false};
+        std::atomic_bool                      is_finished{false};
+        bool                                  reported{false};
+        uint64_t                              frames_rendered{0};
+        double                                elapsed_seconds{0.0};
+        std::chrono::steady_clock::time_point start_time;
+        std::string                           output_file;
+        AudioFileWriter*                      writer{nullptr};
+        BoundedQueue<float*>                  free_blocks{OFFLINE_WRITER_BLOCKS};
+        BoundedQueue<float*>                  written_blocks{OFFLINE_WRITER_BLOCKS + 1}; // NOTE +1 for end marker
+        std::vector<float*>                   blocks;
+        float*                                input_file_buffer{nullptr}; // NOTE interleaved
+        uint64_t                              input_file_length{0};
+        uint32_t                              input_file_channels{0};
+    };
+
+    static std::vector<PAudioOffline*> _audio_devices; // NOTE only accessed from the main thread
+    static bool                        _is_setup{false};
+
+    static const char* name() {
+        return "Offline Audio";
+    }
+
+    static void set_flags(uint32_t& subsystem_flags) {}
+
+    static bool init() {
+        console("initializing offline audio system");
+        return true;
+    }
+
+    static void fill_input(const PAudioOffline* _device, const uint64_t frame) {
+        const PAudio* _audio = _device->audio_device;
+        if (_audio->input_buffer == nullptr || _audio->input_channels <= 0) {
+            return;
+        }
+        const int channels = _audio->input_channels;
+        const int frames   = static_cast<int>(_audio->buffer_size);
+        switch (audio_offline::_input) {
+            case audio_offline::Input::FILE:
+                if (_device->input_file_buffer != nullptr && _device->input_file_length > 0) {
+                    for (int i = 0; i < frames; ++i) {
+                        const uint64_t file_frame = (frame + i) % _device->input_file_length;
+                        for (int c = 0; c < channels; ++c) {
+                            const uint32_t file_channel            = c % _device->input_file_channels;
+                            _audio->input_buffer[i * channels + c] = _device->input_file_buffer[file_frame * _device->input_file_channels + file_channel];
+                        }
+                    }
+                    return;
+                }
+                break;
+            case audio_offline::Input::GENERATOR:
+                if (audio_offline::_input_generator) {
+                    for (int i = 0; i < frames; ++i) {
+                        for (int c = 0; c < channels; ++c) {
+                            _audio->input_buffer[i * channels + c] = audio_offline::_input_generator(frame + i, c);
+                        }
+                    }
+                    return;
+                }
+                break;
+            case audio_offline::Input::SILENCE:
+                break;
+        }
+        std::fill_n(_audio->input_buffer, frames * channels, 0.0f);
+    }
+
+    static void process_audio_block(PAudio* _audio) {
+        const auto begin = _audio->telemetry.begin_block(_audio->buffer_size, _audio->sample_rate);
+
+        // NOTE for main audio device
+        if (audio_device != nullptr) {
+            if (_audio == audio_device) {
+                run_audioEvent_callback();
+                if (enable_audio_per_sample_processing) {
+                    PAudio::acquire_audio_buffer_per_sample(audio_device);
+                }
+            }
+        }
+
+        // NOTE for all registered audio devices ( including main audio device )
+        run_audioEventPAudio_callback(*_audio);
+
+        // NOTE mix audio sources ( e.g movies ) into main audio device
+        if (_audio == audio_device) {
+            mix_audio_sources(audio_device);
+        }
+
+        _audio->telemetry.end_block(begin);
+    }
+
+    static void finish(PAudioOffline* _device) {
+        _device->elapsed_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - _device->start_time).count();
+        if (_device->is_primary) {
+            const double rendered_seconds = static_cast<double>(_device->frames_rendered) / _device->audio_device->sample_rate;
+            audio_offline::_realtime_factor = _device->elapsed_seconds > 0.0 ? static_cast<float>(rendered_seconds / _device->elapsed_seconds) : 0.0f;
+            audio_offline::_is_finished     = true;
+        }
+        _device->is_finished = true;
+    }
+
+    static void render_loop(PAudioOffline* _device) {
+        PAudio*        _audio       = _device->audio_device;
+        const uint64_t total_frames = static_cast<uint64_t>(static_cast<double>(audio_offline::_duration_seconds) * _audio->sample_rate);
+        const size_t   block_size   = static_cast<size_t>(_audio->buffer_size) * _audio->output_channels;
+        while (_device->is_running && (total_frames == 0 || _device->frames_rendered < total_frames)) {
+            if (_device->is_paused) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                continue;
+            }
+            fill_input(_device, _device->frames_rendered);
+            process_audio_block(_audio);
+            if (_device->writer != nullptr && block_size > 0) {
+                float* block = nullptr;
+                if (!_device->free_blocks.pop(block)) {
+                    break;
+                }
+                std::memcpy(block, _audio->output_buffer, block_size * sizeof(float));
+                _device->written_blocks.push(block);
+            }
+            _device->frames_rendered += _audio->buffer_size;
+        }
+        if (_device->writer != nullptr) {
+            _device->written_blocks.push(nullptr); // NOTE end marker, writer thread finishes
+        } else {
+            finish(_device);
+        }
+    }
+
+    static void writer_loop(PAudioOffline* _device) {
+        float* block = nullptr;
+        while (_device->written_blocks.pop(block) && block != nullptr) {
+            _device->writer->write(_device->audio_device->buffer_size, block);
+            _device->free_blocks.push(block);
+        }
+        _device->writer->close();
+        finish(_device);
+    }
+
+    static void load_input_file(PAudioOffline* _device) {
+        if (audio_offline::_input != audio_offline::Input::FILE) {
+            return;
+        }
+        const std::string absolute_path = resolve_data_path(audio_offline::_input_file);
+        unsigned int      channels;
+        unsigned int      sample_rate;
+        drwav_uint64      length;
+        _device->input_file_buffer = AudioFileReader::load(absolute_path, channels, sample_rate, length);
+        if (_device->input_file_buffer == nullptr) {
+            warning("offline audio: could not load input file '", audio_offline::_input_file, "' using silence");
+            return;
+        }
+        if (sample_rate != _device->audio_device->sample_rate) {
+            warning("offline audio: input file sample rate ( ", sample_rate, " Hz ) differs from device ( ", _device->audio_device->sample_rate, " Hz )");
+        }
+        _device->input_file_length   = length;
+        _device->input_file_channels = channels;
+    }
+
+    static std::string get_output_file(const PAudioOffline* _device) {
+        if (audio_offline::_output_file.empty() || _device->audio_device->output_channels <= 0) {
+            return "";
+        }
+        if (_device->is_primary) {
+            return audio_offline::_output_file;
+        }
+        // NOTE additional devices write to `<name>-<unique_id>.wav`
+        const std::string& path = audio_offline::_output_file;
+        const size_t       dot  = path.find_last_of('.');
+        const std::string  id   = "-" + std::to_string(_device->audio_device->unique_id);
+        return dot == std::string::npos ? path + id : path.substr(0, dot) + id + path.substr(dot);
+    }
+
+    static void start_rendering(PAudioOffline* _device) {
+        PAudio* _audio       = _device->audio_device;
+        _device->output_file = get_output_file(_device);
+        load_input_file(_device);
+        if (!_device->output_file.empty()) {
+            _device->writer = new AudioFileWriter(_audio->sample_rate, _audio->output_channels);
+            if (_device->writer->open(_device->output_file)) {
+                const size_t block_size = static_cast<size_t>(_audio->buffer_size) * _audio->output_channels;
+                for (int i = 0; i < OFFLINE_WRITER_BLOCKS; ++i) {
+                    _device->blocks.push_back(new float[block_size]);
+                    _device->free_blocks.push(_device->blocks.back());
+                }
+            } else {
+                error("offline audio: could not open output file: ", _device->output_file);
+                delete _device->writer;
+                _device->writer = nullptr;
+            }
+        }
+        const std::string output = _device->writer != nullptr ? " to '" + _device->output_file + "'" : "";
+        if (audio_offline::_duration_seconds > 0.0f) {
+            console("offline audio: rendering ", audio_offline::_duration_seconds, " s", output);
+        } else {
+            console("offline audio: rendering until shutdown", output);
+        }
+        _device->is_running = true;
+        _device->start_time = std::chrono::steady_clock::now();
+        if (_device->writer != nullptr) {
+            _device->writer_thread = std::thread(writer_loop, _device);
+        }
+        _device->render_thread = std::thread(render_loop, _device);
+    }
+
+    static void report(PAudioOffline* _device) {
+        if (_device->reported) {
+            return;
+        }
+        _device->reported             = true;
+        const double rendered_seconds = static_cast<double>(_device->frames_rendered) / _device->audio_device->sample_rate;
+        console(fl("offline audio rendered"), rendered_seconds, " s in ", _device->elapsed_seconds, " s",
+                " ( realtime factor: ", _device->elapsed_seconds > 0.0 ? rendered_seconds / _device->elapsed_seconds : 0.0, " )");
+    }
+
+    static void setup_post() {
+        for (const auto _device: _audio_devices) {
+            start_rendering(_device);
+        }
+        _is_setup = true;
+    }
+
+    static void update_loop() {
+        for (const auto _device: _audio_devices) {
+            _device->audio_device->telemetry.update_log();
+            if (_device->is_finished) {
+                report(_device);
+            }
+        }
+    }
+
+    static void shutdown() {
+        for (const auto _device: _audio_devices) {
+            _device->is_running = false;
+            _device->is_paused  = false;
+            if (_device->render_thread.joinable()) {
+                _device->render_thread.join();
+            }
+            if (_device->writer_thread.joinable()) {
+                _device->writer_thread.join();
+            }
+            if (_device->is_finished) {
+                report(_device);
+            }
+            delete _device->writer;
+            for (const auto block: _device->blocks) {
+                delete[] block;
+            }
+            free(_device->input_file_buffer); // NOTE allocated by dr_libs with `malloc`
+            // NOTE buffers of `PAudio` need to be handled by caller of `create_audio`
+            delete _device;
+        }
+        _audio_devices.clear();
+        _is_setup = false;
+    }
+
+    static void start(PAudio* device) {
+        for (const auto _device: _audio_devices) {
+            if (_device->audio_device == device) {
+                _device->is_paused = false;
+            }
+        }
+    }
+
+    static void stop(PAudio* device) {
+        for (const auto _device: _audio_devices) {
+            if (_device->audio_device == device) {
+                _device->is_paused = true;
+            }
+        }
+    }
+
+    static PAudio* create_audio(const AudioUnitInfo* device_info) {
+        const auto _audio = new PAudio{device_info};
+        if (_audio->input_channels == DEFAULT) {
+            _audio->input_channels = OFFLINE_INPUT_CHANNELS;
+        }
+        if (_audio->output_channels == DEFAULT) {
+            _audio->output_channels = OFFLINE_OUTPUT_CHANNELS;
+        }
+        if (_audio->sample_rate == DEFAULT_SAMPLE_RATE) {
+            _audio->sample_rate = OFFLINE_SAMPLE_RATE;
+        }
+        if (_audio->buffer_size == DEFAULT_AUDIO_BUFFER_SIZE) {
+            _audio->buffer_size = OFFLINE_BUFFER_SIZE;
+        }
+        _audio->input_device_name  = "offline";
+        _audio->output_device_name = "offline";
+        _audio->input_buffer       = new float[_audio->input_channels * _audio->buffer_size]{};
+        _audio->output_buffer      = new float[_audio->output_channels * _audio->buffer_size]{};
+        _audio->unique_id          = audio_unique_device_id++;
+
+        const auto _device    = new PAudioOffline();
+        _device->audio_device = _audio;
+        _device->is_primary   = _audio_devices.empty();
+        _audio_devices.push_back(_device);
+        // NOTE devices created before setup start rendering in `setup_post()`, later devices start immediately
+        if (_is_setup) {
+            start_rendering(_device);
+        }
+        return _audio;
+    }
+} // namespace umfeld::subsystem
+
+umfeld::SubsystemAudio* umfeld_create_subsystem_audio_offline() {
+    auto* audio         = new umfeld::SubsystemAudio{};
+    audio->set_flags    = umfeld::subsystem::set_flags;
+    audio->init         = umfeld::subsystem::init;
+    audio->setup_post   = umfeld::subsystem::setup_post;
+    audio->update_loop  = umfeld::subsystem::update_loop;
+    audio->shutdown     = umfeld::subsystem::shutdown;
+    audio->name         = umfeld::subsystem::name;
+    audio->start        = umfeld::subsystem::start;
+    audio->stop         = umfeld::subsystem::stop;
+    audio->create_audio = umfeld::subsystem::create_audio;
+    return audio;
+}
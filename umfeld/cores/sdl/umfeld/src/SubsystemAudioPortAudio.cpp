@@ -127,7 +127,11 @@ namespace umfeld::subsystem {
         }
 
         void loop() {
-            if (audio == nullptr || audio->threaded) {
+            if (audio == nullptr) {
+                return;
+            }
+            audio->telemetry.update_log();
+            if (audio->threaded) {
                 return;
             }
             if (isPaused) {
@@ -151,7 +155,9 @@ namespace umfeld::subsystem {
             }
             if (audio->input_channels > 0 && availIn >= audio->buffer_size) {
                 const PaError err = Pa_ReadStream(stream, audio->input_buffer, audio->buffer_size);
-                if (err != paNoError) {
+                if (err == paInputOverflowed) {
+                    audio->telemetry.count_overrun();
+                } else if (err != paNoError) {
                     error("Error reading from stream: ", Pa_GetErrorText(err));
                     last_audio_update = now;
                     return;
@@ -169,6 +175,7 @@ namespace umfeld::subsystem {
             // Run callbacks only when enough frames for both sides (or side unused)
             if ((availIn >= audio->buffer_size || audio->input_channels == 0) &&
                 (availOut >= audio->buffer_size || audio->output_channels == 0)) {
+                const auto begin = audio->telemetry.begin_block(audio->buffer_size, audio->sample_rate);
                 if (audio_device != nullptr) {
                     if (audio == audio_device) {
                         run_audioEvent_callback();
@@ -178,11 +185,17 @@ namespace umfeld::subsystem {
                     }
                 }
                 run_audioEventPAudio_callback(*audio);
+                if (audio == audio_device) {
+                    mix_audio_sources(audio);
+                }
+                audio->telemetry.end_block(begin);
             }
 
             if (audio->output_channels > 0 && availOut >= audio->buffer_size) {
                 const PaError err = Pa_WriteStream(stream, audio->output_buffer, audio->buffer_size);
-                if (err != paNoError) {
+                if (err == paOutputUnderflowed) {
+                    audio->telemetry.count_underrun();
+                } else if (err != paNoError) {
                     error("Error writing to stream: ", Pa_GetErrorText(err));
                 }
             }
@@ -242,9 +255,17 @@ namespace umfeld::subsystem {
                                   void*               outputBuffer,
                                   const unsigned long framesPerBuffer,
                                   const PaStreamCallbackTimeInfo* /*timeInfo*/,
-                                  PaStreamCallbackFlags /*statusFlags*/,
-                                  void* userData) {
-            const auto* audio = static_cast<PAudio*>(userData);
+                                  const PaStreamCallbackFlags statusFlags,
+                                  void*                       userData) {
+            auto* audio = static_cast<PAudio*>(userData);
+
+            if (statusFlags & (paInputUnderflow | paOutputUnderflow)) {
+                audio->telemetry.count_underrun();
+            }
+            if (statusFlags & (paInputOverflow | paOutputOverflow)) {
+                audio->telemetry.count_overrun();
+            }
+            const auto begin = audio->telemetry.begin_block(framesPerBuffer, audio->sample_rate);
 
             if (audio->input_channels > 0 && inputBuffer != nullptr) {
                 memcpy(audio->input_buffer, inputBuffer, framesPerBuffer * audio->input_channels * sizeof(float));
@@ -256,6 +277,10 @@ namespace umfeld::subsystem {
                 }
             }
             run_audioEventPAudio_callback(*audio);
+            if (audio == audio_device) {
+                mix_audio_sources(audio);
+            }
+            audio->telemetry.end_block(begin);
 
             if (audio->output_channels > 0 && outputBuffer != nullptr) {
                 memcpy(outputBuffer, audio->output_buffer, framesPerBuffer * audio->output_channels * sizeof(float));
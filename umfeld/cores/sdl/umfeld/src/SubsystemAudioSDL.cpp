@@ -63,6 +63,8 @@ namespace umfeld::subsystem {
 
     static std::vector<PAudioSDL*> _audio_devices;
 
+    static constexpr int MAX_INPUT_BLOCKS_QUEUED = 4; // NOTE more queued input is counted as overrun
+
     static const char* name() {
         return "SDL Audio";
     }
@@ -298,69 +300,144 @@ namespace umfeld::subsystem {
         }
     }
 
-    static void update_audio_streams(const PAudioSDL* const _device) {
-        const int _num_sample_frames = _device->audio_device->buffer_size;
+    static void read_input_stream(const PAudioSDL* const _device) {
+        SDL_AudioStream* _stream = _device->sdl_input_stream;
+        if (_stream == nullptr || SDL_AudioStreamDevicePaused(_stream)) {
+            return;
+        }
+        const int input_bytes_available = SDL_GetAudioStreamAvailable(_stream);
+        const int num_required_bytes    = static_cast<int>(_device->audio_device->buffer_size * _device->audio_device->input_channels * sizeof(float));
+        if (input_bytes_available > num_required_bytes * MAX_INPUT_BLOCKS_QUEUED) {
+            _device->audio_device->telemetry.count_overrun();
+        }
+        if (input_bytes_available < num_required_bytes && _device->audio_device->telemetry.is_running()) {
+            _device->audio_device->telemetry.count_underrun(); // NOTE previous input block is reused
+        }
+        if (input_bytes_available >= num_required_bytes) {
+            float* buffer = _device->audio_device->input_buffer;
+            if (buffer != nullptr) {
+                if (SDL_GetAudioStreamData(_stream, buffer, num_required_bytes) < 0) {
+                    warning_in_function("could not acquire data from ", _device->audio_device->input_device_name, " input stream: ", SDL_GetError());
+                }
+                if constexpr (UMFELD_SDL_AUDIO_FORMAT != SDL_AUDIO_F32) {
+                    warning_in_function("currently only 'SDL_AUDIO_F32' is supported ( as defined in 'UMFELD_SDL_AUDIO_FORMAT' )");
+                }
+            }
+        }
+    }
 
-        /* prepare samples from input stream */
+    static void process_audio_block(const PAudioSDL* const _device, const bool new_callback = true) {
+        AudioTelemetry& telemetry = _device->audio_device->telemetry;
+        const auto      begin     = telemetry.begin_block(_device->audio_device->buffer_size, _device->audio_device->sample_rate, new_callback);
 
-        if (!SDL_AudioDevicePaused(_device->logical_input_device_id)) {
-            if (_device->sdl_input_stream != nullptr) {
-                SDL_AudioStream* _stream = _device->sdl_input_stream;
-                if (!SDL_AudioStreamDevicePaused(_stream)) {
-                    const int input_bytes_available = SDL_GetAudioStreamAvailable(_stream);
-                    const int num_required_bytes    = static_cast<int>(_num_sample_frames) * _device->audio_device->input_channels * sizeof(float);
-                    if (input_bytes_available >= num_required_bytes) {
-                        float* buffer = _device->audio_device->input_buffer;
-                        if (buffer != nullptr) {
-                            if (SDL_GetAudioStreamData(_stream, buffer, num_required_bytes) < 0) {
-                                warning_in_function("could not acquire data from ", _device->audio_device->input_device_name, " input stream: ", SDL_GetError());
-                            }
-                            if constexpr (UMFELD_SDL_AUDIO_FORMAT != SDL_AUDIO_F32) {
-                                warning_in_function("currently only 'SDL_AUDIO_F32' is supported ( as defined in 'UMFELD_SDL_AUDIO_FORMAT' )");
-                            }
-                        }
-                    }
+        // NOTE for main audio device
+        if (audio_device != nullptr) {
+            if (_device->audio_device == audio_device) {
+                run_audioEvent_callback();
+                if (enable_audio_per_sample_processing) {
+                    PAudio::acquire_audio_buffer_per_sample(audio_device);
                 }
             }
         }
 
+        // NOTE for all registered audio devices ( including main audio device )
+        run_audioEventPAudio_callback(*_device->audio_device);
+
+        // NOTE mix audio sources ( e.g movies ) into main audio device
+        if (_device->audio_device == audio_device) {
+            mix_audio_sources(audio_device);
+        }
+
+        telemetry.end_block(begin);
+    }
+
+    static void write_output_stream(const PAudioSDL* const _device, SDL_AudioStream* _stream) {
+        const int    num_processed_bytes = static_cast<int>(_device->audio_device->buffer_size * _device->audio_device->output_channels * sizeof(float));
+        const float* buffer              = _device->audio_device->output_buffer;
+        if (buffer != nullptr) {
+            if constexpr (UMFELD_SDL_AUDIO_FORMAT != SDL_AUDIO_F32) {
+                warning_in_function("currently only 'SDL_AUDIO_F32' is supported ( as defined in 'UMFELD_SDL_AUDIO_FORMAT' )");
+            }
+            if (!SDL_PutAudioStreamData(_stream, buffer, num_processed_bytes)) {
+                warning_in_function("could not send data to ", _device->audio_device->output_device_name, " output stream: ", SDL_GetError());
+            }
+        }
+    }
+
+    static void update_audio_streams(const PAudioSDL* const _device) {
+        /* prepare samples from input stream */
+
+        if (!SDL_AudioDevicePaused(_device->logical_input_device_id)) {
+            read_input_stream(_device);
+        }
+
         /* request samples for output stream */
 
         if (!SDL_AudioDevicePaused(_device->logical_output_device_id)) {
             if (_device->sdl_output_stream != nullptr) {
                 SDL_AudioStream* _stream = _device->sdl_output_stream;
                 if (!SDL_AudioStreamDevicePaused(_stream)) {
-                    const int request_num_sample_frames = _device->audio_device->buffer_size;
-                    if (SDL_GetAudioStreamQueued(_stream) < request_num_sample_frames) {
-                        // NOTE for main audio device
-                        if (audio_device != nullptr) {
-                            if (_device->audio_device == audio_device) {
-                                run_audioEvent_callback();
-                                if (enable_audio_per_sample_processing) {
-                                    PAudio::acquire_audio_buffer_per_sample(audio_device);
-                                }
-                            }
-                        }
-
-                        // NOTE for all registered audio devices ( including main audio device )
-                        run_audioEventPAudio_callback(*_device->audio_device);
-
-                        const int    num_processed_bytes = static_cast<int>(_num_sample_frames) * _device->audio_device->output_channels * sizeof(float);
-                        const float* buffer              = _device->audio_device->output_buffer;
-                        if (buffer != nullptr) {
-                            if constexpr (UMFELD_SDL_AUDIO_FORMAT != SDL_AUDIO_F32) {
-                                warning_in_function("currently only 'SDL_AUDIO_F32' is supported ( as defined in 'UMFELD_SDL_AUDIO_FORMAT' )");
-                            }
-                            if (!SDL_PutAudioStreamData(_stream, buffer, num_processed_bytes)) {
-                                warning_in_function("could not send data to ", _device->audio_device->output_device_name, " output stream: ", SDL_GetError());
-                            }
+                    const int num_block_bytes = static_cast<int>(_device->audio_device->buffer_size * _device->audio_device->output_channels * sizeof(float));
+                    const int num_queued_bytes = SDL_GetAudioStreamQueued(_stream);
+                    if (num_queued_bytes < num_block_bytes) {
+                        if (num_queued_bytes == 0 && _device->audio_device->telemetry.is_running()) {
+                            _device->audio_device->telemetry.count_underrun(); // NOTE device drained the stream
                         }
+                        process_audio_block(_device);
+                        write_output_stream(_device, _stream);
                     }
                 }
             }
         }
     }
 
+    /**
+     * called by SDL from the audio device thread whenever the output device requests samples. blocks are
+     * produced until the requested amount plus `queue_depth - 1` additional blocks are queued.
+     */
+    static void SDLCALL output_stream_callback(void* userdata, SDL_AudioStream* stream, const int additional_amount, const int total_amount) {
+        const auto _device = static_cast<PAudioSDL*>(userdata);
+        if (_device == nullptr || _device->audio_device == nullptr || !_device->is_running) {
+            return;
+        }
+        const int num_block_bytes = static_cast<int>(_device->audio_device->buffer_size * _device->audio_device->output_channels * sizeof(float));
+        if (num_block_bytes <= 0) {
+            return;
+        }
+        const int queue_depth   = std::max(1, _device->audio_device->queue_depth);
+        const int target_amount = total_amount + (queue_depth - 1) * num_block_bytes;
+        int       queued_amount = total_amount - additional_amount; // NOTE left over from previous blocks
+        bool      new_callback  = true;                             // NOTE jitter is measured per callback, not per block
+        while (queued_amount < target_amount) {
+            read_input_stream(_device);
+            process_audio_block(_device, new_callback);
+            write_output_stream(_device, stream);
+            queued_amount += num_block_bytes;
+            new_callback = false;
+        }
+    }
+
+    /**
+     * called by SDL from the audio device thread whenever the input device delivered samples. only used
+     * for devices without output, otherwise input is consumed in `output_stream_callback`.
+     */
+    static void SDLCALL input_stream_callback(void* userdata, SDL_AudioStream* stream, int /*additional_amount*/, int /*total_amount*/) {
+        const auto _device = static_cast<PAudioSDL*>(userdata);
+        if (_device == nullptr || _device->audio_device == nullptr || !_device->is_running) {
+            return;
+        }
+        const int num_block_bytes = static_cast<int>(_device->audio_device->buffer_size * _device->audio_device->input_channels * sizeof(float));
+        if (num_block_bytes <= 0) {
+            return;
+        }
+        bool new_callback = true;
+        while (SDL_GetAudioStreamAvailable(stream) >= num_block_bytes) {
+            read_input_stream(_device);
+            process_audio_block(_device, new_callback);
+            new_callback = false;
+        }
+    }
+
     static int update_loop_threaded(void* userdata) {
         const auto audio_device_sdl = static_cast<PAudioSDL*>(userdata);
         if (audio_device_sdl == nullptr) {
@@ -384,7 +461,8 @@ namespace umfeld::subsystem {
         // NOTE consult https://wiki.libsdl.org/SDL3/Tutorials/AudioStream
         for (const auto _device: _audio_devices) {
             if (_device != nullptr && _device->audio_device != nullptr) {
-                if (!_device->audio_device->threaded) {
+                _device->audio_device->telemetry.update_log();
+                if (!_device->audio_device->threaded && !_device->audio_device->callback) {
                     update_audio_streams(_device);
                 }
             }
@@ -394,7 +472,16 @@ namespace umfeld::subsystem {
     static void shutdown() {
         for (const auto audio_device_sdl: _audio_devices) {
             if (audio_device_sdl != nullptr) {
-                if (audio_device_sdl->audio_device != nullptr && audio_device_sdl->audio_device->threaded) {
+                if (audio_device_sdl->audio_device != nullptr && audio_device_sdl->audio_device->callback) {
+                    // NOTE setting the callbacks locks the streams i.e waits for a running callback to return
+                    audio_device_sdl->is_running = false;
+                    if (audio_device_sdl->sdl_output_stream != nullptr) {
+                        SDL_SetAudioStreamGetCallback(audio_device_sdl->sdl_output_stream, nullptr, nullptr);
+                    }
+                    if (audio_device_sdl->sdl_input_stream != nullptr) {
+                        SDL_SetAudioStreamPutCallback(audio_device_sdl->sdl_input_stream, nullptr, nullptr);
+                    }
+                } else if (audio_device_sdl->audio_device != nullptr && audio_device_sdl->audio_device->threaded) {
                     console("waiting for audio update thread to finish: ", audio_device_sdl->audio_device->input_device_name, "+", audio_device_sdl->audio_device->output_device_name);
                     audio_device_sdl->is_running = false;
                     SDL_WaitThread(audio_device_sdl->audio_thread_handle, nullptr);
@@ -637,8 +724,36 @@ namespace umfeld::subsystem {
         return true;
     }
 
+    static bool start_callback_update(PAudioSDL* const audio_device_sdl) {
+        console("creating audio device in callback mode: ",
+                audio_device_sdl->audio_device->input_device_name, "+",
+                audio_device_sdl->audio_device->output_device_name,
+                " ( queue depth: ", std::max(1, audio_device_sdl->audio_device->queue_depth), " )");
+        audio_device_sdl->is_running = true;
+        if (audio_device_sdl->sdl_output_stream != nullptr) {
+            if (!SDL_SetAudioStreamGetCallback(audio_device_sdl->sdl_output_stream, output_stream_callback, audio_device_sdl)) {
+                error("could not set audio output stream callback: ", SDL_GetError());
+                return false;
+            }
+        } else if (audio_device_sdl->sdl_input_stream != nullptr) {
+            if (!SDL_SetAudioStreamPutCallback(audio_device_sdl->sdl_input_stream, input_stream_callback, audio_device_sdl)) {
+                error("could not set audio input stream callback: ", SDL_GetError());
+                return false;
+            }
+        }
+        return true;
+    }
+
     static void setup_post() {
         for (const auto audio_device_sdl: _audio_devices) {
+            if (audio_device_sdl->audio_device->callback) {
+                if (!start_callback_update(audio_device_sdl)) {
+                    warning("failed to start audio callback for device: ",
+                            audio_device_sdl->audio_device->input_device_name, "+",
+                            audio_device_sdl->audio_device->output_device_name);
+                }
+                continue;
+            }
             if (!start_threaded_update(audio_device_sdl)) {
                 warning("failed to start audio update thread for device: ",
                         audio_device_sdl->audio_device->input_device_name, "+",
@@ -650,7 +765,7 @@ namespace umfeld::subsystem {
     static PAudio* create_audio(const AudioUnitInfo* device_info) {
         const auto audio_device = new PAudio{device_info};
         register_audio_devices(audio_device);
-        // NOTE threaded audio update must be started manually
+        // NOTE threaded or callback audio update must be started manually
         return audio_device;
     }
 } // namespace umfeld::subsystem
@@ -0,0 +1,248 @@
+/*
+ * Umfeld
+ *
+ * This file is part of the *Umfeld* library (https://github.com/dennisppaul/umfeld).
+ * Copyright (c) 2025 Dennis P Paul.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+
+#include "Umfeld.h"
+#include "TextureAtlas.h"
+#include "PGraphics.h"
+
+using namespace umfeld;
+
+TextureAtlas::TextureAtlas(const int page_size, const int max_image_size, const int padding)
+    : page_size(page_size),
+      max_image_size(std::min(max_image_size, page_size - 2 * std::max(0, padding))),
+      padding(std::max(0, padding)) {}
+
+TextureAtlas::~TextureAtlas() {
+    clear();
+}
+
+bool TextureAtlas::accepts(const PImage* image) const {
+    if (image == nullptr || image->pixels == nullptr) {
+        return false;
+    }
+    // NOTE render targets are never packed, their pixels do not reflect the texture content
+    if (dynamic_cast<const PGraphics*>(image) != nullptr) {
+        return false;
+    }
+    const int w = static_cast<int>(image->width);
+    const int h = static_cast<int>(image->height);
+    if (w <= 0 || h <= 0 || w > max_image_size || h > max_image_size) {
+        return false;
+    }
+    // NOTE wrapping and mipmaps would sample neighboring images in the page
+    return image->get_texture_wrap() == CLAMP_TO_EDGE && !image->get_auto_generate_mipmap();
+}
+
+const TextureAtlas::Region* TextureAtlas::get_region(PGraphics* graphics, PImage* image) {
+    const auto it = regions.find(image);
+    if (it != regions.end()) {
+        return &it->second;
+    }
+    if (graphics == nullptr) {
+        return nullptr;
+    }
+    if (!accepts(image) || !insert(graphics, image)) {
+        rejected_images.insert(image);
+        return nullptr;
+    }
+    rejected_images.erase(image);
+    return &regions[image];
+}
+
+void TextureAtlas::update(PGraphics* graphics, PImage* image) {
+    const auto it = regions.find(image);
+    if (it == regions.end() || graphics == nullptr) {
+        return;
+    }
+    if (it->second.width != static_cast<int>(image->width) || it->second.height != static_cast<int>(image->height)) {
+        remove(image);
+        get_region(graphics, image);
+        return;
+    }
+    copy_into_page(graphics, it->second, image);
+}
+
+void TextureAtlas::remove(const PImage* image) {
+    rejected_images.erase(image);
+    const auto it = regions.find(image);
+    if (it == regions.end()) {
+        return;
+    }
+    const Region& region = it->second;
+    Page&         page   = pages[region.page_index];
+    const auto    area   = static_cast<uint64_t>(region.width + 2 * padding) * static_cast<uint64_t>(region.height + 2 * padding);
+    page.used_pixels -= std::min(page.used_pixels, area);
+    // NOTE space is only reclaimed by `repack()`
+    regions.erase(it);
+    region_images.erase(image);
+}
+
+void TextureAtlas::repack(PGraphics* graphics) {
+    if (graphics == nullptr) {
+        return;
+    }
+    // NOTE shapes that are already submitted still reference the old regions
+    graphics->flush();
+
+    std::vector<PImage*> images;
+    images.reserve(region_images.size());
+    for (const auto& [key, image]: region_images) {
+        images.push_back(image);
+    }
+    std::sort(images.begin(), images.end(), [](const PImage* a, const PImage* b) {
+        if (a->height != b->height) {
+            return a->height > b->height;
+        }
+        return a->width > b->width;
+    });
+
+    regions.clear();
+    region_images.clear();
+    for (auto& page: pages) {
+        reset_page(page);
+    }
+    for (PImage* image: images) {
+        if (!insert(graphics, image)) {
+            warning_in_function("could not repack image into atlas");
+        }
+    }
+    repack_count++;
+}
+
+void TextureAtlas::clear() {
+    for (const auto& page: pages) {
+        delete page.image;
+    }
+    pages.clear();
+    regions.clear();
+    region_images.clear();
+    rejected_images.clear();
+}
+
+TextureAtlas::Stats TextureAtlas::get_stats() const {
+    Stats stats;
+    stats.pages  = static_cast<int>(pages.size());
+    stats.images = static_cast<int>(regions.size());
+    for (const auto& page: pages) {
+        stats.used_pixels += page.used_pixels;
+        stats.total_pixels += static_cast<uint64_t>(page_size) * static_cast<uint64_t>(page_size);
+    }
+    stats.occupancy       = stats.total_pixels > 0 ? static_cast<float>(static_cast<double>(stats.used_pixels) / static_cast<double>(stats.total_pixels)) : 0.0f;
+    stats.repacks         = repack_count;
+    stats.rejected_images = static_cast<int>(rejected_images.size());
+    return stats;
+}
+
+void TextureAtlas::print_stats() const {
+    const Stats stats = get_stats();
+    console(format_label("texture atlas pages"), stats.pages, " ( ", page_size, "x", page_size, " )");
+    console(format_label("texture atlas images"), stats.images);
+    console(format_label("texture atlas occupancy"), stats.occupancy * 100.0f, "%");
+    console(format_label("texture atlas repacks"), stats.repacks);
+    console(format_label("texture atlas rejected images"), stats.rejected_images);
+}
+
+bool TextureAtlas::insert(PGraphics* graphics, PImage* image) {
+    const int           w            = static_cast<int>(image->width);
+    const int           h            = static_cast<int>(image->height);
+    const int           block_width  = w + 2 * padding;
+    const int           block_height = h + 2 * padding;
+    const TextureFilter filter       = image->get_texture_filter();
+
+    int x          = 0;
+    int y          = 0;
+    int page_index = -1;
+    for (size_t i = 0; i < pages.size(); ++i) {
+        if (pages[i].filter == filter && pack_into_page(static_cast<int>(i), block_width, block_height, x, y)) {
+            page_index = static_cast<int>(i);
+            break;
+        }
+    }
+    if (page_index < 0) {
+        page_index = add_page(filter);
+        if (!pack_into_page(page_index, block_width, block_height, x, y)) {
+            error_in_function("image does not fit into empty atlas page: ", w, "x", h);
+            return false;
+        }
+    }
+
+    Region region;
+    region.page       = pages[page_index].image;
+    region.page_index = page_index;
+    region.x          = x + padding;
+    region.y          = y + padding;
+    region.width      = w;
+    region.height     = h;
+    const auto size   = static_cast<float>(page_size);
+    region.uv         = glm::vec4(static_cast<float>(region.x) / size,
+                                  static_cast<float>(region.y) / size,
+                                  static_cast<float>(region.x + w) / size,
+                                  static_cast<float>(region.y + h) / size);
+    pages[page_index].used_pixels += static_cast<uint64_t>(block_width) * static_cast<uint64_t>(block_height);
+
+    regions[image]       = region;
+    region_images[image] = image;
+    copy_into_page(graphics, region, image);
+    return true;
+}
+
+bool TextureAtlas::pack_into_page(const int page_index, const int block_width, const int block_height, int& x, int& y) {
+    return pages[page_index].packer.pack(block_width, block_height, x, y);
+}
+
+int TextureAtlas::add_page(const TextureFilter filter) {
+    Page page;
+    page.image = new PImage(page_size, page_size);
+    page.image->set_texture_filter(filter);
+    page.image->set_texture_wrap(CLAMP_TO_EDGE);
+    page.filter = filter;
+    reset_page(page);
+    pages.push_back(page);
+    return static_cast<int>(pages.size()) - 1;
+}
+
+void TextureAtlas::reset_page(Page& page) const {
+    page.packer.reset(page_size, page_size);
+    page.used_pixels = 0;
+    if (page.image != nullptr && page.image->pixels != nullptr) {
+        std::fill_n(page.image->pixels, static_cast<size_t>(page_size) * static_cast<size_t>(page_size), 0x00000000);
+    }
+}
+
+/**
+ * copies the pixels of an image into its page region and uploads the region. the image border is
+ * extruded into the padding to avoid bleeding of neighboring images when sampling with `LINEAR`.
+ */
+void TextureAtlas::copy_into_page(PGraphics* graphics, const Region& region, const PImage* image) {
+    const int w            = region.width;
+    const int h            = region.height;
+    const int block_width  = w + 2 * padding;
+    const int block_height = h + 2 * padding;
+    block_buffer.resize(static_cast<size_t>(block_width) * static_cast<size_t>(block_height));
+    for (int by = 0; by < block_height; ++by) {
+        const int sy = std::clamp(by - padding, 0, h - 1);
+        for (int bx = 0; bx < block_width; ++bx) {
+            const int sx                        = std::clamp(bx - padding, 0, w - 1);
+            block_buffer[by * block_width + bx] = image->pixels[sy * w + sx];
+        }
+    }
+    region.page->update(graphics, block_buffer.data(), block_width, block_height, region.x - padding, region.y - padding);
+}
@@ -29,6 +29,7 @@
 #include "UmfeldDefines.h"
 #include "Umfeld.h"
 #include "PAudio.h"
+#include "ImageSequence.h"
 #include "UmfeldFunctionsAdditional.h"
 
 using namespace std::chrono;
@@ -598,8 +599,10 @@ SDL_AppResult SDL_AppInit(void** appstate, const int argc, char* argv[]) {
                 _audio_unit_info.sample_rate        = umfeld::audio_sample_rate;
                 // ReSharper restore CppDeprecatedEntity
                 DISABLE_WARNING_POP
-                _audio_unit_info.threaded = umfeld::run_audio_in_thread;
-                umfeld::audio_device      = umfeld::subsystem_audio->create_audio(&_audio_unit_info);
+                _audio_unit_info.threaded    = umfeld::run_audio_in_thread;
+                _audio_unit_info.callback    = umfeld::run_audio_in_callback;
+                _audio_unit_info.queue_depth = umfeld::audio_queue_depth;
+                umfeld::audio_device         = umfeld::subsystem_audio->create_audio(&_audio_unit_info);
             }
         }
     }
@@ -659,6 +662,8 @@ SDL_AppResult SDL_AppInit(void** appstate, const int argc, char* argv[]) {
         umfeld::audio_buffer_size        = umfeld::audio_device->buffer_size;
         umfeld::audio_sample_rate        = umfeld::audio_device->sample_rate;
         umfeld::run_audio_in_thread      = umfeld::audio_device->threaded;
+        umfeld::run_audio_in_callback    = umfeld::audio_device->callback;
+        umfeld::audio_queue_depth        = umfeld::audio_device->queue_depth;
         // ReSharper restore CppDeprecatedEntity
         DISABLE_WARNING_POP
     }
@@ -850,6 +855,9 @@ void SDL_AppQuit(void* appstate, SDL_AppResult result) {
         stop_update_thread();
     }
 
+    /* finish image sequences written with `saveFrame()` */
+    umfeld::ImageSequenceWriter::close_all();
+
     // NOTE 1. call `void umfeld::shutdown()`(?)
     //      2. clean up subsytems e.g audio, graphics, ...
     for (const umfeld::Subsystem* subsystem: umfeld::subsystems) {
@@ -44,6 +44,7 @@
 #include "SimplexNoise.h"
 #include "UmfeldFunctions.h"
 #include "UmfeldFunctionsAdditional.h"
+#include "ImageSequence.h"
 
 namespace umfeld {
 
@@ -1029,8 +1030,11 @@ namespace umfeld {
             stbi_write_bmp(filename.c_str(), _width, _height, DEFAULT_BYTES_PER_PIXELS, image->pixels);
         } else if (ends_with(filename, ".tga")) {
             stbi_write_tga(filename.c_str(), _width, _height, DEFAULT_BYTES_PER_PIXELS, image->pixels);
+        } else if (ends_with(filename, ".ufs")) {
+            // NOTE raw image sequences are appended frame by frame
+            ImageSequenceWriter::append_frame(filename, image);
         } else {
-            warning("Unsupported file format: ", filename, ". Supported formats are: .png, .jpg, .bmp, .tga");
+            warning("Unsupported file format: ", filename, ". Supported formats are: .png, .jpg, .bmp, .tga, .ufs");
         }
     }
 
@@ -1039,6 +1043,12 @@ namespace umfeld {
             return;
         }
 
+        // NOTE raw image sequences are appended frame by frame
+        if (ends_with(filename, ".ufs")) {
+            ImageSequenceWriter::append_frame(filename, g);
+            return;
+        }
+
         const int _height = g->framebuffer.height;
         const int _width  = g->framebuffer.width;
 
@@ -1068,7 +1078,7 @@ namespace umfeld {
             // } else if (ends_with(filename, ".hdr")) {
             //     stbi_write_hdr((filename).c_str(), _width, _height, DEFAULT_BYTES_PER_PIXELS, reinterpret_cast<float*>(flippedPixels.data()));
         } else {
-            warning("Unsupported file format: ", filename, ". Supported formats are: .png, .jpg, .bmp, .tga");
+            warning("Unsupported file format: ", filename, ". Supported formats are: .png, .jpg, .bmp, .tga, .ufs");
         }
     }
 
@@ -284,6 +284,8 @@ namespace umfeld {
         umfeld::audio_buffer_size        = info.buffer_size;
         umfeld::audio_sample_rate        = info.sample_rate;
         umfeld::run_audio_in_thread      = info.threaded;
+        umfeld::run_audio_in_callback    = info.callback;
+        umfeld::audio_queue_depth        = info.queue_depth;
         // ReSharper restore CppDeprecatedEntity
         DISABLE_WARNING_POP
     }
@@ -516,16 +516,7 @@ namespace umfeld {
         g->texture_wrap(wrap);
     }
 
-    void loadPixels(const bool update_logical_buffer) {
-        if (g == nullptr) { return; }
-
-        if (g->pixels == nullptr || pixels == nullptr) {
-            error_in_function("pixels is null, cannot load pixels.");
-            return;
-        }
-
-        g->download_colorbuffer(g->pixels);
-
+    static void downsample_pixels_to_logical_buffer(const bool update_logical_buffer) {
         const int d      = g->displayDensity();
         const int phys_w = width * d;
 
@@ -592,6 +583,38 @@ namespace umfeld {
         }
     }
 
+    void loadPixels(const bool update_logical_buffer) {
+        if (g == nullptr) { return; }
+
+        if (g->pixels == nullptr || pixels == nullptr) {
+            error_in_function("pixels is null, cannot load pixels.");
+            return;
+        }
+
+        g->download_colorbuffer(g->pixels);
+        downsample_pixels_to_logical_buffer(update_logical_buffer);
+    }
+
+    void loadPixelsAsync() {
+        if (g == nullptr) { return; }
+        g->loadPixelsAsync();
+    }
+
+    bool pixelsReady(const bool update_logical_buffer) {
+        if (g == nullptr) { return false; }
+
+        if (g->pixels == nullptr || pixels == nullptr) {
+            error_in_function("pixels is null, cannot load pixels.");
+            return false;
+        }
+
+        if (!g->pixelsReady()) {
+            return false;
+        }
+        downsample_pixels_to_logical_buffer(update_logical_buffer);
+        return true;
+    }
+
     void updatePixels(const bool update_logical_buffer) {
         if (g == nullptr) {
             return;
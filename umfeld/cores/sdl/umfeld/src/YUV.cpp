@@ -0,0 +1,224 @@
+/*
+ * Umfeld
+ *
+ * This file is part of the *Umfeld* library (https://github.com/dennisppaul/umfeld).
+ * Copyright (c) 2025 Dennis P Paul.
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include "YUV.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define UMFELD_YUV_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define UMFELD_YUV_NEON
+#include <arm_neon.h>
+#endif
+
+using namespace umfeld;
+
+namespace {
+    /*
+     * coefficients in 10.6 fixed point. all intermediate values fit into 16 bit, sums that exceed the
+     * range are saturated which only happens for results that are clamped to 0 or 255 anyway.
+     */
+    constexpr int FIXED_SHIFT = 6;
+    constexpr int FIXED_ROUND = 1 << (FIXED_SHIFT - 1);
+
+    struct FixedCoefficients {
+        int16_t y_offset;
+        int16_t y_scale;
+        int16_t v_to_r;
+        int16_t u_to_g;
+        int16_t v_to_g;
+        int16_t u_to_b;
+    };
+
+    int16_t to_fixed(const float value) {
+        return static_cast<int16_t>(std::lround(value * (1 << FIXED_SHIFT)));
+    }
+
+    FixedCoefficients to_fixed(const YUVCoefficients& c) {
+        return {static_cast<int16_t>(std::lround(c.y_offset * 255.0f)),
+                to_fixed(c.y_scale),
+                to_fixed(c.v_to_r),
+                to_fixed(c.u_to_g),
+                to_fixed(c.v_to_g),
+                to_fixed(c.u_to_b)};
+    }
+
+    uint8_t clamp_to_byte(const int value) {
+        return static_cast<uint8_t>(std::clamp(value, 0, 255));
+    }
+
+    void convert_pixel(const int y, const int u, const int v, const FixedCoefficients& c, uint8_t* rgba) {
+        const int luma = (y - c.y_offset) * c.y_scale + FIXED_ROUND;
+        const int cb   = u - 128;
+        const int cr   = v - 128;
+        rgba[0]        = clamp_to_byte((luma + c.v_to_r * cr) >> FIXED_SHIFT);
+        rgba[1]        = clamp_to_byte((luma - c.u_to_g * cb - c.v_to_g * cr) >> FIXED_SHIFT);
+        rgba[2]        = clamp_to_byte((luma + c.u_to_b * cb) >> FIXED_SHIFT);
+        rgba[3]        = 255;
+    }
+
+#if defined(UMFELD_YUV_SSE2)
+    void convert_8_pixels(const __m128i y, const __m128i u, const __m128i v, const FixedCoefficients& c,
+                          __m128i& r, __m128i& g, __m128i& b) {
+        const __m128i luma = _mm_add_epi16(_mm_mullo_epi16(_mm_sub_epi16(y, _mm_set1_epi16(c.y_offset)),
+                                                           _mm_set1_epi16(c.y_scale)),
+                                           _mm_set1_epi16(FIXED_ROUND));
+        r = _mm_srai_epi16(_mm_adds_epi16(luma, _mm_mullo_epi16(v, _mm_set1_epi16(c.v_to_r))), FIXED_SHIFT);
+        g = _mm_srai_epi16(_mm_subs_epi16(_mm_subs_epi16(luma, _mm_mullo_epi16(u, _mm_set1_epi16(c.u_to_g))),
+                                          _mm_mullo_epi16(v, _mm_set1_epi16(c.v_to_g))),
+                           FIXED_SHIFT);
+        b = _mm_srai_epi16(_mm_adds_epi16(luma, _mm_mullo_epi16(u, _mm_set1_epi16(c.u_to_b))), FIXED_SHIFT);
+    }
+#elif defined(UMFELD_YUV_NEON)
+    void convert_8_pixels(const int16x8_t y, const int16x8_t u, const int16x8_t v, const FixedCoefficients& c,
+                          uint8x8_t& r, uint8x8_t& g, uint8x8_t& b) {
+        const int16x8_t luma = vaddq_s16(vmulq_n_s16(vsubq_s16(y, vdupq_n_s16(c.y_offset)), c.y_scale),
+                                         vdupq_n_s16(FIXED_ROUND));
+        r = vqmovun_s16(vshrq_n_s16(vqaddq_s16(luma, vmulq_n_s16(v, c.v_to_r)), FIXED_SHIFT));
+        g = vqmovun_s16(vshrq_n_s16(vqsubq_s16(vqsubq_s16(luma, vmulq_n_s16(u, c.u_to_g)),
+                                               vmulq_n_s16(v, c.v_to_g)),
+                                    FIXED_SHIFT));
+        b = vqmovun_s16(vshrq_n_s16(vqaddq_s16(luma, vmulq_n_s16(u, c.u_to_b)), FIXED_SHIFT));
+    }
+#endif
+
+    /**
+     * converts one row. for NV12 `u_row` points to the interleaved UV row and `v_row` is ignored.
+     */
+    void convert_row(const uint8_t*           y_row,
+                     const uint8_t*           u_row,
+                     const uint8_t*           v_row,
+                     const bool               interleaved_uv,
+                     const int                width,
+                     const FixedCoefficients& c,
+                     uint8_t*                 rgba_row) {
+        int x = 0;
+#if defined(UMFELD_YUV_SSE2)
+        const __m128i zero     = _mm_setzero_si128();
+        const __m128i bias     = _mm_set1_epi16(128);
+        const __m128i alpha    = _mm_set1_epi8(static_cast<char>(0xFF));
+        const __m128i low_mask = _mm_set1_epi16(0x00FF);
+        for (; x + 16 <= width; x += 16) {
+            const __m128i y8 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(y_row + x));
+            __m128i       u16;
+            __m128i       v16;
+            if (interleaved_uv) {
+                const __m128i uv8 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(u_row + x));
+                u16               = _mm_and_si128(uv8, low_mask);
+                v16               = _mm_srli_epi16(uv8, 8);
+            } else {
+                u16 = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(u_row + x / 2)), zero);
+                v16 = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(v_row + x / 2)), zero);
+            }
+            u16 = _mm_sub_epi16(u16, bias);
+            v16 = _mm_sub_epi16(v16, bias);
+
+            // NOTE each chroma sample covers two neighboring pixels
+            __m128i r_lo, g_lo, b_lo, r_hi, g_hi, b_hi;
+            convert_8_pixels(_mm_unpacklo_epi8(y8, zero), _mm_unpacklo_epi16(u16, u16), _mm_unpacklo_epi16(v16, v16), c, r_lo, g_lo, b_lo);
+            convert_8_pixels(_mm_unpackhi_epi8(y8, zero), _mm_unpackhi_epi16(u16, u16), _mm_unpackhi_epi16(v16, v16), c, r_hi, g_hi, b_hi);
+            const __m128i r8 = _mm_packus_epi16(r_lo, r_hi);
+            const __m128i g8 = _mm_packus_epi16(g_lo, g_hi);
+            const __m128i b8 = _mm_packus_epi16(b_lo, b_hi);
+
+            const __m128i rg_lo = _mm_unpacklo_epi8(r8, g8);
+            const __m128i rg_hi = _mm_unpackhi_epi8(r8, g8);
+            const __m128i ba_lo = _mm_unpacklo_epi8(b8, alpha);
+            const __m128i ba_hi = _mm_unpackhi_epi8(b8, alpha);
+            auto*         out   = reinterpret_cast<__m128i*>(rgba_row + x * 4);
+            _mm_storeu_si128(out + 0, _mm_unpacklo_epi16(rg_lo, ba_lo));
+            _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(rg_lo, ba_lo));
+            _mm_storeu_si128(out + 2, _mm_unpacklo_epi16(rg_hi, ba_hi));
+            _mm_storeu_si128(out + 3, _mm_unpackhi_epi16(rg_hi, ba_hi));
+        }
+#elif defined(UMFELD_YUV_NEON)
+        const int16x8_t bias = vdupq_n_s16(128);
+        for (; x + 16 <= width; x += 16) {
+            const uint8x16_t y8 = vld1q_u8(y_row + x);
+            uint8x8_t        u8;
+            uint8x8_t        v8;
+            if (interleaved_uv) {
+                const uint8x8x2_t uv = vld2_u8(u_row + x);
+                u8                   = uv.val[0];
+                v8                   = uv.val[1];
+            } else {
+                u8 = vld1_u8(u_row + x / 2);
+                v8 = vld1_u8(v_row + x / 2);
+            }
+            const int16x8_t u16 = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(u8)), bias);
+            const int16x8_t v16 = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(v8)), bias);
+
+            // NOTE each chroma sample covers two neighboring pixels
+            const int16x8x2_t u_pairs = vzipq_s16(u16, u16);
+            const int16x8x2_t v_pairs = vzipq_s16(v16, v16);
+            uint8x8_t         r_lo, g_lo, b_lo, r_hi, g_hi, b_hi;
+            convert_8_pixels(vreinterpretq_s16_u16(vmovl_u8(vget_low_u8(y8))), u_pairs.val[0], v_pairs.val[0], c, r_lo, g_lo, b_lo);
+            convert_8_pixels(vreinterpretq_s16_u16(vmovl_u8(vget_high_u8(y8))), u_pairs.val[1], v_pairs.val[1], c, r_hi, g_hi, b_hi);
+
+            uint8x16x4_t rgba;
+            rgba.val[0] = vcombine_u8(r_lo, r_hi);
+            rgba.val[1] = vcombine_u8(g_lo, g_hi);
+            rgba.val[2] = vcombine_u8(b_lo, b_hi);
+            rgba.val[3] = vdupq_n_u8(255);
+            vst4q_u8(rgba_row + x * 4, rgba);
+        }
+#endif
+        for (; x < width; x++) {
+            const int cx = x / 2;
+            const int u  = interleaved_uv ? u_row[cx * 2] : u_row[cx];
+            const int v  = interleaved_uv ? u_row[cx * 2 + 1] : v_row[cx];
+            convert_pixel(y_row[x], u, v, c, rgba_row + x * 4);
+        }
+    }
+} // namespace
+
+YUVCoefficients umfeld::get_yuv_coefficients(const YUVColorSpace color_space, const bool full_range) {
+    if (color_space == YUV_COLOR_SPACE_BT709) {
+        if (full_range) {
+            return {0.0f, 1.0f, 1.5748f, 0.187324f, 0.468124f, 1.8556f};
+        }
+        return {16.0f / 255.0f, 255.0f / 219.0f, 1.792741f, 0.213249f, 0.532909f, 2.112402f};
+    }
+    if (full_range) {
+        return {0.0f, 1.0f, 1.402f, 0.344136f, 0.714136f, 1.772f};
+    }
+    return {16.0f / 255.0f, 255.0f / 219.0f, 1.596027f, 0.391762f, 0.812968f, 2.017232f};
+}
+
+void umfeld::yuv_to_rgba(const YUVFrame& frame, uint32_t* pixels) {
+    if (pixels == nullptr || frame.planes[0] == nullptr || frame.planes[1] == nullptr) {
+        return;
+    }
+    const bool interleaved_uv = frame.format == YUV_FORMAT_NV12;
+    if (!interleaved_uv && frame.planes[2] == nullptr) {
+        return;
+    }
+
+    const FixedCoefficients c = to_fixed(get_yuv_coefficients(frame.color_space, frame.full_range));
+    for (int row = 0; row < frame.height; row++) {
+        const int      chroma_row = frame.format == YUV_FORMAT_I422 ? row : row / 2;
+        const uint8_t* y_row      = frame.planes[0] + row * frame.strides[0];
+        const uint8_t* u_row      = frame.planes[1] + chroma_row * frame.strides[1];
+        const uint8_t* v_row      = interleaved_uv ? nullptr : frame.planes[2] + chroma_row * frame.strides[2];
+        convert_row(y_row, u_row, v_row, interleaved_uv, frame.width, c, reinterpret_cast<uint8_t*>(pixels + row * frame.width));
+    }
+}